@@ -0,0 +1,64 @@
+#include "dataset.hpp"
+#include "reasoner.hpp"
+#include "synthetic.hpp"
+#include <benchmark/benchmark.h>
+#include <utility>
+
+namespace fdd = fuzzyrulesml::dataset;
+namespace fre = fuzzyrulesml::reasoner;
+namespace frb = fuzzyrulesml::benchmarks;
+
+namespace {
+// Arguments: rows
+void BM_DataSetConstruct(benchmark::State& state, std::size_t variables) {
+  const auto model = frb::make_synthetic_model({.variables = variables, .rules = 1, .rows = static_cast<std::size_t>(state.range(0))});
+  const auto [features, targets] = model.to_json();
+  for (auto _ : state) {
+    fdd::DataSet data_set(features, targets);
+    benchmark::DoNotOptimize(data_set);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// get_items takes the (name, variable) pairs as a parameter pack, so the variables count is a template parameter
+template <std::size_t VARIABLES> auto get_items(const fdd::DataSet& data_set, const frb::SyntheticModel& model) -> fdd::ItemsView {
+  return [&]<std::size_t... INDICES>(std::index_sequence<INDICES...>) {
+    return data_set.get_items(std::pair{model.names[INDICES], model.variables[INDICES]}...);
+  }(std::make_index_sequence<VARIABLES>{});
+}
+
+// Yielding all the per-sample items of the lazy view
+template <std::size_t VARIABLES> void BM_DataSetGetItems(benchmark::State& state) {
+  const auto model = frb::make_synthetic_model({.variables = VARIABLES, .rules = 1, .rows = static_cast<std::size_t>(state.range(0))});
+  const auto [features, targets] = model.to_json();
+  const fdd::DataSet data_set(features, targets);
+  for (auto _ : state) {
+    for (const auto& item : get_items<VARIABLES>(data_set, model)) {
+      benchmark::DoNotOptimize(item);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The training objective over the items: the view binds the columns and calculate_one scores them as a batch, each
+// iteration is an objective evaluation of an iris-like model
+void BM_ItemsObjective(benchmark::State& state) {
+  const auto model = frb::make_synthetic_model({.variables = 4, .rules = 16, .rows = static_cast<std::size_t>(state.range(0))});
+  const auto [features, targets] = model.to_json();
+  const fdd::DataSet data_set(features, targets);
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fre::calculate_one(get_items<4>(data_set, model), reasoner, false));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+} // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+BENCHMARK_CAPTURE(BM_DataSetConstruct, variables_4, 4)->ArgName("rows")->Arg(150)->Arg(1 << 14)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DataSetConstruct, variables_16, 16)->ArgName("rows")->Arg(150)->Arg(1 << 14)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DataSetGetItems<1>)->ArgName("rows")->Arg(150)->Arg(1 << 14)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DataSetGetItems<4>)->ArgName("rows")->Arg(150)->Arg(1 << 14)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DataSetGetItems<8>)->ArgName("rows")->Arg(150)->Arg(1 << 14)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ItemsObjective)->ArgName("rows")->Arg(150)->Arg(1 << 14)->Unit(benchmark::kMicrosecond);
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
@@ -0,0 +1,59 @@
+#include "fuzzify_kernels.hpp"
+#include "variable.hpp"
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace fru = fuzzyrulesml::rules;
+namespace fmf = fuzzyrulesml::mfunct;
+
+namespace {
+const std::size_t column_rows = 4096;
+
+auto make_column() -> std::vector<double> {
+  std::mt19937 generator{42}; // NOLINT(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+  std::uniform_real_distribution<double> crisp_values{-0.1, 1.1};
+  std::vector<double> column(column_rows);
+  std::ranges::generate(column, [&]() { return crisp_values(generator); });
+  return column;
+}
+
+// Scalar reference: LinearDistribution::operator() for each value of the column
+void BM_FuzzifyScalarOperator(benchmark::State& state) {
+  const auto distribution = fru::make_linear_distribution(fru::initial_distribution::Uniform(0.0, 1.0, state.range(0)));
+  const auto column = make_column();
+  for (auto _ : state) {
+    double degrees_sum = 0.0;
+    for (const auto value : column) {
+      for (const auto& [index, degree] : distribution(value)) {
+        degrees_sum += degree;
+      }
+    }
+    benchmark::DoNotOptimize(degrees_sum);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(column_rows));
+}
+
+void BM_FuzzifyColumn(benchmark::State& state, fmf::FuzzifyKernel kernel) {
+  if (not fmf::is_supported(kernel)) {
+    state.SkipWithError("Kernel not supported by the CPU");
+    return;
+  }
+  const auto points = fru::make_linear_distribution(fru::initial_distribution::Uniform(0.0, 1.0, state.range(0))).get_points();
+  const auto column = make_column();
+  std::vector<std::uint32_t> segments(column_rows);
+  std::vector<double> degrees(column_rows);
+  for (auto _ : state) {
+    fmf::fuzzify_column(kernel, points, column, segments, degrees);
+    benchmark::DoNotOptimize(degrees.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(column_rows));
+}
+} // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+BENCHMARK(BM_FuzzifyScalarOperator)->Arg(2)->Arg(8)->Arg(32)->Arg(128);
+BENCHMARK_CAPTURE(BM_FuzzifyColumn, scalar, fmf::FuzzifyKernel::scalar)->Arg(2)->Arg(8)->Arg(32)->Arg(128);
+BENCHMARK_CAPTURE(BM_FuzzifyColumn, sse2, fmf::FuzzifyKernel::sse2)->Arg(2)->Arg(8)->Arg(32)->Arg(128);
+BENCHMARK_CAPTURE(BM_FuzzifyColumn, avx2, fmf::FuzzifyKernel::avx2)->Arg(2)->Arg(8)->Arg(32)->Arg(128);
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
@@ -0,0 +1,116 @@
+#include "binary_dataset.hpp"
+#include "dataset.hpp"
+#include "loader.hpp"
+#include "synthetic.hpp"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <format>
+#include <sys/resource.h>
+
+namespace fdd = fuzzyrulesml::dataset;
+namespace frb = fuzzyrulesml::benchmarks;
+
+namespace {
+// Files of a synthetic dataset with 4 variables, written once per benchmark into the temporary directory
+struct DatasetFiles {
+  explicit DatasetFiles(std::size_t rows)
+      : features{temporary(std::format("features_{}.json", rows))}, targets{temporary(std::format("targets_{}.json", rows))},
+        csv{temporary(std::format("dataset_{}.csv", rows))} {
+    const auto model = frb::make_synthetic_model({.variables = 4, .rules = 1, .rows = rows});
+    model.write_json(features, targets);
+    model.write_csv(csv);
+  }
+  DatasetFiles(const DatasetFiles&) = delete;
+  auto operator=(const DatasetFiles&) -> DatasetFiles& = delete;
+  ~DatasetFiles() {
+    std::filesystem::remove(features);
+    std::filesystem::remove(targets);
+    std::filesystem::remove(csv);
+  }
+  [[nodiscard]] auto bytes() const -> std::uintmax_t { return std::filesystem::file_size(features) + std::filesystem::file_size(targets); }
+
+  std::string features;
+  std::string targets;
+  std::string csv;
+
+private:
+  static auto temporary(const std::string& name) -> std::string {
+    return (std::filesystem::temp_directory_path() / std::format("fuzzyRulesML_bench_{}", name)).string();
+  }
+};
+
+// Peak resident set size of the process in MiB; it never decreases, so compare the loading paths by running each one
+// alone with --benchmark_filter
+auto peak_rss_mib() -> double {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<double>(usage.ru_maxrss) / 1024.0; // NOLINT(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+}
+
+void set_counters(benchmark::State& state, std::uintmax_t bytes) {
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(bytes));
+  state.counters["peak_rss_MiB"] = peak_rss_mib();
+}
+
+// The JSON documents path: load_data and the DataSet rows, arguments: rows
+void BM_LoadJsonDocuments(benchmark::State& state) {
+  const DatasetFiles files{static_cast<std::size_t>(state.range(0))};
+  for (auto _ : state) {
+    const auto [features, targets] = fdd::load_data(files.features, files.targets);
+    fdd::DataSet data_set(features, targets);
+    benchmark::DoNotOptimize(data_set);
+  }
+  set_counters(state, files.bytes());
+}
+
+void BM_LoadColumnarJson(benchmark::State& state) {
+  const DatasetFiles files{static_cast<std::size_t>(state.range(0))};
+  for (auto _ : state) {
+    auto store = fdd::load_columnar(files.features, files.targets);
+    benchmark::DoNotOptimize(store);
+  }
+  set_counters(state, files.bytes());
+}
+
+void BM_LoadColumnarCsv(benchmark::State& state) {
+  const DatasetFiles files{static_cast<std::size_t>(state.range(0))};
+  for (auto _ : state) {
+    auto store = fdd::load_columnar_csv(files.csv);
+    benchmark::DoNotOptimize(store);
+  }
+  set_counters(state, std::filesystem::file_size(files.csv));
+}
+
+// Streaming in chunks of 4096 rows, the memory is bounded by a chunk
+void BM_LoadJsonChunks(benchmark::State& state) {
+  const DatasetFiles files{static_cast<std::size_t>(state.range(0))};
+  const std::size_t chunk_rows = 4096;
+  for (auto _ : state) {
+    fdd::JsonRecordsReader reader{files.features, files.targets};
+    fdd::for_each_chunk(reader, chunk_rows, [](const fdd::ColumnarStore& chunk) { benchmark::DoNotOptimize(chunk.get_targets().data()); });
+  }
+  set_counters(state, files.bytes());
+}
+
+// Opening the binary columnar file and reading a value of the last row, without touching the other rows
+void BM_OpenMappedDataset(benchmark::State& state) {
+  const DatasetFiles files{static_cast<std::size_t>(state.range(0))};
+  const auto binary = files.csv + ".bin";
+  fdd::write_binary(fdd::load_columnar_csv(files.csv), binary);
+  for (auto _ : state) {
+    const fdd::MappedDataset mapped{binary};
+    benchmark::DoNotOptimize(mapped.get_column(0).back());
+  }
+  std::filesystem::remove(binary);
+  state.counters["peak_rss_MiB"] = peak_rss_mib();
+}
+} // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+BENCHMARK(BM_LoadJsonDocuments)->ArgName("rows")->Arg(1 << 10)->Arg(1 << 17)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadColumnarJson)->ArgName("rows")->Arg(1 << 10)->Arg(1 << 17)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadColumnarCsv)->ArgName("rows")->Arg(1 << 10)->Arg(1 << 17)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadJsonChunks)->ArgName("rows")->Arg(1 << 10)->Arg(1 << 17)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OpenMappedDataset)->ArgName("rows")->Arg(1 << 10)->Arg(1 << 17)->Unit(benchmark::kMicrosecond);
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
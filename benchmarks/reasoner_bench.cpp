@@ -0,0 +1,411 @@
+#include "compiled_reasoner.hpp"
+#include "incremental.hpp"
+#include "minibatch.hpp"
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include "static_reasoner.hpp"
+#include "synthetic.hpp"
+#include <algorithm>
+#include <array>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <ranges>
+#include <span>
+
+namespace fru = fuzzyrulesml::rules;
+namespace fre = fuzzyrulesml::reasoner;
+namespace frb = fuzzyrulesml::benchmarks;
+
+namespace {
+// Iris-like model: full grid of 2 terms over 4 variables, arguments: rows
+auto make_iris_like_model(const benchmark::State& state) -> frb::SyntheticModel {
+  return frb::make_synthetic_model({.variables = 4, .terms = 2, .rules = 16, .rows = static_cast<std::size_t>(state.range(0))});
+}
+
+// Single sample inference through the map-based do_reasoning, arguments: variables, terms per variable, rules
+void BM_DoReasoning(benchmark::State& state) {
+  const std::size_t samples_count = 256;
+  const auto model = frb::make_synthetic_model({.variables = static_cast<std::size_t>(state.range(0)),
+                                                .terms = static_cast<std::size_t>(state.range(1)),
+                                                .rules = static_cast<std::size_t>(state.range(2)),
+                                                .rows = samples_count});
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  std::vector<fru::RuleTestingValues> samples;
+  for (std::size_t row = 0; row < samples_count; ++row) {
+    samples.push_back(model.get_sample(row));
+  }
+  std::size_t sample = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(reasoner.do_reasoning(samples[sample++ % samples.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// The same single samples scored into a reused dense array and resolved to the best conclusion, without allocations
+void BM_DoReasoningScores(benchmark::State& state) {
+  const std::size_t samples_count = 256;
+  const auto model = frb::make_synthetic_model({.variables = static_cast<std::size_t>(state.range(0)),
+                                                .terms = static_cast<std::size_t>(state.range(1)),
+                                                .rules = static_cast<std::size_t>(state.range(2)),
+                                                .rows = samples_count});
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  std::vector<fru::RuleTestingValues> samples;
+  for (std::size_t row = 0; row < samples_count; ++row) {
+    samples.push_back(model.get_sample(row));
+  }
+  std::vector<double> scores(reasoner.get_conclusions().size());
+  auto scratch = reasoner.make_sample_scratch();
+  std::size_t sample = 0;
+  for (auto _ : state) {
+    reasoner.do_reasoning(samples[sample++ % samples.size()], scores, scratch);
+    benchmark::DoNotOptimize(fre::get_best_conclusion(scores));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Per call latency percentiles of the timed calls, as counters in nanoseconds
+void set_latency_counters(benchmark::State& state, std::vector<double>& latencies) {
+  if (latencies.empty()) {
+    return;
+  }
+  std::ranges::sort(latencies);
+  const auto percentile = [&latencies](double rank) {
+    return latencies[static_cast<std::size_t>(rank * static_cast<double>(latencies.size() - 1))];
+  };
+  state.counters["p50_ns"] = percentile(0.5);
+  state.counters["p99_ns"] = percentile(0.99);
+  state.counters["p999_ns"] = percentile(0.999);
+}
+
+// Latency of a single sample call through the map-based do_reasoning, arguments: variables, terms per variable, rules
+void BM_DoReasoningLatency(benchmark::State& state) {
+  const std::size_t samples_count = 256;
+  const auto model = frb::make_synthetic_model({.variables = static_cast<std::size_t>(state.range(0)),
+                                                .terms = static_cast<std::size_t>(state.range(1)),
+                                                .rules = static_cast<std::size_t>(state.range(2)),
+                                                .rows = samples_count});
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  std::vector<fru::RuleTestingValues> samples;
+  for (std::size_t row = 0; row < samples_count; ++row) {
+    samples.push_back(model.get_sample(row));
+  }
+  std::vector<double> latencies;
+  latencies.reserve(static_cast<std::size_t>(state.max_iterations));
+  std::size_t sample = 0;
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    benchmark::DoNotOptimize(reasoner.do_reasoning(samples[sample++ % samples.size()]));
+    latencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+  }
+  set_latency_counters(state, latencies);
+  state.SetItemsProcessed(state.iterations());
+}
+
+// The same samples through the warm CompiledReasoner
+void BM_CompiledInferLatency(benchmark::State& state) {
+  const std::size_t samples_count = 256;
+  const auto model = frb::make_synthetic_model({.variables = static_cast<std::size_t>(state.range(0)),
+                                                .terms = static_cast<std::size_t>(state.range(1)),
+                                                .rules = static_cast<std::size_t>(state.range(2)),
+                                                .rows = samples_count});
+  fre::CompiledReasoner reasoner{model.rules_set};
+  std::vector<double> samples(samples_count * reasoner.get_slots_count());
+  for (std::size_t variable = 0; variable < model.variables.size(); ++variable) {
+    const auto slot = reasoner.get_slot(model.variables[variable].get_name());
+    for (std::size_t row = 0; row < samples_count; ++row) {
+      samples[(row * reasoner.get_slots_count()) + slot] = model.columns[variable][row];
+    }
+  }
+  std::vector<double> latencies;
+  latencies.reserve(static_cast<std::size_t>(state.max_iterations));
+  std::size_t sample = 0;
+  for (auto _ : state) {
+    const auto values = std::span{samples}.subspan((sample++ % samples_count) * reasoner.get_slots_count(), reasoner.get_slots_count());
+    const auto start = std::chrono::steady_clock::now();
+    benchmark::DoNotOptimize(reasoner.infer(values).data());
+    latencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+  }
+  set_latency_counters(state, latencies);
+  state.SetItemsProcessed(state.iterations());
+}
+
+// The per-sample path: a RuleTestingValues map built for each row, as the DataSet::get_items view yields, then do_reasoning
+void BM_DatasetPerSample(benchmark::State& state) {
+  const auto model = make_iris_like_model(state);
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  for (auto _ : state) {
+    double matches = 0.0;
+    for (std::size_t row = 0; row < model.targets.size(); ++row) {
+      const auto result = reasoner.do_reasoning(model.get_sample(row));
+      const auto best =
+          std::ranges::max_element(result, [](const auto& l_item, const auto& r_item) { return l_item.second < r_item.second; });
+      matches += (best != result.end() && best->first.item == model.targets[row]) ? 1.0 : 0.0;
+    }
+    benchmark::DoNotOptimize(matches);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_DatasetBatch(benchmark::State& state) {
+  const auto model = make_iris_like_model(state);
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fre::calculate_one(model.get_batch_inputs(), model.targets, reasoner, false));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Batch scores of full grid rule bases through the posting lists against the dense grid; arguments: dense layout (0
+// or 1), variables, terms per variable
+void BM_RulesLayout(benchmark::State& state) {
+  const auto variables = static_cast<std::size_t>(state.range(1));
+  const auto terms = static_cast<std::size_t>(state.range(2));
+  const auto model = frb::make_synthetic_model(
+      {.variables = variables, .terms = terms, .rules = static_cast<std::size_t>(std::pow(terms, variables)), .rows = 1 << 14});
+  const fre::SimpleReasoner reasoner{model.rules_set, state.range(0) == 0 ? fre::RulesLayout::sparse : fre::RulesLayout::dense};
+  const auto inputs = model.get_batch_inputs();
+  std::vector<double> scores(inputs.get_rows() * reasoner.get_conclusions().size());
+  for (auto _ : state) {
+    reasoner.do_reasoning(inputs, scores);
+    benchmark::DoNotOptimize(scores.data());
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * inputs.get_rows()));
+}
+
+// Batch scores of a full grid of 6 terms over 4 variables with the operators of the reasoner; arguments: dense layout
+// (0 or 1)
+template <typename REASONER> void BM_ReasoningOperators(benchmark::State& state) {
+  const auto model = frb::make_synthetic_model({.variables = 4, .terms = 6, .rules = 1296, .rows = 1 << 14});
+  const REASONER reasoner{model.rules_set, state.range(0) == 0 ? fre::RulesLayout::sparse : fre::RulesLayout::dense};
+  const auto inputs = model.get_batch_inputs();
+  std::vector<double> scores(inputs.get_rows() * reasoner.get_conclusions().size());
+  for (auto _ : state) {
+    reasoner.do_reasoning(inputs, scores);
+    benchmark::DoNotOptimize(scores.data());
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * inputs.get_rows()));
+}
+using MinMaxReasoner = fre::BasicReasoner<fre::MinTNorm, fre::MaxAggregation>;
+using LukasiewiczReasoner = fre::BasicReasoner<fre::LukasiewiczTNorm, fre::ProbabilisticOrAggregation>;
+
+// One evaluation of the training objective: a random candidate of characteristic points scored through the
+// parameters binding, as run_training does for each population member; arguments: rows
+void BM_TrainingObjective(benchmark::State& state) {
+  const auto model = make_iris_like_model(state);
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  const auto inputs = model.get_batch_inputs();
+  const fru::ParametersBinding binding{inputs};
+  // Candidates around the initial points, prepared out of the timed loop
+  const std::size_t candidates_count = 64;
+  std::mt19937_64 generator{7}; // NOLINT(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+  std::uniform_real_distribution<double> shift{-0.1, 0.1};
+  std::vector<std::vector<double>> candidates(candidates_count);
+  for (auto& candidate : candidates) {
+    std::ranges::transform(binding.get_parameters(), std::back_inserter(candidate), [&](const double point) { return point + shift(generator); });
+  }
+  std::size_t candidate = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        fre::calculate_one(inputs, binding, candidates[candidate++ % candidates_count], model.targets, reasoner, false));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The training objective on stratified mini-batches: each iteration scores a candidate on the batch, and the batch is
+// drawn again for each generation of 20 members, scored twice (the population again and the trials), so candidates
+// per second follow the batch rows whatever the dataset rows; arguments: rows, batch rows
+void BM_MiniBatchObjective(benchmark::State& state) {
+  const auto model = make_iris_like_model(state);
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  const auto inputs = model.get_batch_inputs();
+  const fru::ParametersBinding binding{inputs};
+  fuzzyrulesml::dataset::StringInterner classes;
+  const auto class_ids = model.targets | std::views::transform([&classes](const auto& target) { return classes.intern(target); }) |
+                         std::ranges::to<std::vector<std::uint32_t>>();
+  fuzzyrulesml::training::StratifiedBatches batches{inputs, class_ids, static_cast<std::size_t>(state.range(1)), 1};
+  const std::size_t candidates_count = 64;
+  const std::size_t generation_candidates = 40;
+  std::mt19937_64 generator{7}; // NOLINT(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+  std::uniform_real_distribution<double> shift{-0.1, 0.1};
+  std::vector<std::vector<double>> candidates(candidates_count);
+  for (auto& candidate : candidates) {
+    std::ranges::transform(binding.get_parameters(), std::back_inserter(candidate), [&](const double point) { return point + shift(generator); });
+  }
+  std::size_t candidate = 0;
+  for (auto _ : state) {
+    if (candidate % generation_candidates == 0) {
+      batches.resample(candidate / generation_candidates);
+    }
+    benchmark::DoNotOptimize(fre::calculate_one(batches.get_inputs(), binding, candidates[candidate++ % candidates_count],
+                                                batches.get_targets(), classes.get_values(), reasoner, false));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Coordinate-wise tuning of a large rule base, a full grid of 6 terms over 4 variables (1296 rules): each iteration
+// moves a single inner point of a variable and evaluates the objective; arguments: rows
+auto make_tuning_model(const benchmark::State& state) -> frb::SyntheticModel {
+  return frb::make_synthetic_model({.variables = 4, .terms = 6, .rules = 1296, .rows = static_cast<std::size_t>(state.range(0))});
+}
+
+// Inner point moved by the iteration of the coordinate-wise tuning, shifted back and forth around its initial value
+auto move_point(std::vector<double>& candidate, std::size_t iteration) -> std::size_t {
+  const std::size_t terms = 6;
+  const auto column = iteration % 4;
+  const auto point = (column * terms) + 1 + ((iteration / 4) % (terms - 2));
+  candidate[point] += (iteration / 4) % 2 == 0 ? 0.05 : -0.05; // NOLINT(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+  return column;
+}
+
+void BM_CoordinateTuningFull(benchmark::State& state) {
+  const auto model = make_tuning_model(state);
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  const auto inputs = model.get_batch_inputs();
+  const fru::ParametersBinding binding{inputs};
+  std::vector<double> candidate{binding.get_parameters().begin(), binding.get_parameters().end()};
+  std::size_t iteration = 0;
+  for (auto _ : state) {
+    static_cast<void>(move_point(candidate, iteration++));
+    benchmark::DoNotOptimize(fre::calculate_one(inputs, binding, candidate, model.targets, reasoner, false));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_CoordinateTuningIncremental(benchmark::State& state) {
+  const auto model = make_tuning_model(state);
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  const auto inputs = model.get_batch_inputs();
+  const fru::ParametersBinding binding{inputs};
+  fuzzyrulesml::dataset::StringInterner classes;
+  const auto targets = model.targets | std::views::transform([&classes](const auto& target) { return classes.intern(target); }) |
+                       std::ranges::to<std::vector<std::uint32_t>>();
+  fre::IncrementalEvaluator evaluator{reasoner, inputs, targets, classes.get_values()};
+  std::vector<double> candidate{binding.get_parameters().begin(), binding.get_parameters().end()};
+  std::size_t iteration = 0;
+  for (auto _ : state) {
+    const auto column = move_point(candidate, iteration++);
+    static_cast<void>(evaluator.set_points(column, binding.get_points(candidate, column)));
+    benchmark::DoNotOptimize(evaluator.get_goal_function());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The iris rule base of main.cpp as the static rule table, the small and large terms of 4 variables
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+constexpr std::array iris_terms{std::size_t{2}, std::size_t{2}, std::size_t{2}, std::size_t{2}};
+constexpr std::array<fre::StaticRule<4>, 16> iris_rules{
+    {{{0, 0, 0, 0}, 0}, {{0, 0, 0, 1}, 1}, {{0, 0, 1, 0}, 1}, {{0, 0, 1, 1}, 2}, {{0, 1, 0, 0}, 0}, {{0, 1, 0, 1}, 1},
+     {{0, 1, 1, 0}, 0}, {{0, 1, 1, 1}, 1}, {{1, 0, 0, 0}, 1}, {{1, 0, 0, 1}, 2}, {{1, 0, 1, 0}, 1}, {{1, 0, 1, 1}, 2},
+     {{1, 1, 0, 0}, 1}, {{1, 1, 0, 1}, 1}, {{1, 1, 1, 0}, 1}, {{1, 1, 1, 1}, 2}}};
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+using IrisReasoner = fre::StaticReasoner<iris_terms, iris_rules, 3>;
+
+// The same iris rule base built at runtime by IrisReasoner::add_rules, with its inputs over the model columns
+struct DynamicIris {
+  explicit DynamicIris(const frb::SyntheticModel& model) {
+    std::vector<fru::FuzzyVarUnion> variables;
+    for (std::size_t variable = 0; variable < IrisReasoner::variables_count; ++variable) {
+      variables.emplace_back(rules_set.add_input_variable(model.names[variable], fru::initial_distribution::Uniform(0.0, 1.0, 2)));
+      inputs.add_column(variables.back(), model.columns[variable]);
+    }
+    IrisReasoner::add_rules(rules_set, {variables[0], variables[1], variables[2], variables[3]},
+                            rules_set.add_output_variable("iris_type", {"Iris-setosa", "Iris-versicolor", "Iris-virginica"}));
+  }
+  fru::RulesSet rules_set;
+  fru::BatchInputs inputs;
+};
+
+// Single sample inference of the iris rule base: SimpleReasoner::do_reasoning of the sample map against the unrolled
+// static rule base
+void BM_IrisDoReasoning(benchmark::State& state) {
+  const auto model = frb::make_synthetic_model({.variables = 4, .terms = 2, .rules = 16, .rows = 256});
+  const DynamicIris iris{model};
+  const fre::SimpleReasoner reasoner{iris.rules_set};
+  std::vector<fru::RuleTestingValues> samples;
+  for (std::size_t row = 0; row < model.columns.front().size(); ++row) {
+    fru::RuleTestingValues sample{iris.inputs.get_variables()[0], model.columns[0][row]};
+    for (std::size_t variable = 1; variable < IrisReasoner::variables_count; ++variable) {
+      sample.add(iris.inputs.get_variables()[variable], model.columns[variable][row]);
+    }
+    samples.push_back(std::move(sample));
+  }
+  std::size_t sample = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(reasoner.do_reasoning(samples[sample++ % samples.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_IrisStaticDoReasoning(benchmark::State& state) {
+  const auto model = frb::make_synthetic_model({.variables = 4, .terms = 2, .rules = 16, .rows = 256});
+  const DynamicIris iris{model};
+  const fru::ParametersBinding binding{iris.inputs};
+  const IrisReasoner reasoner{binding.get_parameters()};
+  std::vector<IrisReasoner::Row> samples(model.columns.front().size());
+  for (std::size_t row = 0; row < samples.size(); ++row) {
+    for (std::size_t variable = 0; variable < IrisReasoner::variables_count; ++variable) {
+      samples[row][variable] = model.columns[variable][row];
+    }
+  }
+  std::size_t sample = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(reasoner.do_reasoning(samples[sample++ % samples.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Batch scores of the iris rule base: SimpleReasoner posting lists against the static rule base; arguments: rows
+void BM_IrisBatch(benchmark::State& state) {
+  const auto model = make_iris_like_model(state);
+  const DynamicIris iris{model};
+  const fre::SimpleReasoner reasoner{iris.rules_set};
+  std::vector<double> scores(iris.inputs.get_rows() * IrisReasoner::conclusions_count);
+  for (auto _ : state) {
+    reasoner.do_reasoning(iris.inputs, scores);
+    benchmark::DoNotOptimize(scores.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_IrisStaticBatch(benchmark::State& state) {
+  const auto model = make_iris_like_model(state);
+  const DynamicIris iris{model};
+  const fru::ParametersBinding binding{iris.inputs};
+  const IrisReasoner reasoner{binding.get_parameters()};
+  std::vector<double> scores(iris.inputs.get_rows() * IrisReasoner::conclusions_count);
+  for (auto _ : state) {
+    reasoner.do_reasoning(iris.inputs, scores);
+    benchmark::DoNotOptimize(scores.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+} // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+BENCHMARK(BM_DoReasoning)->ArgNames({"variables", "terms", "rules"})->Args({4, 2, 16})->Args({4, 8, 256})->Args({8, 4, 4096});
+BENCHMARK(BM_DoReasoningScores)->ArgNames({"variables", "terms", "rules"})->Args({4, 2, 16})->Args({4, 8, 256})->Args({8, 4, 4096});
+BENCHMARK(BM_DoReasoningLatency)->ArgNames({"variables", "terms", "rules"})->Args({4, 2, 16})->Args({4, 8, 256})->Args({8, 4, 4096});
+BENCHMARK(BM_CompiledInferLatency)->ArgNames({"variables", "terms", "rules"})->Args({4, 2, 16})->Args({4, 8, 256})->Args({8, 4, 4096});
+BENCHMARK(BM_DatasetPerSample)->ArgName("rows")->Arg(150)->Arg(1 << 14)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DatasetBatch)->ArgName("rows")->Arg(150)->Arg(1 << 14)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RulesLayout)
+    ->ArgNames({"dense", "variables", "terms"})
+    ->ArgsProduct({{0, 1}, {4}, {2, 6}})
+    ->Args({0, 6, 4})
+    ->Args({1, 6, 4})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ReasoningOperators<fre::SimpleReasoner>)->ArgName("dense")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ReasoningOperators<MinMaxReasoner>)->ArgName("dense")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ReasoningOperators<LukasiewiczReasoner>)->ArgName("dense")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TrainingObjective)->ArgName("rows")->Arg(150)->Arg(1 << 14)->Arg(1 << 20);
+BENCHMARK(BM_MiniBatchObjective)->ArgNames({"rows", "batch"})->ArgsProduct({{1 << 16, 1 << 20, 1 << 22}, {1 << 10, 1 << 13}});
+BENCHMARK(BM_CoordinateTuningFull)->ArgName("rows")->Arg(1 << 14)->Arg(1 << 18)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CoordinateTuningIncremental)->ArgName("rows")->Arg(1 << 14)->Arg(1 << 18)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_IrisDoReasoning);
+BENCHMARK(BM_IrisStaticDoReasoning);
+BENCHMARK(BM_IrisBatch)->ArgName("rows")->Arg(150)->Arg(1 << 14)->Arg(1 << 20)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_IrisStaticBatch)->ArgName("rows")->Arg(150)->Arg(1 << 14)->Arg(1 << 20)->Unit(benchmark::kMicrosecond);
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
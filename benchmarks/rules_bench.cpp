@@ -0,0 +1,127 @@
+#include "rules.hpp"
+#include "rules_io.hpp"
+#include "synthetic.hpp"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+namespace fru = fuzzyrulesml::rules;
+namespace frb = fuzzyrulesml::benchmarks;
+
+namespace {
+const std::size_t samples_count = 256;
+
+// Arguments: variables, terms per variable, rules
+auto make_rules_model(const benchmark::State& state) -> frb::SyntheticModel {
+  return frb::make_synthetic_model({.variables = static_cast<std::size_t>(state.range(0)),
+                                    .terms = static_cast<std::size_t>(state.range(1)),
+                                    .rules = static_cast<std::size_t>(state.range(2)),
+                                    .rows = samples_count});
+}
+
+auto make_samples(const frb::SyntheticModel& model) -> std::vector<fru::RuleTestingValues> {
+  std::vector<fru::RuleTestingValues> samples;
+  for (std::size_t row = 0; row < samples_count; ++row) {
+    samples.push_back(model.get_sample(row));
+  }
+  return samples;
+}
+
+void BM_GetRulesIndexed(benchmark::State& state) {
+  const auto model = make_rules_model(state);
+  const auto samples = make_samples(model);
+  std::size_t sample = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(model.rules_set.get_rules(samples[sample++ % samples.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Ids of the matched rules only, without copying the rules as get_rules does
+void BM_GetRulesIdsIndexed(benchmark::State& state) {
+  const auto model = make_rules_model(state);
+  const auto samples = make_samples(model);
+  std::size_t sample = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(model.rules_set.get_rules_ids(samples[sample++ % samples.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// The path RulesSet::get_rules used before the rules index: fire all the terms into a multimap and scan all the rules
+void BM_GetMatchingRulesScan(benchmark::State& state) {
+  const auto model = make_rules_model(state);
+  const auto samples = make_samples(model);
+  std::size_t sample = 0;
+  for (auto _ : state) {
+    std::multimap<fru::FuzzyVarUnion, std::size_t> fired;
+    for (const auto& [variable, crisp_value] : samples[sample++ % samples.size()]) {
+      for (const auto& member : variable.get_membership(crisp_value)) {
+        fired.insert(std::pair{variable, member.first});
+      }
+    }
+    benchmark::DoNotOptimize(fru::get_matching_rules(model.rules_set.get_all_rules(), fired));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Cold start of a rule base of 8 variables of 5 terms, arguments: rules
+auto make_rule_base(const benchmark::State& state) -> frb::SyntheticModel {
+  return frb::make_synthetic_model({.variables = 8, .terms = 5, .rules = static_cast<std::size_t>(state.range(0)), .rows = 1});
+}
+
+// The rule base built in code, each rule checked by add_rule
+void BM_RulesBuildInCode(benchmark::State& state) {
+  const auto model = make_rule_base(state);
+  const auto& variables = model.rules_set.get_input_variables();
+  for (auto _ : state) {
+    fru::RulesSet rules_set;
+    for (const auto& variable : variables) {
+      static_cast<void>(rules_set.add_input_variable<double>(variable.get_name(), variable.get_points()));
+    }
+    for (const auto& [name, categories] : model.rules_set.get_output_variables()) {
+      static_cast<void>(rules_set.add_output_variable(name, categories));
+    }
+    for (const auto& rule : model.rules_set.get_all_rules()) {
+      rules_set.add_rule(rule.get_preconditions(), rule.get_conclusion());
+    }
+    benchmark::DoNotOptimize(rules_set.get_rules_count());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_RulesReadText(benchmark::State& state) {
+  const auto model = make_rule_base(state);
+  std::ostringstream output;
+  fru::write_rules_text(model.rules_set, output);
+  const auto text = output.str();
+  for (auto _ : state) {
+    std::istringstream input{text};
+    benchmark::DoNotOptimize(fru::read_rules_text(input).get_rules_count());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_RulesReadBinary(benchmark::State& state) {
+  const auto model = make_rule_base(state);
+  const auto file = (std::filesystem::temp_directory_path() / "fuzzyRulesML_bench_rules.bin").string();
+  fru::write_rules_binary(model.rules_set, file);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fru::read_rules_binary(file).get_rules_count());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  std::filesystem::remove(file);
+}
+} // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+BENCHMARK(BM_GetRulesIndexed)->ArgNames({"variables", "terms", "rules"})->ArgsProduct({{4}, {8}, {16, 64, 256, 1024, 4096}});
+BENCHMARK(BM_GetRulesIndexed)->ArgNames({"variables", "terms", "rules"})->Args({2, 2, 4})->Args({8, 2, 256})->Args({8, 4, 4096});
+BENCHMARK(BM_GetRulesIdsIndexed)->ArgNames({"variables", "terms", "rules"})->ArgsProduct({{4}, {8}, {16, 256, 4096}});
+BENCHMARK(BM_GetRulesIdsIndexed)->ArgNames({"variables", "terms", "rules"})->Args({8, 4, 4096})->Args({2, 64, 4096});
+BENCHMARK(BM_GetMatchingRulesScan)->ArgNames({"variables", "terms", "rules"})->ArgsProduct({{4}, {8}, {16, 64, 256, 1024, 4096}});
+BENCHMARK(BM_RulesBuildInCode)->ArgName("rules")->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RulesReadText)->ArgName("rules")->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RulesReadBinary)->ArgName("rules")->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
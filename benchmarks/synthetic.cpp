@@ -0,0 +1,97 @@
+#include "synthetic.hpp"
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <map>
+#include <random>
+#include <stdexcept>
+
+namespace fuzzyrulesml::benchmarks {
+namespace fru = fuzzyrulesml::rules;
+
+auto make_synthetic_model(const SyntheticShape& shape) -> SyntheticModel {
+  SyntheticModel model;
+  std::mt19937_64 generator{shape.seed};
+  const auto categories = std::vector<std::string>{"A", "B", "C"};
+  std::size_t cells = 1;
+  for (std::size_t i = 0; i < shape.variables; ++i) {
+    model.names.push_back(std::format("variable {}", i));
+    model.variables.push_back(
+        model.rules_set.add_input_variable(std::format("variable_{}", i), fru::initial_distribution::Uniform(0.0, 1.0, shape.terms)));
+    cells = std::min(cells * shape.terms, shape.rules + 1);
+  }
+  if (shape.rules > cells) {
+    throw std::runtime_error("More rules than the cells of the variables terms grid");
+  }
+  const auto output_variable = model.rules_set.add_output_variable("output", categories);
+  for (std::size_t cell = 0; cell < shape.rules; ++cell) {
+    std::map<fru::FuzzyVarUnion, std::size_t> preconditions;
+    auto remaining = cell;
+    for (const auto& variable : model.variables) {
+      preconditions.emplace(variable, remaining % shape.terms);
+      remaining /= shape.terms;
+    }
+    model.rules_set.add_rule(preconditions, {"output", categories[generator() % categories.size()]});
+  }
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+  std::uniform_real_distribution<double> crisp_values{-0.1, 1.1};
+  model.columns.resize(shape.variables);
+  for (auto& column : model.columns) {
+    column.resize(shape.rows);
+    std::ranges::generate(column, [&]() { return crisp_values(generator); });
+  }
+  model.targets.resize(shape.rows);
+  std::ranges::generate(model.targets, [&]() { return categories[generator() % categories.size()]; });
+  return model;
+}
+
+auto SyntheticModel::get_batch_inputs() const -> fru::BatchInputs {
+  fru::BatchInputs inputs;
+  for (std::size_t variable = 0; variable < variables.size(); ++variable) {
+    inputs.add_column(variables[variable], columns[variable]);
+  }
+  return inputs;
+}
+
+auto SyntheticModel::get_sample(std::size_t row) const -> fru::RuleTestingValues {
+  std::map<fru::FuzzyVarUnion, fru::CrispValuesUnion> values;
+  for (std::size_t variable = 0; variable < variables.size(); ++variable) {
+    values.emplace(variables[variable], columns[variable][row]);
+  }
+  return fru::RuleTestingValues{std::move(values)};
+}
+
+auto SyntheticModel::to_json() const -> std::pair<nlohmann::json, nlohmann::json> {
+  auto features = nlohmann::json::array();
+  auto classes = nlohmann::json::array();
+  for (std::size_t row = 0; row < targets.size(); ++row) {
+    nlohmann::json record;
+    for (std::size_t variable = 0; variable < names.size(); ++variable) {
+      record[names[variable]] = columns[variable][row];
+    }
+    features.push_back(std::move(record));
+    classes.push_back({{"class", targets[row]}});
+  }
+  return {std::move(features), std::move(classes)};
+}
+
+void SyntheticModel::write_json(const std::string& features_file, const std::string& targets_file) const {
+  const auto [features, classes] = to_json();
+  std::ofstream{features_file} << features;
+  std::ofstream{targets_file} << classes;
+}
+
+void SyntheticModel::write_csv(const std::string& file) const {
+  std::ofstream output{file};
+  for (const auto& name : names) {
+    output << name << ',';
+  }
+  output << "class\n";
+  for (std::size_t row = 0; row < targets.size(); ++row) {
+    for (const auto& column : columns) {
+      output << std::format("{},", column[row]);
+    }
+    output << targets[row] << '\n';
+  }
+}
+} // namespace fuzzyrulesml::benchmarks
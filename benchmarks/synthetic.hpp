@@ -0,0 +1,42 @@
+#pragma once
+
+#include "rules.hpp"
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fuzzyrulesml::benchmarks {
+// Shape of a synthetic model: input variables over [0, 1] with the same number of uniformly spread terms each, rules
+// and rows of the dataset
+struct SyntheticShape {
+  std::size_t variables{4};
+  std::size_t terms{2};
+  std::size_t rules{16};
+  std::size_t rows{1024};
+  std::uint64_t seed{42};
+};
+
+// SyntheticModel stands in for the downloaded iris files: its rules are the first shape.rules cells of the full grid
+// of the variables terms with random conclusions out of three, its rows are uniformly distributed crisp values (a bit
+// out of the variables range too) with random targets
+struct SyntheticModel {
+  fuzzyrulesml::rules::RulesSet rules_set;
+  std::vector<fuzzyrulesml::rules::FuzzyVariable<double>> variables;
+  // Dataset features names, one per variable
+  std::vector<std::string> names;
+  std::vector<std::vector<double>> columns;
+  std::vector<std::string> targets;
+
+  [[nodiscard]] auto get_batch_inputs() const -> fuzzyrulesml::rules::BatchInputs;
+  [[nodiscard]] auto get_sample(std::size_t row) const -> fuzzyrulesml::rules::RuleTestingValues;
+  // Features and targets as the JSON records the dataset loader reads
+  [[nodiscard]] auto to_json() const -> std::pair<nlohmann::json, nlohmann::json>;
+  // Writes the features and targets JSON files of the iris layout, or a CSV file with the "class" column
+  void write_json(const std::string& features_file, const std::string& targets_file) const;
+  void write_csv(const std::string& file) const;
+};
+
+[[nodiscard]] auto make_synthetic_model(const SyntheticShape& shape) -> SyntheticModel;
+} // namespace fuzzyrulesml::benchmarks
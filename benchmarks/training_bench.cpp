@@ -0,0 +1,115 @@
+#include "columnar.hpp"
+#include "gradient.hpp"
+#include "optimizer.hpp"
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include "synthetic.hpp"
+#include "training.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace fru = fuzzyrulesml::rules;
+namespace fre = fuzzyrulesml::reasoner;
+namespace frt = fuzzyrulesml::training;
+namespace frb = fuzzyrulesml::benchmarks;
+
+namespace {
+enum class Trainer { differential_evolution, adam, lbfgs };
+
+// Minimal gap between the points of a variable, of its [0, 1] range
+constexpr double min_gap = 0.05;
+
+// Dataset passes of a training until the cross entropy loss of the iris-like synthetic model reaches the target, the
+// same loss of the same unconstrained parameters for all the trainers; DE scores its members by the loss value, the
+// gradient methods take its gradient of the same pass too. Counters: passes to the target (the passes of the whole run
+// when it is not reached), all the passes, the best loss; arguments: rows, the percent of the gap between the start
+// loss and the one L-BFGS converges to the target closes
+void BM_TrainingPasses(benchmark::State& state, Trainer trainer) {
+  const auto model = frb::make_synthetic_model({.variables = 4, .terms = 2, .rules = 16, .rows = static_cast<std::size_t>(state.range(0))});
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  const auto inputs = model.get_batch_inputs();
+  const fru::ParametersBinding binding{inputs};
+  fuzzyrulesml::dataset::StringInterner classes;
+  const auto targets = model.targets | std::views::transform([&classes](const auto& target) { return classes.intern(target); }) |
+                       std::ranges::to<std::vector<std::uint32_t>>();
+  const frt::CrossEntropyLoss loss{reasoner, inputs, targets, classes.get_values()};
+  const auto start = loss.to_unconstrained(binding.get_parameters(), min_gap);
+
+  // The target is set by a run of L-BFGS to the convergence, out of the timed loop
+  const frt::DifferentiableObjective objective = [&loss](std::span<const double> parameters, std::span<double> gradient) {
+    return loss.evaluate_unconstrained(parameters, gradient, min_gap);
+  };
+  std::vector<double> gradient(start.size());
+  const auto start_loss = loss.evaluate_unconstrained(start, gradient, min_gap);
+  frt::GradientSettings converging{.method = frt::GradientMethod::lbfgs};
+  converging.iterations = 1000; // NOLINT(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+  const auto converged = frt::minimize_gradient(start, objective, converging);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+  const auto target_share = static_cast<double>(state.range(1)) / 100.0;
+  const auto target = start_loss - (target_share * (start_loss - converged.state.best_value));
+
+  std::size_t passes = 0;
+  std::size_t passes_to_target = 0;
+  const auto counted = [&](std::span<const double> parameters, std::span<double> partials) {
+    const auto value = objective(parameters, partials);
+    ++passes;
+    if (passes_to_target == 0 && value <= target) {
+      passes_to_target = passes;
+    }
+    return value;
+  };
+  double best_value = std::numeric_limits<double>::infinity();
+  for (auto _ : state) {
+    passes = 0;
+    passes_to_target = 0;
+    if (trainer == Trainer::differential_evolution) {
+      // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+      const auto lower =
+          start | std::views::transform([](double parameter) { return parameter - 2.0; }) | std::ranges::to<frt::Parameters>();
+      const auto upper =
+          start | std::views::transform([](double parameter) { return parameter + 2.0; }) | std::ranges::to<frt::Parameters>();
+      frt::DifferentialEvolutionSettings settings;
+      settings.generations = 500;
+      settings.target_value = target;
+      frt::DifferentialEvolution optimizer{lower, upper, settings};
+      // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+      std::vector<double> ignored(start.size());
+      best_value = optimizer.run(start, [&](std::span<const double> parameters) { return counted(parameters, ignored); }).best_value;
+    } else {
+      frt::GradientSettings settings{.method = trainer == Trainer::adam ? frt::GradientMethod::adam : frt::GradientMethod::lbfgs};
+      settings.iterations = 500; // NOLINT(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+      best_value = frt::minimize_gradient(start, counted, settings).state.best_value;
+    }
+  }
+  state.counters["passes_to_target"] = static_cast<double>(passes_to_target == 0 ? passes : passes_to_target);
+  state.counters["passes"] = static_cast<double>(passes);
+  state.counters["reached"] = passes_to_target == 0 ? 0.0 : 1.0;
+  state.counters["best_loss"] = best_value;
+  state.counters["target_loss"] = target;
+}
+} // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+BENCHMARK_CAPTURE(BM_TrainingPasses, de, Trainer::differential_evolution)
+    ->ArgNames({"rows", "target"})
+    ->Args({1024, 90})
+    ->Args({1024, 99})
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_TrainingPasses, adam, Trainer::adam)
+    ->ArgNames({"rows", "target"})
+    ->Args({1024, 90})
+    ->Args({1024, 99})
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_TrainingPasses, lbfgs, Trainer::lbfgs)
+    ->ArgNames({"rows", "target"})
+    ->Args({1024, 90})
+    ->Args({1024, 99})
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
@@ -0,0 +1,247 @@
+#include "binary_dataset.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace fuzzyrulesml::dataset {
+namespace {
+static_assert(std::endian::native == std::endian::little, "The binary columnar format is little endian");
+
+auto get_aligned(std::size_t offset) -> std::size_t {
+  return (offset + binary_format::columns_alignment - 1) / binary_format::columns_alignment * binary_format::columns_alignment;
+}
+
+class BinaryWriter {
+public:
+  explicit BinaryWriter(const std::string& file) : output{file, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc} {
+    if (not output.is_open()) {
+      throw std::runtime_error(std::format("Cannot open the file {}", file));
+    }
+  }
+  template <typename VALUE> void write(const VALUE& value) { write_bytes(std::as_bytes(std::span{&value, 1})); }
+  template <typename VALUE> void write(std::span<const VALUE> values) { write_bytes(std::as_bytes(values)); }
+  void write(std::string_view value) {
+    if (value.size() > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::runtime_error("Too long name for the binary format");
+    }
+    write(static_cast<std::uint32_t>(value.size()));
+    write_bytes(std::as_bytes(std::span{value}));
+  }
+  void pad_to(std::size_t offset) {
+    static constexpr std::array<std::byte, binary_format::columns_alignment> zeros{};
+    write_bytes(std::span{zeros}.first(offset - written));
+  }
+  void close() {
+    output.close();
+    if (output.fail()) {
+      throw std::runtime_error("Cannot write the binary dataset");
+    }
+  }
+  [[nodiscard]] auto get_written() const -> std::size_t { return written; }
+
+private:
+  void write_bytes(std::span<const std::byte> bytes) {
+    output.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    written += bytes.size();
+  }
+
+  std::ofstream output;
+  std::size_t written{0};
+};
+
+// Reads the header and names of the mapped bytes, checking each read against the file size
+class BinaryReader {
+public:
+  explicit BinaryReader(std::span<const std::byte> bytes) : bytes{bytes} {}
+  template <typename VALUE> auto read() -> VALUE {
+    VALUE value{};
+    std::memcpy(&value, take(sizeof(VALUE)).data(), sizeof(VALUE));
+    return value;
+  }
+  auto read_string() -> std::string_view {
+    const auto length = read<std::uint32_t>();
+    const auto characters = take(length);
+    return {reinterpret_cast<const char*>(characters.data()), characters.size()}; // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+  // Column of count values starting at the offset aligned for the columns; the mapping is page aligned, so the values
+  // are aligned too
+  template <typename VALUE> auto read_column(std::size_t count) -> std::span<const VALUE> {
+    if (count > (bytes.size() - offset) / sizeof(VALUE)) {
+      throw std::runtime_error("Truncated binary dataset");
+    }
+    const auto column = take(count * sizeof(VALUE));
+    return {reinterpret_cast<const VALUE*>(column.data()), count}; // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+  void skip_to(std::size_t position) {
+    if (position < offset) {
+      throw std::runtime_error("Invalid binary dataset layout");
+    }
+    static_cast<void>(take(position - offset));
+  }
+  [[nodiscard]] auto get_offset() const -> std::size_t { return offset; }
+  [[nodiscard]] auto is_finished() const -> bool { return offset == bytes.size(); }
+
+private:
+  auto take(std::size_t count) -> std::span<const std::byte> {
+    if (count > bytes.size() - offset) {
+      throw std::runtime_error("Truncated binary dataset");
+    }
+    const auto taken = bytes.subspan(offset, count);
+    offset += count;
+    return taken;
+  }
+
+  std::span<const std::byte> bytes;
+  std::size_t offset{0};
+};
+} // namespace
+
+void write_binary(const ColumnarStore& store, const std::string& file) {
+  const auto& names = store.get_features_names();
+  BinaryWriter writer{file};
+  writer.write(std::as_bytes(std::span{binary_format::magic}));
+  writer.write(binary_format::version);
+  writer.write(static_cast<std::uint32_t>(names.size()));
+  writer.write(static_cast<std::uint32_t>(store.get_classes().size()));
+  writer.write(binary_format::reserved);
+  writer.write(static_cast<std::uint64_t>(store.get_rows()));
+  for (std::size_t feature = 0; feature < names.size(); ++feature) {
+    writer.write(binary_format::ColumnType::float64);
+  }
+  for (const auto& name : names) {
+    writer.write(std::string_view{name});
+  }
+  for (const auto& name : store.get_classes()) {
+    writer.write(std::string_view{name});
+  }
+  writer.pad_to(get_aligned(writer.get_written()));
+  for (std::size_t feature = 0; feature < names.size(); ++feature) {
+    writer.write(store.get_column(feature));
+  }
+  writer.write(store.get_targets());
+  writer.close();
+}
+
+MappedFile::MappedFile(const std::string& file) {
+  const auto descriptor = ::open(file.c_str(), O_RDONLY | O_CLOEXEC); // NOLINT(cppcoreguidelines-pro-type-vararg)
+  if (descriptor < 0) {
+    throw std::runtime_error(std::format("Cannot open the file {}", file));
+  }
+  struct stat status {};
+  if (::fstat(descriptor, &status) != 0) {
+    ::close(descriptor);
+    throw std::runtime_error(std::format("Cannot read the size of the file {}", file));
+  }
+  size = static_cast<std::size_t>(status.st_size);
+  if (size > 0) {
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (mapped == MAP_FAILED) { // NOLINT(cppcoreguidelines-pro-type-cstyle-cast,performance-no-int-to-ptr)
+      ::close(descriptor);
+      throw std::runtime_error(std::format("Cannot map the file {}", file));
+    }
+    data = static_cast<const std::byte*>(mapped);
+  }
+  // The mapping stays valid after the descriptor is closed
+  ::close(descriptor);
+}
+
+MappedFile::~MappedFile() { unmap(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data{std::exchange(other.data, nullptr)}, size{std::exchange(other.size, 0)} {}
+
+auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile& {
+  if (this != &other) {
+    unmap();
+    data = std::exchange(other.data, nullptr);
+    size = std::exchange(other.size, 0);
+  }
+  return *this;
+}
+
+void MappedFile::unmap() noexcept {
+  if (data != nullptr) {
+    ::munmap(const_cast<std::byte*>(data), size); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    data = nullptr;
+  }
+}
+
+MappedDataset::MappedDataset(const std::string& file) : mapping{file} {
+  BinaryReader reader{mapping.get_bytes()};
+  std::array<char, binary_format::magic.size()> magic{};
+  for (auto& character : magic) {
+    character = reader.read<char>();
+  }
+  if (std::string_view{magic.data(), magic.size()} != binary_format::magic) {
+    throw std::runtime_error(std::format("{} is not a binary columnar dataset", file));
+  }
+  if (reader.read<std::uint32_t>() != binary_format::version) {
+    throw std::runtime_error("Unsupported version of the binary dataset");
+  }
+  const auto features_count = reader.read<std::uint32_t>();
+  const auto classes_count = reader.read<std::uint32_t>();
+  static_cast<void>(reader.read<std::uint32_t>()); // reserved
+  const auto rows = reader.read<std::uint64_t>();
+  for (std::uint32_t feature = 0; feature < features_count; ++feature) {
+    if (reader.read<binary_format::ColumnType>() != binary_format::ColumnType::float64) {
+      throw std::runtime_error("Unsupported column type of the binary dataset");
+    }
+  }
+  for (std::uint32_t feature = 0; feature < features_count; ++feature) {
+    const auto name = reader.read_string();
+    if (features.find(name)) {
+      throw std::runtime_error("Duplicated feature name");
+    }
+    features.intern(name);
+  }
+  for (std::uint32_t class_id = 0; class_id < classes_count; ++class_id) {
+    if (classes.intern(reader.read_string()) != class_id) {
+      throw std::runtime_error("Duplicated class name");
+    }
+  }
+  reader.skip_to(get_aligned(reader.get_offset()));
+  if (rows > std::numeric_limits<std::size_t>::max() / sizeof(double)) {
+    throw std::runtime_error("Truncated binary dataset");
+  }
+  for (std::uint32_t feature = 0; feature < features_count; ++feature) {
+    columns.push_back(reader.read_column<double>(rows));
+  }
+  targets = reader.read_column<std::uint32_t>(rows);
+  if (not reader.is_finished()) {
+    throw std::runtime_error("Unexpected data after the binary dataset columns");
+  }
+}
+
+void MappedDataset::check_targets() const {
+  const auto classes_count = get_classes().size();
+  if (std::ranges::any_of(targets, [classes_count](const auto class_id) { return class_id >= classes_count; })) {
+    throw std::runtime_error("Target class id out of the classes of the binary dataset");
+  }
+}
+
+auto MappedDataset::find_feature(std::string_view name) const -> std::optional<std::size_t> {
+  const auto found = features.find(name);
+  if (not found) {
+    return std::nullopt;
+  }
+  return *found;
+}
+
+auto MappedDataset::get_column(std::string_view name) const -> std::span<const double> {
+  const auto feature = find_feature(name);
+  if (not feature) {
+    throw std::out_of_range("Feature not found in the dataset");
+  }
+  return columns[*feature];
+}
+} // namespace fuzzyrulesml::dataset
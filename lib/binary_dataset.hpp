@@ -0,0 +1,77 @@
+#pragma once
+
+#include "columnar.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fuzzyrulesml::dataset {
+// Binary columnar dataset file, native (little endian) byte order:
+//   header:   magic "FRMLCOL1", version (uint32), features count (uint32), classes count (uint32), reserved (uint32,
+//             written as 0 and ignored on reading, it aligns the next field to 8 bytes), rows count (uint64), then the
+//             column type of each feature (uint32)
+//   names:    features names then classes names, each as its length (uint32) and characters
+//   columns:  at the first offset aligned to 64 bytes, a float64 column of rows values per feature, then the uint32
+//             class ids of the rows
+// The columns are read in place from the mapped file, so opening it costs the header only, whatever the rows count
+namespace binary_format {
+inline constexpr std::string_view magic{"FRMLCOL1"};
+inline constexpr std::uint32_t version = 1;
+inline constexpr std::uint32_t reserved = 0;
+inline constexpr std::size_t columns_alignment = 64;
+enum class ColumnType : std::uint32_t { float64 = 1 };
+} // namespace binary_format
+
+// Writes the store in the binary columnar format
+void write_binary(const ColumnarStore& store, const std::string& file);
+
+// MappedFile is a read-only memory mapping of a whole file, unmapped on destruction
+class MappedFile {
+public:
+  explicit MappedFile(const std::string& file);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  auto operator=(const MappedFile&) -> MappedFile& = delete;
+  auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+  [[nodiscard]] auto get_bytes() const -> std::span<const std::byte> { return {data, size}; }
+
+private:
+  void unmap() noexcept;
+
+  const std::byte* data{nullptr};
+  std::size_t size{0};
+};
+
+// MappedDataset opens a binary columnar file without copying the columns; it provides the reading interface of
+// ColumnarStore, the spans it returns are valid as long as the dataset lives. Opening does not read the rows, so the
+// class ids of the targets are trusted to be within the classes; check_targets verifies them off the hot path, e.g.
+// when get_items binds a view of the samples to the file
+class MappedDataset {
+public:
+  explicit MappedDataset(const std::string& file);
+
+  [[nodiscard]] auto get_features_names() const -> const std::vector<std::string>& { return features.get_values(); }
+  [[nodiscard]] auto find_feature(std::string_view name) const -> std::optional<std::size_t>;
+  [[nodiscard]] auto get_column(std::size_t feature) const -> std::span<const double> { return columns.at(feature); }
+  [[nodiscard]] auto get_column(std::string_view name) const -> std::span<const double>;
+  [[nodiscard]] auto get_targets() const -> std::span<const std::uint32_t> { return targets; }
+  [[nodiscard]] auto get_classes() const -> const std::vector<std::string>& { return classes.get_values(); }
+  [[nodiscard]] auto get_class(std::uint32_t class_id) const -> const std::string& { return classes.get(class_id); }
+  [[nodiscard]] auto get_rows() const -> std::size_t { return targets.size(); }
+  // Throws when a target is not a class id of the classes dictionary, e.g. of a corrupt file; reads the whole column
+  void check_targets() const;
+
+private:
+  MappedFile mapping;
+  StringInterner features;
+  StringInterner classes;
+  std::vector<std::span<const double>> columns;
+  std::span<const std::uint32_t> targets;
+};
+} // namespace fuzzyrulesml::dataset
@@ -0,0 +1,81 @@
+#include "columnar.hpp"
+#include <limits>
+#include <stdexcept>
+
+namespace fuzzyrulesml::dataset {
+
+auto StringInterner::intern(std::string_view value) -> std::uint32_t {
+  const auto found = ids.find(value);
+  if (found != ids.end()) {
+    return found->second;
+  }
+  if (values.size() >= std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error("Too many interned strings");
+  }
+  const auto id = static_cast<std::uint32_t>(values.size());
+  values.emplace_back(value);
+  ids.emplace(values.back(), id);
+  return id;
+}
+
+auto StringInterner::find(std::string_view value) const -> std::optional<std::uint32_t> {
+  const auto found = ids.find(value);
+  if (found == ids.end()) {
+    return std::nullopt;
+  }
+  return found->second;
+}
+
+ColumnarStore::ColumnarStore(const std::vector<std::string>& features_names) {
+  for (const auto& name : features_names) {
+    if (features.find(name)) {
+      throw std::runtime_error("Duplicated feature name");
+    }
+    features.intern(name);
+  }
+  columns.resize(features.size());
+}
+
+auto ColumnarStore::find_feature(std::string_view name) const -> std::optional<std::size_t> {
+  const auto found = features.find(name);
+  if (not found) {
+    return std::nullopt;
+  }
+  return *found;
+}
+
+auto ColumnarStore::get_column(std::string_view name) const -> std::span<const double> {
+  const auto feature = find_feature(name);
+  if (not feature) {
+    throw std::out_of_range("Feature not found in the dataset");
+  }
+  return columns[*feature];
+}
+
+void ColumnarStore::add_row(std::span<const double> row, std::uint32_t class_id) {
+  if (row.size() != columns.size()) {
+    throw std::runtime_error("Row size differs from the features count");
+  }
+  if (class_id >= classes.size()) {
+    throw std::runtime_error("Class id not interned");
+  }
+  for (std::size_t feature = 0; feature < row.size(); ++feature) {
+    columns[feature].push_back(row[feature]);
+  }
+  targets.push_back(class_id);
+}
+
+void ColumnarStore::reserve(std::size_t rows) {
+  for (auto& column : columns) {
+    column.reserve(rows);
+  }
+  targets.reserve(rows);
+}
+
+void ColumnarStore::clear_rows() {
+  for (auto& column : columns) {
+    column.clear();
+  }
+  targets.clear();
+}
+} // namespace fuzzyrulesml::dataset
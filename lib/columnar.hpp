@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace fuzzyrulesml::dataset {
+// Hash of the strings usable with std::string_view keys in the lookups, without building a std::string
+struct StringHash {
+  using is_transparent = void;
+  [[nodiscard]] auto operator()(std::string_view value) const -> std::size_t { return std::hash<std::string_view>{}(value); }
+};
+
+// StringInterner assigns dense ids to the strings, in the order of their first appearance
+class StringInterner {
+public:
+  auto intern(std::string_view value) -> std::uint32_t;
+  [[nodiscard]] auto find(std::string_view value) const -> std::optional<std::uint32_t>;
+  [[nodiscard]] auto get(std::uint32_t id) const -> const std::string& { return values.at(id); }
+  [[nodiscard]] auto get_values() const -> const std::vector<std::string>& { return values; }
+  [[nodiscard]] auto size() const -> std::size_t { return values.size(); }
+
+private:
+  std::vector<std::string> values;
+  std::unordered_map<std::string, std::uint32_t, StringHash, std::equal_to<>> ids;
+};
+
+// ColumnarStore keeps the numeric features of a dataset as one contiguous column per feature, and the targets as class
+// ids interned against the classes dictionary; the features names are interned once too
+class ColumnarStore {
+public:
+  ColumnarStore() = default;
+  explicit ColumnarStore(const std::vector<std::string>& features_names);
+
+  [[nodiscard]] auto get_features_names() const -> const std::vector<std::string>& { return features.get_values(); }
+  [[nodiscard]] auto find_feature(std::string_view name) const -> std::optional<std::size_t>;
+  [[nodiscard]] auto get_column(std::size_t feature) const -> std::span<const double> { return columns.at(feature); }
+  [[nodiscard]] auto get_column(std::string_view name) const -> std::span<const double>;
+  [[nodiscard]] auto get_targets() const -> std::span<const std::uint32_t> { return targets; }
+  [[nodiscard]] auto get_classes() const -> const std::vector<std::string>& { return classes.get_values(); }
+  [[nodiscard]] auto get_class(std::uint32_t class_id) const -> const std::string& { return classes.get(class_id); }
+  [[nodiscard]] auto get_rows() const -> std::size_t { return targets.size(); }
+
+  auto intern_class(std::string_view name) -> std::uint32_t { return classes.intern(name); }
+  // Appends a row of the features, in the features order
+  void add_row(std::span<const double> row, std::uint32_t class_id);
+  void reserve(std::size_t rows);
+  // Drops the rows but keeps the features and the classes, so the class ids stay valid across the chunks of a file
+  void clear_rows();
+
+private:
+  StringInterner features;
+  std::vector<std::vector<double>> columns;
+  std::vector<std::uint32_t> targets;
+  StringInterner classes;
+};
+} // namespace fuzzyrulesml::dataset
@@ -0,0 +1,44 @@
+#include "compiled_reasoner.hpp"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace fuzzyrulesml::reasoner {
+namespace {
+// Batch of no rows over all the input variables, resolving them to the posting lists in the slots order
+auto get_slots_plan(const SimpleReasoner& reasoner, const std::vector<fuzzyrulesml::rules::FuzzyVarUnion>& variables) -> SimpleReasoner::BatchPlan {
+  fuzzyrulesml::rules::BatchInputs slots;
+  for (const auto& variable : variables) {
+    slots.add_column(variable, {});
+  }
+  return reasoner.get_batch_plan(slots);
+}
+} // namespace
+
+CompiledReasoner::CompiledReasoner(const fuzzyrulesml::rules::RulesSet& rules, RulesLayout layout)
+    : reasoner{rules, layout}, variables{rules.get_input_variables()}, plan{get_slots_plan(reasoner, variables)},
+      scratch{reasoner.make_row_scratch()}, segments(variables.size()), degrees(variables.size()), scores(reasoner.get_conclusions().size()) {}
+
+auto CompiledReasoner::get_slot(std::string_view variable_name) const -> std::size_t {
+  const auto found = std::ranges::find(variables, variable_name, [](const auto& variable) -> std::string_view { return variable.get_name(); });
+  if (found == variables.end()) {
+    throw std::runtime_error("Input variable not found");
+  }
+  return static_cast<std::size_t>(std::distance(variables.begin(), found));
+}
+
+auto CompiledReasoner::infer(std::span<const double> values) noexcept -> std::span<const double> {
+  if (values.size() != variables.size()) {
+    return {};
+  }
+  for (std::size_t slot = 0; slot < variables.size(); ++slot) {
+    if (plan.uses(slot)) {
+      variables[slot].fuzzify(values.subspan(slot, 1), std::span{segments}.subspan(slot, 1), std::span{degrees}.subspan(slot, 1));
+    }
+  }
+  std::ranges::fill(scores, 0.0);
+  reasoner.score_row(plan, [this](std::size_t slot) { return std::pair{segments[slot], degrees[slot]}; }, scores, scratch);
+  return scores;
+}
+} // namespace fuzzyrulesml::reasoner
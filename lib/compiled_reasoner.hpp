@@ -0,0 +1,45 @@
+#pragma once
+
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace fuzzyrulesml::reasoner {
+// CompiledReasoner is a frozen copy of a rules set for serving single samples on a latency budget: the input variables
+// are resolved to slots, the posting lists (or the dense grid) to a batch plan and all the scratch buffers are
+// allocated when building, so infer only fuzzifies the values and scores them in place, without locks, allocations or
+// exceptions. Its points are the ones of the rules set variables when building. A reasoner is not shared between
+// threads, each of them builds its own
+class CompiledReasoner {
+public:
+  explicit CompiledReasoner(const fuzzyrulesml::rules::RulesSet& rules, RulesLayout layout = RulesLayout::automatic);
+  // The plan refers to the posting lists of the owned reasoner, which a copy would not
+  CompiledReasoner(const CompiledReasoner&) = delete;
+  auto operator=(const CompiledReasoner&) -> CompiledReasoner& = delete;
+  CompiledReasoner(CompiledReasoner&&) = default;
+  auto operator=(CompiledReasoner&&) -> CompiledReasoner& = default;
+  ~CompiledReasoner() = default;
+
+  // Slot of the input variable in the values given to infer; the slots are the variables ids order
+  [[nodiscard]] auto get_slot(std::string_view variable_name) const -> std::size_t;
+  [[nodiscard]] auto get_slots_count() const -> std::size_t { return variables.size(); }
+  // Conclusions being the scores infer returns
+  [[nodiscard]] auto get_conclusions() const -> const std::vector<fuzzyrulesml::rules::ConclusionChosen>& { return reasoner.get_conclusions(); }
+
+  // Scores of the crisp values, one per slot, the same as SimpleReasoner gives; the returned span is valid until the next
+  // call. Values of another count give an empty span
+  [[nodiscard]] auto infer(std::span<const double> values) noexcept -> std::span<const double>;
+
+private:
+  SimpleReasoner reasoner;
+  std::vector<fuzzyrulesml::rules::FuzzyVarUnion> variables;
+  SimpleReasoner::BatchPlan plan;
+  SimpleReasoner::RowScratch scratch;
+  std::vector<std::uint32_t> segments;
+  std::vector<double> degrees;
+  std::vector<double> scores;
+};
+} // namespace fuzzyrulesml::reasoner
@@ -1,5 +1,6 @@
 #include <fstream>
 #include <nlohmann/json.hpp>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include "dataset.hpp"
@@ -18,24 +19,40 @@ auto load_data(const std::string& input_file, const std::string& target_file)  -
   return std::pair{features_test, targets_test};
 }
 
-DataSet::DataSet(nlohmann::json x_data, nlohmann::json y_data) {
-  for (auto [x_item, y_item] : std::ranges::views::zip(x_data.items(), y_data.items())) {
-    const nlohmann::json x_object = x_item.value();
-    const nlohmann::json y_object = y_item.value();
-    data.emplace_back(x_object.get<typename DatasetFeatures::InternalStorage>(), y_object.at("class").get<DatasetTarget>());
+DataSet::DataSet(const nlohmann::json& x_data, const nlohmann::json& y_data) {
+  if (x_data.size() != y_data.size()) {
+    throw std::runtime_error("Features and targets of different lengths");
   }
-};
-
-auto DataSet::get_variables_names() const -> std::vector<std::string>{
-  std::vector<std::string> to_ret;
-  for (const auto& [x, y] : data) {
-    for (const auto& [key, value] : x) {
-      if (std::ranges::find(to_ret, key) == to_ret.end()) {
-        to_ret.push_back(key);
-      }
+  if (x_data.empty()) {
+    return;
+  }
+  store = ColumnarStore{x_data.front().items() | std::views::transform([](const auto& item) { return item.key(); }) |
+                        std::ranges::to<std::vector<std::string>>()};
+  store.reserve(x_data.size());
+  std::vector<double> row(store.get_features_names().size());
+  for (std::size_t index = 0; index < x_data.size(); ++index) {
+    const auto& x_object = x_data[index];
+    if (x_object.size() != row.size()) {
+      throw std::runtime_error("Records with different features");
     }
+    for (std::size_t feature = 0; feature < row.size(); ++feature) {
+      row[feature] = x_object.at(store.get_features_names()[feature]).get<double>();
+    }
+    store.add_row(row, store.intern_class(y_data[index].at("class").get<DatasetTarget>()));
   }
-  return to_ret;
+}
+
+auto DataSet::get_columns(const std::vector<std::string>& names) const -> std::vector<std::vector<double>> {
+  return names | std::views::transform([this](const auto& name) {
+           const auto column = store.get_column(name);
+           return std::vector<double>(column.begin(), column.end());
+         }) |
+         std::ranges::to<std::vector<std::vector<double>>>();
+}
+
+auto DataSet::get_targets() const -> std::vector<DatasetTarget> {
+  return store.get_targets() | std::views::transform([this](const auto class_id) { return store.get_class(class_id); }) |
+         std::ranges::to<std::vector<DatasetTarget>>();
 }
 
 } // namespace fuzzyrulesml::dataset
\ No newline at end of file
@@ -1,90 +1,132 @@
 #pragma once
+#include "columnar.hpp"
 #include "rules.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <map>
 #include <nlohmann/json.hpp>
 #include <print>
 #include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
-#include <algorithm>
 
 namespace fuzzyrulesml::dataset {
-class DataSet {
-private:
-  class RulesValuesContainer {
+// ItemsView is a lazy view of the dataset samples for the per-sample reasoning: the variables are bound to their
+// columns once, and each row is yielded on demand as a pair of its RuleTestingValues and target class id, so nothing
+// is stored per row. The batch reasoning takes the same binding through get_batch_inputs. The view refers to the
+// dataset columns and classes, so it must not outlive the dataset
+class ItemsView {
+public:
+  using value_type = std::pair<fuzzyrulesml::rules::RuleTestingValues, std::uint32_t>;
+
+  class Iterator {
   public:
-    void add(const fuzzyrulesml::rules::RuleTestingValues& rule_testing_values, const std::string& target) {
-      data.emplace_back(rule_testing_values, target);
+    using value_type = ItemsView::value_type;
+    using difference_type = std::ptrdiff_t;
+    Iterator() = default;
+    Iterator(const ItemsView* view, std::size_t row) : view{view}, row{row} {}
+    [[nodiscard]] auto operator*() const -> value_type { return view->get_item(row); }
+    auto operator++() -> Iterator& {
+      ++row;
+      return *this;
     }
-    [[nodiscard]] auto size() const { return data.size(); }
-    [[nodiscard]] auto begin() const { return data.begin(); }
-    [[nodiscard]] auto end() const { return data.end(); }
-    void print() const {
-      std::print("------------------------- Printing dataset -------------------------\n");
-      auto iter = 1;
-      for (const auto& [external_key, external_value] : data) {
-        std::print("[{}]\t", iter++);
-        for (const auto& [key, value] : external_key) {
-          std::print("{}: {:4}\t", key.to_string(), value.to_string());
-        }
-        std::print("{}\n", external_value);
-      }
-      std::print("-------------------------   End of dataset -------------------------\n");
+    auto operator++(int) -> Iterator {
+      auto previous = *this;
+      ++row;
+      return previous;
     }
+    [[nodiscard]] auto operator==(const Iterator& other) const -> bool { return row == other.row; }
 
   private:
-    std::vector<std::pair<fuzzyrulesml::rules::RuleTestingValues, std::string>> data;
+    const ItemsView* view{nullptr};
+    std::size_t row{0};
   };
 
-  class DatasetFeatures {
-  public:
-    using InternalStorage = std::map<std::string, double>;
-    DatasetFeatures(const InternalStorage& data) : data(data) {}
-    DatasetFeatures(InternalStorage&& data) : data(std::move(data)) {}
-    [[nodiscard]] auto begin() const { return data.begin(); }
-    [[nodiscard]] auto end() const { return data.end(); }
-    [[nodiscard]] auto at(const std::string& key) const -> double {
-      auto iter = data.find(key);
-      if (iter != data.end()) {
-        return iter->second;
+  ItemsView(std::vector<fuzzyrulesml::rules::FuzzyVarUnion> variables, std::vector<std::span<const double>> columns,
+            std::span<const std::uint32_t> targets, const std::vector<std::string>& classes)
+      : variables{std::move(variables)}, columns{std::move(columns)}, targets{targets}, classes{&classes} {}
+  [[nodiscard]] auto begin() const -> Iterator { return {this, 0}; }
+  [[nodiscard]] auto end() const -> Iterator { return {this, size()}; }
+  [[nodiscard]] auto size() const -> std::size_t { return targets.size(); }
+  [[nodiscard]] auto get_item(std::size_t row) const -> value_type {
+    std::map<fuzzyrulesml::rules::FuzzyVarUnion, fuzzyrulesml::rules::CrispValuesUnion> values;
+    for (std::size_t variable = 0; variable < variables.size(); ++variable) {
+      values.emplace(variables[variable], columns[variable][row]);
+    }
+    return {fuzzyrulesml::rules::RuleTestingValues{std::move(values)}, targets[row]};
+  }
+  [[nodiscard]] auto get_batch_inputs() const -> fuzzyrulesml::rules::BatchInputs {
+    fuzzyrulesml::rules::BatchInputs inputs;
+    for (std::size_t variable = 0; variable < variables.size(); ++variable) {
+      inputs.add_column(variables[variable], columns[variable]);
+    }
+    return inputs;
+  }
+  [[nodiscard]] auto get_targets() const -> std::span<const std::uint32_t> { return targets; }
+  // Names of the classes, indexed by the class ids of the items
+  [[nodiscard]] auto get_classes() const -> const std::vector<std::string>& { return *classes; }
+  void print() const {
+    std::print("------------------------- Printing dataset -------------------------\n");
+    for (std::size_t row = 0; row < size(); ++row) {
+      std::print("[{}]\t", row + 1);
+      for (std::size_t variable = 0; variable < variables.size(); ++variable) {
+        std::print("{}: {:4}\t", variables[variable].to_string(), columns[variable][row]);
       }
-      throw std::out_of_range("Key not found in DatasetFeatures");
+      std::print("{}\n", (*classes)[targets[row]]);
     }
+    std::print("-------------------------   End of dataset -------------------------\n");
+  }
 
-  private:
-    std::map<std::string, double> data;
-  };
+private:
+  std::vector<fuzzyrulesml::rules::FuzzyVarUnion> variables;
+  std::vector<std::span<const double>> columns;
+  std::span<const std::uint32_t> targets;
+  const std::vector<std::string>* classes;
+};
+
+// Lazy view of the samples of a columnar store, ColumnarStore or MappedDataset, see ItemsView; the arguments are (name,
+// variable) pairs binding the variables to the columns. The view refers to the store columns, so a mapped file is read
+// in place, without copying its rows. A store trusting its targets, like MappedDataset, has them checked first, since
+// the view indexes the classes by them
+template <typename STORE, typename... Targs> [[nodiscard]] auto get_items(const STORE& store, Targs... Fargs) -> ItemsView {
+  if constexpr (requires { store.check_targets(); }) {
+    store.check_targets();
+  }
+  return ItemsView{{fuzzyrulesml::rules::FuzzyVarUnion{Fargs.second}...}, {store.get_column(Fargs.first)...}, store.get_targets(),
+                   store.get_classes()};
+}
 
+// DataSet stores the features as one contiguous column per feature and the targets as class ids against the classes
+// dictionary, see ColumnarStore; columns are looked up by their names in O(1)
+class DataSet {
 public:
   using DatasetTarget = std::string;
 
-  DataSet(nlohmann::json x_data, nlohmann::json y_data);
-  [[nodiscard]] auto get_variables_names() const -> std::vector<std::string>;
+  // Features are the keys of the first record, the same for all the records
+  DataSet(const nlohmann::json& x_data, const nlohmann::json& y_data);
+  explicit DataSet(ColumnarStore&& store) : store{std::move(store)} {}
+  [[nodiscard]] auto get_variables_names() const -> const std::vector<std::string>& { return store.get_features_names(); }
+  [[nodiscard]] auto get_column(std::string_view name) const -> std::span<const double> { return store.get_column(name); }
+  // Columns of the features, in the order of the names; an input for the batch reasoning
+  [[nodiscard]] auto get_columns(const std::vector<std::string>& names) const -> std::vector<std::vector<double>>;
+  [[nodiscard]] auto get_targets() const -> std::vector<DatasetTarget>;
+  [[nodiscard]] auto get_target_ids() const -> std::span<const std::uint32_t> { return store.get_targets(); }
+  [[nodiscard]] auto get_classes() const -> const std::vector<std::string>& { return store.get_classes(); }
+  [[nodiscard]] auto get_rows() const -> std::size_t { return store.get_rows(); }
+  [[nodiscard]] auto get_store() const -> const ColumnarStore& { return store; }
 
-  template <typename... Targs> auto get_internal_items(auto item, auto variable_name_itself, Targs... Fargs) {
-    const auto [name, variable] = variable_name_itself;
-    auto partial_map = get_internal_items(item, Fargs...);
-    partial_map.add(variable, item.at(name));
-    return partial_map;
-  };
-
-  auto get_internal_items(auto item, auto variable_name_itself) -> fuzzyrulesml::rules::RuleTestingValues {
-    const auto [name, variable] = variable_name_itself;
-    return fuzzyrulesml::rules::RuleTestingValues{fuzzyrulesml::rules::FuzzyVarUnion{variable},
-                                                  fuzzyrulesml::rules::CrispValuesUnion{item.at(name)}};
-  };
-
-  template <typename... Targs> auto get_items(Targs... Fargs) {
-    RulesValuesContainer to_ret;
-    for (const auto& [item, target] : data) {
-      auto rule_testing_values = get_internal_items(item, Fargs...);
-      to_ret.add(rule_testing_values, target);
-    }
-    return to_ret;
+  // Lazy view of the samples with their target class ids, see ItemsView; the arguments are (name, variable) pairs
+  // binding the variables to the columns
+  template <typename... Targs> [[nodiscard]] auto get_items(Targs... Fargs) const -> ItemsView {
+    return fuzzyrulesml::dataset::get_items(store, Fargs...);
   };
 
 private:
-  std::vector<std::pair<DatasetFeatures, DatasetTarget>> data;
+  ColumnarStore store;
 };
 
 auto load_data(const std::string& input_file, const std::string& target_file) -> std::pair<nlohmann::json, nlohmann::json>;
@@ -0,0 +1,252 @@
+#include "fuzzify_kernels.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FUZZYRULESML_X86_KERNELS
+#endif
+
+namespace fuzzyrulesml::mfunct {
+namespace {
+// Branch-free formulation shared by all the kernels: the segment is the count of the inner points not greater than the
+// value (or, for many points, the result of a branch-free bisection), the degree is computed for that segment and
+// overridden by selects for the values out of the points range
+const std::size_t counted_segments_limit = 8;
+// Gathers make the vectorized bisection pay off only for many more segments
+const std::size_t avx2_counted_segments_limit = 64;
+const std::size_t short_column_limit = 4;
+
+auto bisect_segment(std::span<const double> points, double value) -> std::uint32_t {
+  const auto last_segment = static_cast<std::uint32_t>(points.size() - 2);
+  std::uint32_t segment = 0;
+  for (auto step = std::bit_floor(last_segment); step > 0; step /= 2) {
+    const auto candidate = segment + step;
+    segment = (candidate <= last_segment && points[candidate] <= value) ? candidate : segment;
+  }
+  return segment;
+}
+
+// NaN values fail all the comparisons of the kernels, so they are found in a lane mask and fixed after the vector
+void mark_missing(std::span<const double> values, std::span<std::uint32_t> segments, std::span<double> degrees, std::size_t first,
+                  std::size_t count) {
+  for (auto i = first; i < first + count; ++i) {
+    if (std::isnan(values[i])) {
+      segments[i] = no_segment;
+      degrees[i] = 0.0;
+    }
+  }
+}
+
+void fuzzify_scalar(std::span<const double> points, std::span<const double> values, std::span<std::uint32_t> segments,
+                    std::span<double> degrees, std::size_t first) {
+  const auto last_segment = points.size() - 2;
+  for (std::size_t i = first; i < values.size(); ++i) {
+    const auto value = values[i];
+    if (std::isnan(value)) {
+      segments[i] = no_segment;
+      degrees[i] = 0.0;
+      continue;
+    }
+    std::uint32_t segment = 0;
+    if (last_segment <= counted_segments_limit) {
+      for (std::size_t point = 1; point <= last_segment; ++point) {
+        segment += points[point] <= value ? 1U : 0U;
+      }
+    } else {
+      segment = bisect_segment(points, value);
+    }
+    const auto segment_end = points[segment + 1];
+    auto degree = (segment_end - value) / (segment_end - points[segment]);
+    degree = value >= points.back() ? 0.0 : degree;
+    degree = value < points.front() ? 1.0 : degree;
+    segments[i] = segment;
+    degrees[i] = degree;
+  }
+}
+
+// The counting and the stepping bisection of the kernels find the segment only when it is unique, for sorted points
+void fuzzify_unsorted(std::span<const double> points, std::span<const double> values, std::span<std::uint32_t> segments,
+                      std::span<double> degrees) {
+  const auto last_segment = static_cast<std::uint32_t>(points.size() - 2);
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    const auto value = values[i];
+    if (std::isnan(value)) {
+      segments[i] = no_segment;
+      degrees[i] = 0.0;
+    } else if (value < points.front()) {
+      segments[i] = 0;
+      degrees[i] = 1.0;
+    } else if (value >= points.back()) {
+      segments[i] = last_segment;
+      degrees[i] = 0.0;
+    } else {
+      const auto segment = bisect_points(points, value);
+      segments[i] = static_cast<std::uint32_t>(segment);
+      degrees[i] = (points[segment + 1] - value) / (points[segment + 1] - points[segment]);
+    }
+  }
+}
+
+#ifdef FUZZYRULESML_X86_KERNELS
+__attribute__((target("sse2"))) void fuzzify_sse2(std::span<const double> points, std::span<const double> values,
+                                                   std::span<std::uint32_t> segments, std::span<double> degrees) {
+  const auto last_segment = points.size() - 2;
+  const auto lanes = std::size_t{2};
+  const auto first_point = _mm_set1_pd(points.front());
+  const auto last_point = _mm_set1_pd(points.back());
+  const auto zero = _mm_setzero_pd();
+  const auto one = _mm_set1_pd(1.0);
+  std::size_t i = 0;
+  for (; i + lanes <= values.size(); i += lanes) {
+    const auto value = _mm_loadu_pd(&values[i]);
+    if (last_segment <= counted_segments_limit) {
+      auto segment = zero;
+      for (std::size_t point = 1; point <= last_segment; ++point) {
+        segment = _mm_add_pd(segment, _mm_and_pd(_mm_cmple_pd(_mm_set1_pd(points[point]), value), one));
+      }
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(&segments[i]), _mm_cvtpd_epi32(segment)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    } else {
+      segments[i] = bisect_segment(points, values[i]);
+      segments[i + 1] = bisect_segment(points, values[i + 1]);
+    }
+    const auto segment_begin = _mm_set_pd(points[segments[i + 1]], points[segments[i]]);
+    const auto segment_end = _mm_set_pd(points[segments[i + 1] + 1], points[segments[i] + 1]);
+    auto degree = _mm_div_pd(_mm_sub_pd(segment_end, value), _mm_sub_pd(segment_end, segment_begin));
+    const auto above = _mm_cmpge_pd(value, last_point);
+    degree = _mm_or_pd(_mm_and_pd(above, zero), _mm_andnot_pd(above, degree));
+    const auto below = _mm_cmplt_pd(value, first_point);
+    degree = _mm_or_pd(_mm_and_pd(below, one), _mm_andnot_pd(below, degree));
+    _mm_storeu_pd(&degrees[i], degree);
+    if (_mm_movemask_pd(_mm_cmpunord_pd(value, value)) != 0) {
+      mark_missing(values, segments, degrees, i, lanes);
+    }
+  }
+  fuzzify_scalar(points, values, segments, degrees, i);
+}
+
+__attribute__((target("avx2"))) void fuzzify_avx2(std::span<const double> points, std::span<const double> values,
+                                                   std::span<std::uint32_t> segments, std::span<double> degrees) {
+  const auto last_segment = points.size() - 2;
+  const auto lanes = std::size_t{4};
+  const auto first_point = _mm256_set1_pd(points.front());
+  const auto last_point = _mm256_set1_pd(points.back());
+  const auto zero = _mm256_setzero_pd();
+  const auto one = _mm256_set1_pd(1.0);
+  const auto all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+  const auto infinity = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+  const auto segments_end = _mm_set1_epi32(static_cast<int>(last_segment + 1));
+  const auto pack_lanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  std::size_t i = 0;
+  for (; i + lanes <= values.size(); i += lanes) {
+    const auto value = _mm256_loadu_pd(&values[i]);
+    __m128i segment_index;
+    if (last_segment <= avx2_counted_segments_limit) {
+      auto segment = zero;
+      for (std::size_t point = 1; point <= last_segment; ++point) {
+        segment = _mm256_add_pd(segment, _mm256_and_pd(_mm256_cmp_pd(_mm256_set1_pd(points[point]), value, _CMP_LE_OQ), one));
+      }
+      segment_index = _mm256_cvtpd_epi32(segment);
+    } else {
+      // Branch-free bisection: a lane moves to the candidate segment when its start point is not greater than the value;
+      // the candidates past the last segment gather infinity, which does not stop a +inf value, so they are masked out
+      segment_index = _mm_setzero_si128();
+      for (auto step = std::bit_floor(static_cast<std::uint32_t>(last_segment)); step > 0; step /= 2) {
+        const auto candidate = _mm_add_epi32(segment_index, _mm_set1_epi32(static_cast<int>(step)));
+        const auto in_range = _mm_cmplt_epi32(candidate, segments_end);
+        const auto candidate_point =
+            _mm256_mask_i32gather_pd(infinity, points.data(), candidate, _mm256_castsi256_pd(_mm256_cvtepi32_epi64(in_range)), sizeof(double));
+        const auto moves = _mm_and_si128(
+            in_range, _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(
+                          _mm256_castpd_si256(_mm256_cmp_pd(candidate_point, value, _CMP_LE_OQ)), pack_lanes)));
+        segment_index = _mm_blendv_epi8(segment_index, candidate, moves);
+      }
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&segments[i]), segment_index); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto segment_begin = _mm256_mask_i32gather_pd(zero, points.data(), segment_index, all_lanes, sizeof(double));
+    const auto segment_end = _mm256_mask_i32gather_pd(zero, std::next(points.data()), segment_index, all_lanes, sizeof(double));
+    auto degree = _mm256_div_pd(_mm256_sub_pd(segment_end, value), _mm256_sub_pd(segment_end, segment_begin));
+    degree = _mm256_blendv_pd(degree, zero, _mm256_cmp_pd(value, last_point, _CMP_GE_OQ));
+    degree = _mm256_blendv_pd(degree, one, _mm256_cmp_pd(value, first_point, _CMP_LT_OQ));
+    _mm256_storeu_pd(&degrees[i], degree);
+    if (_mm256_movemask_pd(_mm256_cmp_pd(value, value, _CMP_UNORD_Q)) != 0) {
+      mark_missing(values, segments, degrees, i, lanes);
+    }
+  }
+  fuzzify_scalar(points, values, segments, degrees, i);
+}
+#endif
+} // namespace
+
+auto is_supported(FuzzifyKernel kernel) -> bool {
+  switch (kernel) {
+  case FuzzifyKernel::scalar:
+    return true;
+#ifdef FUZZYRULESML_X86_KERNELS
+  case FuzzifyKernel::sse2:
+    return __builtin_cpu_supports("sse2") != 0;
+  case FuzzifyKernel::avx2:
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+  default:
+    return false;
+  }
+}
+
+auto get_best_fuzzify_kernel() -> FuzzifyKernel {
+  static const auto best_kernel = is_supported(FuzzifyKernel::avx2)   ? FuzzifyKernel::avx2
+                                  : is_supported(FuzzifyKernel::sse2) ? FuzzifyKernel::sse2
+                                                                      : FuzzifyKernel::scalar;
+  return best_kernel;
+}
+
+auto to_string(FuzzifyKernel kernel) -> std::string_view {
+  switch (kernel) {
+  case FuzzifyKernel::sse2:
+    return "sse2";
+  case FuzzifyKernel::avx2:
+    return "avx2";
+  default:
+    return "scalar";
+  }
+}
+
+void fuzzify_column(std::span<const double> points, std::span<const double> values, std::span<std::uint32_t> segments,
+                    std::span<double> degrees) {
+  // Columns shorter than the vector lanes, e.g. single samples, only pay for the set up of the vector kernels
+  fuzzify_column(values.size() < short_column_limit ? FuzzifyKernel::scalar : get_best_fuzzify_kernel(), points, values, segments, degrees);
+}
+
+void fuzzify_column(FuzzifyKernel kernel, std::span<const double> points, std::span<const double> values,
+                    std::span<std::uint32_t> segments, std::span<double> degrees) {
+  if (points.size() < 2) {
+    throw std::runtime_error("Invalid number of characteristic points");
+  }
+  if (segments.size() < values.size() || degrees.size() < values.size()) {
+    throw std::runtime_error("Output columns shorter than the values column");
+  }
+  if (not is_supported(kernel)) {
+    throw std::runtime_error("Fuzzification kernel not supported by the CPU");
+  }
+  if (not std::ranges::is_sorted(points)) {
+    fuzzify_unsorted(points, values, segments, degrees);
+    return;
+  }
+  switch (kernel) {
+#ifdef FUZZYRULESML_X86_KERNELS
+  case FuzzifyKernel::sse2:
+    fuzzify_sse2(points, values, segments, degrees);
+    return;
+  case FuzzifyKernel::avx2:
+    fuzzify_avx2(points, values, segments, degrees);
+    return;
+#endif
+  default:
+    fuzzify_scalar(points, values, segments, degrees, 0);
+  }
+}
+} // namespace fuzzyrulesml::mfunct
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+
+namespace fuzzyrulesml::mfunct {
+// Column fuzzification of a LinearDistribution given by its characteristic points. For each crisp value it produces
+// the segment s, such that points[s] <= value < points[s + 1], and the degree d of the membership function s; the
+// membership function s + 1 has the degree 1 - d. Values below the first point give (0, 1.0), values not below the
+// last point give (points.size() - 2, 0.0), the same as LinearDistribution::operator() does; NaN values, e.g. missing
+// features, give (no_segment, 0.0) and fire no function. Not sorted points, e.g. set by an optimizer, satisfy it in
+// more than one segment, so the columns of such points take the segments of bisect_points, as the operator does
+enum class FuzzifyKernel { scalar, sse2, avx2 };
+
+// Segment of a value that fires no membership function, e.g. for the variables not having a double distribution
+inline constexpr std::uint32_t no_segment = std::numeric_limits<std::uint32_t>::max();
+
+// Segment of a value by bisection of all the points: the bisection keeps points[lower] <= value < points[upper], so the
+// segment satisfies points[segment] <= value < points[segment + 1] also for not sorted points. Precondition:
+// points.front() <= value < points.back()
+template <typename POINT> [[nodiscard]] constexpr auto bisect_points(std::span<const POINT> points, POINT value) -> std::size_t {
+  std::size_t lower = 0;
+  std::size_t upper = points.size() - 1;
+  while (upper - lower > 1) {
+    const auto middle = lower + ((upper - lower) / 2);
+    if (points[middle] <= value) {
+      lower = middle;
+    } else {
+      upper = middle;
+    }
+  }
+  return lower;
+}
+
+// The best kernel supported by the CPU, detected at runtime
+[[nodiscard]] auto get_best_fuzzify_kernel() -> FuzzifyKernel;
+[[nodiscard]] auto is_supported(FuzzifyKernel kernel) -> bool;
+[[nodiscard]] auto to_string(FuzzifyKernel kernel) -> std::string_view;
+
+void fuzzify_column(std::span<const double> points, std::span<const double> values, std::span<std::uint32_t> segments,
+                    std::span<double> degrees);
+void fuzzify_column(FuzzifyKernel kernel, std::span<const double> points, std::span<const double> values,
+                    std::span<std::uint32_t> segments, std::span<double> degrees);
+} // namespace fuzzyrulesml::mfunct
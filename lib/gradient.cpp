@@ -0,0 +1,191 @@
+#include "gradient.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace fuzzyrulesml::training {
+namespace {
+constexpr std::size_t no_conclusion = std::numeric_limits<std::size_t>::max();
+// Added to each score, so the rows firing no rule of their class have a finite loss
+constexpr double score_floor = 1e-9;
+// Gaps not above min_gap are kept this much above it by to_unconstrained, the softplus never reaching 0
+constexpr double min_softplus = 1e-12;
+
+auto softplus(double parameter) -> double {
+  return parameter > 0.0 ? parameter + std::log1p(std::exp(-parameter)) : std::log1p(std::exp(parameter));
+}
+auto sigmoid(double parameter) -> double { return 1.0 / (1.0 + std::exp(-parameter)); }
+} // namespace
+
+CrossEntropyLoss::CrossEntropyLoss(const fuzzyrulesml::reasoner::SimpleReasoner& reasoner, const fuzzyrulesml::rules::BatchInputs& inputs,
+                                   std::span<const std::uint32_t> targets, const std::vector<std::string>& classes)
+    : reasoner{reasoner}, inputs{inputs}, targets{targets}, plan{reasoner.get_batch_plan(inputs)}, offsets{0} {
+  if (targets.size() != inputs.get_rows()) {
+    throw std::runtime_error("Targets count differs from the batch rows count");
+  }
+  const auto& variables = inputs.get_variables();
+  for (const auto& variable : variables) {
+    offsets.push_back(offsets.back() + variable.get_points().size());
+  }
+  const auto& rules = reasoner.get_rules();
+  for (std::size_t rule_id = 0; rule_id < rules.get_rules_count(); ++rule_id) {
+    preconditions_offsets.push_back(preconditions.size());
+    for (const auto& [variable_id, term] : rules.get_rule_preconditions(rule_id)) {
+      const auto found = std::ranges::find_if(variables, [&rules, variable_id](const auto& variable) {
+        return variable.get_id() == variable_id && rules.contains(variable);
+      });
+      // The rules of a variable out of the batch never fire, so their preconditions are not visited
+      if (found != variables.end()) {
+        preconditions.push_back({.column = static_cast<std::uint32_t>(std::distance(variables.begin(), found)),
+                                 .term = term});
+      }
+    }
+  }
+  preconditions_offsets.push_back(preconditions.size());
+  classes_conclusions.assign(classes.size(), no_conclusion);
+  const auto conclusions_classes = fuzzyrulesml::reasoner::get_conclusions_classes(reasoner.get_conclusions(), classes);
+  for (std::size_t conclusion = conclusions_classes.size(); conclusion-- > 0;) {
+    if (conclusions_classes[conclusion] != fuzzyrulesml::reasoner::no_class) {
+      classes_conclusions[conclusions_classes[conclusion]] = conclusion;
+    }
+  }
+}
+
+auto CrossEntropyLoss::evaluate(std::span<const double> candidate, std::span<double> gradient, std::size_t threads) const -> double {
+  if (candidate.size() != size() || gradient.size() != size()) {
+    throw std::runtime_error("Candidate does not match the batch variables");
+  }
+  std::vector<RowsSums> parts(fuzzyrulesml::parallel::get_parts_count(threads, inputs.get_rows()));
+  fuzzyrulesml::parallel::parallel_for(threads, inputs.get_rows(), [&](std::size_t part, std::size_t first, std::size_t count) {
+    evaluate_rows(candidate, first, count, parts[part]);
+  });
+  std::ranges::fill(gradient, 0.0);
+  double loss = 0.0;
+  std::size_t rows = 0;
+  for (const auto& part : parts) {
+    loss += part.loss;
+    rows += part.rows;
+    if (not part.gradient.empty()) {
+      std::ranges::transform(gradient, part.gradient, gradient.begin(), std::plus{});
+    }
+  }
+  if (rows == 0) {
+    return 0.0;
+  }
+  const auto scale = 1.0 / static_cast<double>(rows);
+  std::ranges::transform(gradient, gradient.begin(), [scale](double value) { return value * scale; });
+  return loss * scale;
+}
+
+// Fires the rows through the reasoner and aggregates their scores by its policy; the derivative of the loss with
+// respect to each score is then carried back through the fired rules strengths to the degrees of their preconditions,
+// and through the degrees to the two points of the segment around the value
+void CrossEntropyLoss::evaluate_rows(std::span<const double> candidate, std::size_t first, std::size_t count, RowsSums& sums) const {
+  using Reasoner = fuzzyrulesml::reasoner::SimpleReasoner;
+  const auto& variables = inputs.get_variables();
+  const auto& columns = inputs.get_columns();
+  const auto columns_count = variables.size();
+  auto scratch = reasoner.make_row_scratch();
+  std::vector<double> scores(reasoner.get_conclusions().size());
+  std::vector<double> degrees_gradient(columns_count, 0.0);
+  sums.gradient.assign(candidate.size(), 0.0);
+  const auto fuzzify = [&](std::size_t column, auto values, auto segments, auto degrees) {
+    variables[column].fuzzify(candidate.subspan(offsets[column], offsets[column + 1] - offsets[column]), values, segments, degrees);
+  };
+
+  reasoner.for_each_fuzzified_row(plan, inputs, first, count, fuzzify, [&](std::size_t row, const auto& fuzzified) {
+    const auto target = targets[row];
+    const auto target_conclusion = target < classes_conclusions.size() ? classes_conclusions[target] : no_conclusion;
+    if (target_conclusion == no_conclusion) {
+      return;
+    }
+    const auto fired = reasoner.fire_row(plan, fuzzified, scratch);
+    std::ranges::fill(scores, 0.0);
+    Reasoner::AggregationPolicy::combine(scores, fired.conclusions, fired.strengths);
+
+    // -log p: its derivative is 1 / total for each score, less 1 / target score for the target one; the sum
+    // aggregation passes it to the strengths of the fired rules as is
+    double total = 0.0;
+    for (const auto score : scores) {
+      total += score + score_floor;
+    }
+    const auto target_score = scores[target_conclusion] + score_floor;
+    sums.loss += std::log(total) - std::log(target_score);
+    ++sums.rows;
+    for (std::size_t index = 0; index < fired.rules.size(); ++index) {
+      const auto rule_id = fired.rules[index];
+      const auto score_gradient = (1.0 / total) - (fired.conclusions[index] == target_conclusion ? 1.0 / target_score : 0.0);
+      const auto strength_gradient = score_gradient * fired.strengths[index];
+      for (std::size_t precondition = preconditions_offsets[rule_id]; precondition < preconditions_offsets[rule_id + 1]; ++precondition) {
+        const auto [column, term] = preconditions[precondition];
+        const auto [segment, degree] = fuzzified(column);
+        // The product t-norm: the term of the segment has the degree, the next one 1 - degree; both are positive for
+        // a fired rule
+        degrees_gradient[column] += term == segment ? strength_gradient / degree : -strength_gradient / (1.0 - degree);
+      }
+    }
+    for (std::size_t column = 0; column < columns_count; ++column) {
+      if (degrees_gradient[column] == 0.0) {
+        continue;
+      }
+      const auto points = candidate.subspan(offsets[column], offsets[column + 1] - offsets[column]);
+      const auto value = columns[column][row];
+      // The degree (next - value) / (next - point) of the segment has the derivatives degree / width with respect to
+      // its first point and (1 - degree) / width with respect to the next one; the shoulders are flat
+      if (value >= points.front() && value < points.back()) {
+        const auto [segment, degree] = fuzzified(column);
+        const auto width = points[segment + 1] - points[segment];
+        sums.gradient[offsets[column] + segment] += degrees_gradient[column] * degree / width;
+        sums.gradient[offsets[column] + segment + 1] += degrees_gradient[column] * (1.0 - degree) / width;
+      }
+      degrees_gradient[column] = 0.0;
+    }
+  });
+}
+
+auto CrossEntropyLoss::to_unconstrained(std::span<const double> candidate, double min_gap) const -> std::vector<double> {
+  if (candidate.size() != size()) {
+    throw std::runtime_error("Candidate does not match the batch variables");
+  }
+  std::vector<double> parameters(candidate.begin(), candidate.end());
+  for (std::size_t column = 0; column + 1 < offsets.size(); ++column) {
+    for (auto point = offsets[column] + 1; point < offsets[column + 1]; ++point) {
+      // The inverse of the softplus, x + log(1 - exp(-x))
+      const auto excess = std::max(candidate[point] - candidate[point - 1] - min_gap, min_softplus);
+      parameters[point] = excess + std::log(-std::expm1(-excess));
+    }
+  }
+  return parameters;
+}
+
+auto CrossEntropyLoss::from_unconstrained(std::span<const double> parameters, double min_gap) const -> std::vector<double> {
+  if (parameters.size() != size()) {
+    throw std::runtime_error("Candidate does not match the batch variables");
+  }
+  std::vector<double> candidate(parameters.begin(), parameters.end());
+  for (std::size_t column = 0; column + 1 < offsets.size(); ++column) {
+    for (auto point = offsets[column] + 1; point < offsets[column + 1]; ++point) {
+      candidate[point] = candidate[point - 1] + min_gap + softplus(parameters[point]);
+    }
+  }
+  return candidate;
+}
+
+auto CrossEntropyLoss::evaluate_unconstrained(std::span<const double> parameters, std::span<double> gradient, double min_gap,
+                                              std::size_t threads) const -> double {
+  const auto candidate = from_unconstrained(parameters, min_gap);
+  const auto value = evaluate(candidate, gradient, threads);
+  // Each parameter moves its point and all the next points of the variable, scaled by the softplus derivative
+  for (std::size_t column = 0; column + 1 < offsets.size(); ++column) {
+    double moved = 0.0;
+    for (auto point = offsets[column + 1]; point-- > offsets[column];) {
+      moved += gradient[point];
+      gradient[point] = point == offsets[column] ? moved : moved * sigmoid(parameters[point]);
+    }
+  }
+  return value;
+}
+} // namespace fuzzyrulesml::training
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace fuzzyrulesml::training {
+// CrossEntropyLoss is a differentiable training objective of the characteristic points: the mean over the rows of
+// -log p, p being the score of the target class conclusion normalized by the sum of all the scores. The rows are fired
+// by the reasoner itself, see BasicReasoner::fire_row; its product t-norm and sum aggregation make a rule strength a
+// product of piecewise linear degrees, so its derivative with respect to the points of the segment around the value
+// is exact; the shoulders beyond the first and the last points are flat. Candidates are in the ParametersBinding
+// layout of the inputs. The rows of the classes no conclusion has are not counted. The reasoner is kept by reference
+class CrossEntropyLoss {
+public:
+  CrossEntropyLoss(const fuzzyrulesml::reasoner::SimpleReasoner& reasoner, const fuzzyrulesml::rules::BatchInputs& inputs,
+                   std::span<const std::uint32_t> targets, const std::vector<std::string>& classes);
+
+  // Loss of the candidate, its gradient written to gradient; the rows are split between the threads (0 means all the
+  // hardware threads) and their partial sums reduced in the rows order, so the result is the same for the same threads
+  // count, and differs by the rounding only for another one
+  auto evaluate(std::span<const double> candidate, std::span<double> gradient, std::size_t threads = 1) const -> double;
+
+  // Unordered points break the segments, so the unconstrained optimizers see the points of each variable as its first
+  // point followed by the gaps between the next ones, each gap being min_gap plus the softplus of its parameter
+  [[nodiscard]] auto to_unconstrained(std::span<const double> candidate, double min_gap) const -> std::vector<double>;
+  [[nodiscard]] auto from_unconstrained(std::span<const double> parameters, double min_gap) const -> std::vector<double>;
+  // Loss of the candidate of the unconstrained parameters, the gradient with respect to them written to gradient
+  auto evaluate_unconstrained(std::span<const double> parameters, std::span<double> gradient, double min_gap,
+                              std::size_t threads = 1) const -> double;
+
+  [[nodiscard]] auto size() const -> std::size_t { return offsets.back(); }
+
+private:
+  struct RowsSums {
+    double loss{0.0};
+    std::size_t rows{0};
+    std::vector<double> gradient;
+  };
+  struct Precondition {
+    std::uint32_t column;
+    std::uint32_t term;
+  };
+  void evaluate_rows(std::span<const double> candidate, std::size_t first, std::size_t count, RowsSums& sums) const;
+
+  const fuzzyrulesml::reasoner::SimpleReasoner& reasoner;
+  fuzzyrulesml::rules::BatchInputs inputs;
+  std::span<const std::uint32_t> targets;
+  fuzzyrulesml::reasoner::SimpleReasoner::BatchPlan plan;
+  // Points of each column in the candidate, as ParametersBinding lays them out
+  std::vector<std::size_t> offsets;
+  // Preconditions of each rule from preconditions_offsets[rule], as the batch columns and the terms
+  std::vector<Precondition> preconditions;
+  std::vector<std::size_t> preconditions_offsets;
+  // Conclusion of each class, no_conclusion for the classes no conclusion has
+  std::vector<std::size_t> classes_conclusions;
+};
+} // namespace fuzzyrulesml::training
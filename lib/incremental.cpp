@@ -0,0 +1,154 @@
+#include "incremental.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+namespace fuzzyrulesml::reasoner {
+
+IncrementalEvaluator::IncrementalEvaluator(const SimpleReasoner& reasoner, const fuzzyrulesml::rules::BatchInputs& inputs,
+                                           std::span<const std::uint32_t> targets, const std::vector<std::string>& classes)
+    : reasoner{reasoner}, inputs{inputs}, targets{targets}, conclusions_classes{get_conclusions_classes(reasoner.get_conclusions(), classes)},
+      plan{reasoner.get_batch_plan(inputs)}, scratch{reasoner.make_row_scratch()}, segments(inputs.get_variables().size() * inputs.get_rows()),
+      degrees(segments.size()), sorted_rows(inputs.get_variables().size()), column_values(inputs.get_rows()),
+      column_segments(inputs.get_rows()), column_degrees(inputs.get_rows()),
+      scores(inputs.get_rows() * reasoner.get_conclusions().size()), matches(inputs.get_rows(), false), changed(inputs.get_rows(), false) {
+  if (targets.size() != inputs.get_rows()) {
+    throw std::runtime_error("Targets count differs from the batch rows count");
+  }
+  const auto rows = inputs.get_rows();
+  for (std::size_t column = 0; column < inputs.get_variables().size(); ++column) {
+    points.push_back(inputs.get_variables()[column].get_points());
+    if (plan.uses(column)) {
+      inputs.get_variables()[column].fuzzify(points[column], inputs.get_columns()[column], std::span{segments}.subspan(column * rows, rows),
+                                             std::span{degrees}.subspan(column * rows, rows));
+      const auto values = inputs.get_columns()[column];
+      auto& column_rows = sorted_rows[column];
+      for (std::size_t row = 0; row < rows; ++row) {
+        if (not std::isnan(values[row])) {
+          column_rows.push_back(row);
+        }
+      }
+      std::ranges::sort(column_rows, {}, [values](const auto row) { return values[row]; });
+    }
+  }
+  for (std::size_t row = 0; row < rows; ++row) {
+    rescore_row(row);
+  }
+}
+
+auto IncrementalEvaluator::set_points(std::size_t column, std::span<const double> column_points) -> std::size_t {
+  if (column >= points.size()) {
+    throw std::runtime_error("Column out of the batch");
+  }
+  update_column(column, column_points);
+  return rescore_changed_rows();
+}
+
+auto IncrementalEvaluator::set_parameters(const fuzzyrulesml::rules::ParametersBinding& binding, std::span<const double> candidate)
+    -> std::size_t {
+  if (binding.get_columns_count() != points.size() || candidate.size() != binding.size()) {
+    throw std::runtime_error("Parameters binding does not match the batch");
+  }
+  for (std::size_t column = 0; column < points.size(); ++column) {
+    const auto column_points = binding.get_points(candidate, column);
+    if (not std::ranges::equal(column_points, points[column])) {
+      update_column(column, column_points);
+    }
+  }
+  return rescore_changed_rows();
+}
+
+// Fuzzifies the affected rows of the column with the new points and marks the rows whose segment or degree changed
+void IncrementalEvaluator::update_column(std::size_t column, std::span<const double> column_points) {
+  const auto& variable = inputs.get_variables()[column];
+  const auto rows = inputs.get_rows();
+  if (column_points.size() != points[column].size()) {
+    throw std::runtime_error("Invalid number of characteristic points");
+  }
+  if (not plan.uses(column)) {
+    points[column].assign(column_points.begin(), column_points.end());
+    return;
+  }
+  const auto affected_rows = get_affected_rows(column, column_points);
+  const auto values = inputs.get_columns()[column];
+  for (std::size_t index = 0; index < affected_rows.size(); ++index) {
+    column_values[index] = values[affected_rows[index]];
+  }
+  const auto count = affected_rows.size();
+  variable.fuzzify(column_points, std::span{column_values}.first(count), column_segments, column_degrees);
+  points[column].assign(column_points.begin(), column_points.end());
+  const auto cached_segments = std::span{segments}.subspan(column * rows, rows);
+  const auto cached_degrees = std::span{degrees}.subspan(column * rows, rows);
+  for (std::size_t index = 0; index < count; ++index) {
+    const auto row = affected_rows[index];
+    if (column_segments[index] != cached_segments[row] || column_degrees[index] != cached_degrees[row]) {
+      cached_segments[row] = column_segments[index];
+      cached_degrees[row] = column_degrees[index];
+      if (not changed[row]) {
+        changed[row] = true;
+        changed_rows.push_back(row);
+      }
+    }
+  }
+}
+
+// For sorted points, a value below the left neighbour of the first moved point, or above the right neighbour of the
+// last moved one, keeps its segment and degree: both are given by the points of its segment and by the first and last
+// points. A moved first or last point is its own neighbour, the values beyond it stay on the shoulder. NaN values never
+// change, so they are not among the sorted rows
+auto IncrementalEvaluator::get_affected_rows(std::size_t column, std::span<const double> column_points) const
+    -> std::span<const std::size_t> {
+  const std::span<const std::size_t> column_rows = sorted_rows[column];
+  const auto& old_points = points[column];
+  if (not std::ranges::is_sorted(old_points) || not std::ranges::is_sorted(column_points)) {
+    return column_rows;
+  }
+  const auto mismatch = std::ranges::mismatch(old_points, column_points);
+  if (mismatch.in1 == old_points.end()) {
+    return {};
+  }
+  const auto first_moved = static_cast<std::size_t>(std::distance(old_points.begin(), mismatch.in1));
+  std::size_t last_moved = old_points.size() - 1;
+  while (old_points[last_moved] == column_points[last_moved]) {
+    --last_moved;
+  }
+  const auto lower_point = first_moved == 0 ? 0 : first_moved - 1;
+  const auto upper_point = std::min(last_moved + 1, old_points.size() - 1);
+  const auto lower = std::min(old_points[lower_point], column_points[lower_point]);
+  const auto upper = std::max(old_points[upper_point], column_points[upper_point]);
+  const auto values = inputs.get_columns()[column];
+  const auto value_of = [values](const auto row) { return values[row]; };
+  const auto begin = std::ranges::lower_bound(column_rows, lower, {}, value_of);
+  const auto end = std::ranges::upper_bound(begin, column_rows.end(), upper, {}, value_of);
+  return {begin, end};
+}
+
+auto IncrementalEvaluator::rescore_changed_rows() -> std::size_t {
+  const auto rescored = changed_rows.size();
+  for (const auto row : changed_rows) {
+    rescore_row(row);
+    changed[row] = false;
+  }
+  changed_rows.clear();
+  return rescored;
+}
+
+void IncrementalEvaluator::rescore_row(std::size_t row) {
+  const auto rows = inputs.get_rows();
+  const auto conclusions_count = conclusions_classes.size();
+  const auto row_scores = std::span{scores}.subspan(row * conclusions_count, conclusions_count);
+  std::ranges::fill(row_scores, 0.0);
+  reasoner.score_row(
+      plan, [&](std::size_t variable) { return std::pair{segments[(variable * rows) + row], degrees[(variable * rows) + row]}; },
+      row_scores, scratch);
+  const auto inferred = get_inferred_conclusion(row_scores);
+  const bool matched = inferred != no_inference && targets[row] == conclusions_classes[inferred];
+  if (matched && not matches[row]) {
+    ++matches_count;
+  } else if (not matched && matches[row]) {
+    --matches_count;
+  }
+  matches[row] = matched;
+}
+} // namespace fuzzyrulesml::reasoner
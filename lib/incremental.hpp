@@ -0,0 +1,63 @@
+#pragma once
+
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace fuzzyrulesml::reasoner {
+// IncrementalEvaluator scores a batch for retraining with the rule base fixed and only the characteristic points
+// moving. It caches the fuzzified columns (the segment and degree of each sample and variable) and the scores of the
+// rows; when sorted points of a variable move, only the rows whose values lie between the neighbours of the moved
+// points are fuzzified again, found by bisection of the rows sorted by their values, and only those whose segment or
+// degree changed are rescored, each one in full from the cache. Moving a single point thus costs the rows of the two
+// segments around it; points not sorted, before or after the move, fuzzify the whole column. The reasoner, the inputs
+// columns, the targets and the classes are referred to, so they must outlive the evaluator
+class IncrementalEvaluator {
+public:
+  IncrementalEvaluator(const SimpleReasoner& reasoner, const fuzzyrulesml::rules::BatchInputs& inputs, std::span<const std::uint32_t> targets,
+                       const std::vector<std::string>& classes);
+
+  // Sets the characteristic points of the variable of the column; returns the number of the rescored rows
+  auto set_points(std::size_t column, std::span<const double> points) -> std::size_t;
+  // Sets the points of all the variables from the candidate of the binding layout, see ParametersBinding; the rows
+  // changed by many variables are rescored once
+  auto set_parameters(const fuzzyrulesml::rules::ParametersBinding& binding, std::span<const double> candidate) -> std::size_t;
+
+  [[nodiscard]] auto get_points(std::size_t column) const -> std::span<const double> { return points.at(column); }
+  // Row-major matrix of rows x reasoner.get_conclusions().size(), the same as SimpleReasoner::do_reasoning gives
+  [[nodiscard]] auto get_scores() const -> std::span<const double> { return scores; }
+  // Number of the rows whose best scored conclusion is of the target class, the same as calculate_one gives
+  [[nodiscard]] auto get_goal_function() const -> double { return static_cast<double>(matches_count); }
+
+private:
+  void update_column(std::size_t column, std::span<const double> column_points);
+  // Rows of the column whose fuzzification might change when its points move, as a subrange of its sorted rows
+  [[nodiscard]] auto get_affected_rows(std::size_t column, std::span<const double> column_points) const -> std::span<const std::size_t>;
+  auto rescore_changed_rows() -> std::size_t;
+  void rescore_row(std::size_t row);
+
+  const SimpleReasoner& reasoner;
+  fuzzyrulesml::rules::BatchInputs inputs;
+  std::span<const std::uint32_t> targets;
+  std::vector<std::uint32_t> conclusions_classes;
+  SimpleReasoner::BatchPlan plan;
+  SimpleReasoner::RowScratch scratch;
+  std::vector<std::vector<double>> points;
+  // Column-major caches of the fuzzified inputs, rows values per column
+  std::vector<std::uint32_t> segments;
+  std::vector<double> degrees;
+  // Rows of the columns not having NaN values, ordered by the values; empty for the columns not used by the plan
+  std::vector<std::vector<std::size_t>> sorted_rows;
+  std::vector<double> column_values;
+  std::vector<std::uint32_t> column_segments;
+  std::vector<double> column_degrees;
+  std::vector<double> scores;
+  std::vector<bool> matches;
+  std::size_t matches_count{0};
+  std::vector<bool> changed;
+  std::vector<std::size_t> changed_rows;
+};
+} // namespace fuzzyrulesml::reasoner
@@ -0,0 +1,355 @@
+#include "loader.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+namespace fuzzyrulesml::dataset {
+namespace {
+auto open_file(const std::string& file) -> std::unique_ptr<std::istream> {
+  auto stream = std::make_unique<std::ifstream>(file, std::ifstream::in | std::ifstream::binary);
+  if (not stream->is_open()) {
+    throw std::runtime_error(std::format("Cannot open the file {}", file));
+  }
+  return stream;
+}
+
+auto is_space(int character) -> bool { return character == ' ' || character == '\n' || character == '\r' || character == '\t'; }
+
+auto skip_spaces(InputBuffer& input) -> int {
+  auto character = input.get();
+  while (is_space(character)) {
+    character = input.get();
+  }
+  return character;
+}
+
+// Cuts the next flat record {...} of a JSON array of records out of the input; returns false after the array end
+auto next_record(InputBuffer& input, bool& started, std::string& record) -> bool {
+  auto character = skip_spaces(input);
+  if (not started) {
+    if (character != '[') {
+      throw std::runtime_error("Expected an array of records");
+    }
+    started = true;
+    character = skip_spaces(input);
+  }
+  if (character == ',') {
+    character = skip_spaces(input);
+  }
+  if (character == ']' || character == std::char_traits<char>::eof()) {
+    return false;
+  }
+  if (character != '{') {
+    throw std::runtime_error("Expected a record");
+  }
+  record.assign(1, '{');
+  std::size_t depth = 1;
+  bool in_string = false;
+  bool escaped = false;
+  while (depth > 0) {
+    character = input.get();
+    if (character == std::char_traits<char>::eof()) {
+      throw std::runtime_error("Unexpected end of the records");
+    }
+    record.push_back(static_cast<char>(character));
+    if (in_string) {
+      if (escaped) {
+        escaped = false;
+      } else if (character == '\\') {
+        escaped = true;
+      } else if (character == '"') {
+        in_string = false;
+      }
+    } else if (character == '"') {
+      in_string = true;
+    } else if (character == '{' || character == '[') {
+      ++depth;
+    } else if (character == '}' || character == ']') {
+      --depth;
+    }
+  }
+  return true;
+}
+
+// SAX handler of a single flat record: numbers (null as NaN) and strings are forwarded to the DERIVED handler together
+// with their key, nested values are rejected
+template <typename DERIVED> class FlatRecordSax {
+public:
+  using number_integer_t = nlohmann::json::number_integer_t;
+  using number_unsigned_t = nlohmann::json::number_unsigned_t;
+  using number_float_t = nlohmann::json::number_float_t;
+  using string_t = nlohmann::json::string_t;
+  using binary_t = nlohmann::json::binary_t;
+
+  auto null() -> bool { return derived().on_number(std::numeric_limits<double>::quiet_NaN()); }
+  auto boolean(bool value) -> bool { return derived().on_number(value ? 1.0 : 0.0); }
+  auto number_integer(number_integer_t value) -> bool { return derived().on_number(static_cast<double>(value)); }
+  auto number_unsigned(number_unsigned_t value) -> bool { return derived().on_number(static_cast<double>(value)); }
+  auto number_float(number_float_t value, const string_t& /*unused*/) -> bool { return derived().on_number(value); }
+  auto string(string_t& value) -> bool { return derived().on_string(value); }
+  auto binary(binary_t& /*unused*/) -> bool { throw std::runtime_error("Binary values are not supported"); }
+  auto start_object(std::size_t /*unused*/) -> bool {
+    if (++depth > 1) {
+      throw std::runtime_error("Nested records are not supported");
+    }
+    return true;
+  }
+  auto key(string_t& value) -> bool {
+    current_key = value;
+    return true;
+  }
+  auto end_object() -> bool {
+    --depth;
+    return true;
+  }
+  auto start_array(std::size_t /*unused*/) -> bool { throw std::runtime_error("Arrays in the records are not supported"); }
+  auto end_array() -> bool { return true; }
+  auto parse_error(std::size_t /*unused*/, const std::string& /*unused*/, const nlohmann::detail::exception& error) -> bool {
+    throw std::runtime_error(error.what());
+  }
+
+protected:
+  [[nodiscard]] auto get_key() const -> const std::string& { return current_key; }
+
+private:
+  auto derived() -> DERIVED& { return static_cast<DERIVED&>(*this); }
+  std::size_t depth{0};
+  std::string current_key;
+};
+
+class FeaturesSax : public FlatRecordSax<FeaturesSax> {
+public:
+  FeaturesSax(const ColumnarStore& store, std::vector<double>& row, std::vector<bool>& row_filled)
+      : store{store}, row{row}, row_filled{row_filled} {}
+  auto on_number(double value) -> bool {
+    if (store.get_features_names().empty()) {
+      names.push_back(get_key());
+      row.push_back(value);
+      return true;
+    }
+    const auto feature = store.find_feature(get_key());
+    if (not feature) {
+      throw std::runtime_error(std::format("Unknown feature {} in the record", get_key()));
+    }
+    if (row_filled[*feature]) {
+      throw std::runtime_error(std::format("Duplicated feature {} in the record", get_key()));
+    }
+    row[*feature] = value;
+    row_filled[*feature] = true;
+    return true;
+  }
+  auto on_string(const std::string& /*unused*/) -> bool { throw std::runtime_error("Non-numeric feature value"); }
+  // Names of the features, in the record order, when the store has none
+  [[nodiscard]] auto get_names() const -> const std::vector<std::string>& { return names; }
+
+private:
+  const ColumnarStore& store;
+  std::vector<double>& row;
+  std::vector<bool>& row_filled;
+  std::vector<std::string> names;
+};
+
+class TargetSax : public FlatRecordSax<TargetSax> {
+public:
+  auto on_number(double /*unused*/) -> bool {
+    if (get_key() == "class") {
+      throw std::runtime_error("Non-string class value");
+    }
+    return true;
+  }
+  auto on_string(const std::string& value) -> bool {
+    if (get_key() == "class") {
+      target = value;
+      found = true;
+    }
+    return true;
+  }
+  [[nodiscard]] auto get_target() const -> const std::string& {
+    if (not found) {
+      throw std::runtime_error("Class not found in the target record");
+    }
+    return target;
+  }
+
+private:
+  std::string target;
+  bool found{false};
+};
+
+auto parse_number(std::string_view field) -> double {
+  while (not field.empty() && is_space(field.front())) {
+    field.remove_prefix(1);
+  }
+  while (not field.empty() && is_space(field.back())) {
+    field.remove_suffix(1);
+  }
+  if (field.empty()) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  double value{0.0};
+  const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+  if (error != std::errc{} || end != field.data() + field.size()) {
+    throw std::runtime_error(std::format("Invalid numeric value {}", field));
+  }
+  return value;
+}
+
+// Splits a CSV line into the fields; quoted fields may hold commas and doubled quotes
+void split_fields(const std::string& line, std::vector<std::string>& fields) {
+  fields.clear();
+  fields.emplace_back();
+  bool quoted = false;
+  for (std::size_t i = 0; i < line.size(); ++i) {
+    const auto character = line[i];
+    if (quoted) {
+      if (character == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+        fields.back().push_back('"');
+        ++i;
+      } else if (character == '"') {
+        quoted = false;
+      } else {
+        fields.back().push_back(character);
+      }
+    } else if (character == '"') {
+      quoted = true;
+    } else if (character == ',') {
+      fields.emplace_back();
+    } else {
+      fields.back().push_back(character);
+    }
+  }
+}
+} // namespace
+
+InputBuffer::InputBuffer(std::unique_ptr<std::istream> stream) : stream{std::move(stream)}, buffer(block_size) {
+  if (not this->stream || not *this->stream) {
+    throw std::runtime_error("Invalid input stream");
+  }
+}
+
+auto InputBuffer::refill() -> bool {
+  stream->read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  filled = static_cast<std::size_t>(stream->gcount());
+  position = 0;
+  return filled > 0;
+}
+
+JsonRecordsReader::JsonRecordsReader(const std::string& features_file, const std::string& targets_file)
+    : JsonRecordsReader(open_file(features_file), open_file(targets_file)) {}
+
+JsonRecordsReader::JsonRecordsReader(std::unique_ptr<std::istream> features, std::unique_ptr<std::istream> targets)
+    : features{std::move(features)}, targets{std::move(targets)} {}
+
+auto JsonRecordsReader::read(ColumnarStore& store, std::size_t max_rows) -> std::size_t {
+  std::size_t rows = 0;
+  while (rows < max_rows) {
+    if (not next_record(features, features_started, record)) {
+      if (next_record(targets, targets_started, record)) {
+        throw std::runtime_error("Features and targets of different lengths");
+      }
+      break;
+    }
+    const auto features_count = store.get_features_names().size();
+    row.assign(features_count, 0.0);
+    row_filled.assign(features_count, false);
+    FeaturesSax features_sax{store, row, row_filled};
+    nlohmann::json::sax_parse(record, &features_sax);
+    if (features_count == 0) {
+      store = ColumnarStore{features_sax.get_names()};
+    } else if (std::ranges::find(row_filled, false) != row_filled.end()) {
+      throw std::runtime_error("Missing feature in the record");
+    }
+
+    if (not next_record(targets, targets_started, record)) {
+      throw std::runtime_error("Features and targets of different lengths");
+    }
+    TargetSax target_sax;
+    nlohmann::json::sax_parse(record, &target_sax);
+    store.add_row(row, store.intern_class(target_sax.get_target()));
+    ++rows;
+  }
+  return rows;
+}
+
+CsvRecordsReader::CsvRecordsReader(const std::string& file, std::string target_column)
+    : CsvRecordsReader(open_file(file), std::move(target_column)) {}
+
+CsvRecordsReader::CsvRecordsReader(std::unique_ptr<std::istream> input, std::string target_column)
+    : input{std::move(input)}, target_column{std::move(target_column)} {}
+
+auto CsvRecordsReader::read_line() -> bool {
+  do {
+    line.clear();
+    auto character = input.get();
+    if (character == std::char_traits<char>::eof()) {
+      return false;
+    }
+    while (character != '\n' && character != std::char_traits<char>::eof()) {
+      line.push_back(static_cast<char>(character));
+      character = input.get();
+    }
+    if (not line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+  } while (line.empty());
+  return true;
+}
+
+auto CsvRecordsReader::read(ColumnarStore& store, std::size_t max_rows) -> std::size_t {
+  if (header.empty()) {
+    if (not read_line()) {
+      throw std::runtime_error("Missing header of the CSV file");
+    }
+    split_fields(line, header);
+    const auto target = std::ranges::find(header, target_column);
+    if (target == header.end()) {
+      throw std::runtime_error(std::format("Target column {} not found", target_column));
+    }
+    target_index = static_cast<std::size_t>(std::distance(header.begin(), target));
+    features_names = header;
+    features_names.erase(std::next(features_names.begin(), static_cast<std::ptrdiff_t>(target_index)));
+  }
+  if (store.get_features_names().empty()) {
+    store = ColumnarStore{features_names};
+  } else if (store.get_features_names() != features_names) {
+    throw std::runtime_error("Features of the CSV file differ from the store ones");
+  }
+
+  std::size_t rows = 0;
+  while (rows < max_rows && read_line()) {
+    split_fields(line, fields);
+    if (fields.size() != header.size()) {
+      throw std::runtime_error("Invalid number of fields in the CSV line");
+    }
+    row.clear();
+    for (std::size_t field = 0; field < fields.size(); ++field) {
+      if (field != target_index) {
+        row.push_back(parse_number(fields[field]));
+      }
+    }
+    store.add_row(row, store.intern_class(fields[target_index]));
+    ++rows;
+  }
+  return rows;
+}
+
+auto load_columnar(const std::string& features_file, const std::string& targets_file) -> ColumnarStore {
+  JsonRecordsReader reader{features_file, targets_file};
+  ColumnarStore store;
+  static_cast<void>(reader.read(store, std::numeric_limits<std::size_t>::max()));
+  return store;
+}
+
+auto load_columnar_csv(const std::string& file, const std::string& target_column) -> ColumnarStore {
+  CsvRecordsReader reader{file, target_column};
+  ColumnarStore store;
+  static_cast<void>(reader.read(store, std::numeric_limits<std::size_t>::max()));
+  return store;
+}
+} // namespace fuzzyrulesml::dataset
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "columnar.hpp"
+#include <istream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fuzzyrulesml::dataset {
+// InputBuffer reads a stream in fixed size blocks, so the readers below keep at most a block and a record in memory
+class InputBuffer {
+public:
+  explicit InputBuffer(std::unique_ptr<std::istream> stream);
+  // Next character of the stream or std::char_traits<char>::eof()
+  [[nodiscard]] auto get() -> int {
+    if (position == filled && not refill()) {
+      return std::char_traits<char>::eof();
+    }
+    return static_cast<unsigned char>(buffer[position++]);
+  }
+  [[nodiscard]] auto peek() -> int {
+    if (position == filled && not refill()) {
+      return std::char_traits<char>::eof();
+    }
+    return static_cast<unsigned char>(buffer[position]);
+  }
+
+private:
+  static constexpr std::size_t block_size = 1 << 16;
+  auto refill() -> bool;
+
+  std::unique_ptr<std::istream> stream;
+  std::vector<char> buffer;
+  std::size_t position{0};
+  std::size_t filled{0};
+};
+
+// JsonRecordsReader streams the features and targets files of the iris layout: arrays of flat records, e.g.
+// [{"sepal length": 5.1, ...}, ...] and [{"class": "Iris-setosa"}, ...]. Each record is cut out of the stream and
+// parsed with the nlohmann SAX interface straight into the columnar store, without building a JSON document
+class JsonRecordsReader {
+public:
+  JsonRecordsReader(const std::string& features_file, const std::string& targets_file);
+  JsonRecordsReader(std::unique_ptr<std::istream> features, std::unique_ptr<std::istream> targets);
+  // Appends up to max_rows rows to the store and returns their number, 0 at the end of the files. When the store has
+  // no features yet, the keys of the first record define them
+  auto read(ColumnarStore& store, std::size_t max_rows) -> std::size_t;
+
+private:
+  InputBuffer features;
+  InputBuffer targets;
+  bool features_started{false};
+  bool targets_started{false};
+  std::string record;
+  std::vector<double> row;
+  std::vector<bool> row_filled;
+};
+
+// CsvRecordsReader streams a comma separated file with a header line; the target_column holds the classes, all the
+// other columns are numeric features
+class CsvRecordsReader {
+public:
+  explicit CsvRecordsReader(const std::string& file, std::string target_column = "class");
+  CsvRecordsReader(std::unique_ptr<std::istream> input, std::string target_column = "class");
+  // See JsonRecordsReader::read; the header defines the features of a store without them
+  auto read(ColumnarStore& store, std::size_t max_rows) -> std::size_t;
+
+private:
+  auto read_line() -> bool;
+
+  InputBuffer input;
+  std::string target_column;
+  std::vector<std::string> header;
+  std::vector<std::string> features_names;
+  std::size_t target_index{0};
+  std::string line;
+  std::vector<std::string> fields;
+  std::vector<double> row;
+};
+
+// Reads all the rows in chunks of chunk_rows and calls function(const ColumnarStore&) for each chunk, so the memory
+// stays bounded by a chunk and the processing starts before the files are read entirely; class ids are kept across
+// the chunks
+template <typename READER, typename FUNCTION> void for_each_chunk(READER& reader, std::size_t chunk_rows, FUNCTION&& function) {
+  ColumnarStore chunk;
+  while (reader.read(chunk, chunk_rows) > 0) {
+    function(std::as_const(chunk));
+    chunk.clear_rows();
+  }
+}
+
+// Loads the whole files into a columnar store: the features and targets JSON files of the iris layout, or a CSV file
+[[nodiscard]] auto load_columnar(const std::string& features_file, const std::string& targets_file) -> ColumnarStore;
+[[nodiscard]] auto load_columnar_csv(const std::string& file, const std::string& target_column = "class") -> ColumnarStore;
+} // namespace fuzzyrulesml::dataset
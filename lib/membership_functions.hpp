@@ -1,30 +1,57 @@
 #pragma once
 
-#include <map>
-#include <numeric>
+#include "fuzzify_kernels.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <iterator>
 #include <optional>
+#include <ranges>
+#include <span>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace fuzzyrulesml {
+// Membership stores the non-zero membership degrees of a crisp value, sorted by the membership function index. For
+// piecewise linear partitions at most two neighbouring functions fire, so the storage is fixed and never allocates
 class Membership {
 public:
+  using Entry = std::pair<std::size_t, double>;
+  static constexpr std::size_t capacity = 2;
+
   [[nodiscard]] auto begin() const { return memberships.begin(); };
-  [[nodiscard]] auto end() const { return memberships.end(); }
-  [[nodiscard]] auto operator[](std::size_t index) -> double& { return memberships[index]; }
-  [[nodiscard]] auto size() const -> std::size_t { return memberships.size(); }
+  [[nodiscard]] auto end() const { return std::next(memberships.begin(), static_cast<std::ptrdiff_t>(count)); }
+  [[nodiscard]] auto operator[](std::size_t index) -> double& {
+    const auto used_end = std::next(memberships.begin(), static_cast<std::ptrdiff_t>(count));
+    const auto position = std::find_if(memberships.begin(), used_end, [index](const auto& entry) { return entry.first >= index; });
+    if (position != used_end && position->first == index) {
+      return position->second;
+    }
+    if (count == capacity) {
+      throw std::runtime_error("Membership capacity exceeded");
+    }
+    std::move_backward(position, used_end, std::next(used_end));
+    ++count;
+    *position = Entry{index, 0.0};
+    return position->second;
+  }
+  [[nodiscard]] auto size() const -> std::size_t { return count; }
   [[nodiscard]] auto get_membership(std::size_t index) const -> double {
-    auto found = memberships.find(index);
-    if (found != memberships.end()) {
+    const auto found = std::find_if(begin(), end(), [index](const auto& entry) { return entry.first == index; });
+    if (found != end()) {
       return found->second;
     }
     return 0.0;
   }
 
-  [[nodiscard]] auto get_memberships() const -> std::map<std::size_t, double> { return memberships; }
+  [[nodiscard]] auto get_memberships() const -> std::span<const Entry> { return {memberships.data(), count}; }
 
 private:
-  std::map<std::size_t, double> memberships;
+  std::array<Entry, capacity> memberships{};
+  std::size_t count{0};
 };
 } // namespace fuzzyrulesml
 namespace fuzzyrulesml::mfunct {
@@ -80,6 +107,8 @@ public:
     }
     return (value - left_bound) / (right_bound - left_bound);
   }
+  [[nodiscard]] auto get_left_bound() const -> VARIABLE { return left_bound; }
+  [[nodiscard]] auto get_right_bound() const -> VARIABLE { return right_bound; }
   [[nodiscard]] auto get_points() const -> std::vector<VARIABLE> { return {left_bound, right_bound}; }
   void set_points(const VARIABLE left_bound, const VARIABLE right_bound) {
     this->left_bound = left_bound;
@@ -106,6 +135,8 @@ public:
     return (right_bound - value) / (right_bound - left_bound);
   }
 
+  [[nodiscard]] auto get_left_bound() const -> VARIABLE { return left_bound; }
+  [[nodiscard]] auto get_right_bound() const -> VARIABLE { return right_bound; }
   [[nodiscard]] auto get_points() const -> std::vector<VARIABLE> { return {left_bound, right_bound}; }
   void set_points(const double left_bound, const double right_bound) {
     this->left_bound = left_bound;
@@ -117,68 +148,104 @@ private:
   VARIABLE right_bound;
 };
 
+// LinearDistribution is a partition of the variable range into triangular functions with shoulders at both ends. It is
+// stored as the array of characteristic points (the left bound, the peaks of the mid functions and the right bound), so
+// a crisp value fires only the two functions of the segment containing it. The segment is found by a direct index for
+// uniformly spaced points and by bisection otherwise
 template <typename VARIABLE> class LinearDistribution {
 public:
   LinearDistribution(const LinearMemberFunctDesc<VARIABLE>& lfunction, const std::vector<LinearMemberFunct<VARIABLE>>& functions,
                      const LinearMemberFunctAsc<VARIABLE>& rfunction)
-      : left_function{lfunction}, mid_functions(functions), right_function{rfunction} {}
+      : LinearDistribution(make_points(lfunction, functions, rfunction)) {}
+  explicit LinearDistribution(std::vector<VARIABLE> characteristic_points) : points(std::move(characteristic_points)) {
+    if (points.size() < 2) {
+      throw std::runtime_error("Invalid number of characteristic points");
+    }
+    update_uniform_step();
+  }
 
   [[nodiscard]] auto operator()(VARIABLE value) const -> Membership {
     Membership memberships;
-    const auto left_boundary = left_function.get_points()[0];
-    if (value < left_boundary) {
+    // A NaN value, e.g. a missing feature, fails all the comparisons with the points and fires no function
+    if constexpr (std::floating_point<VARIABLE>) {
+      if (std::isnan(value)) {
+        return memberships;
+      }
+    }
+    if (value < points.front()) {
       memberships[0] = 1.0;
       return memberships;
     }
-    const auto& left_function_value = left_function(value);
-    if (left_function_value.has_value()) {
-      memberships[0] = left_function_value.value();
-    }
-    int index = 1;
-    memberships = std::accumulate(mid_functions.begin(), mid_functions.end(), memberships,
-                                  [&value, &index](Membership memberships, const LinearMemberFunct<VARIABLE>& function) {
-                                    if (function(value)) {
-                                      memberships[index++] = function(value).value();
-                                    } else {
-                                      ++index;
-                                    }
-                                    return memberships;
-                                  });
-    const auto& right_function_value = right_function(value);
-    if (right_function_value.has_value()) {
-      memberships[mid_functions.size() + 1] = right_function_value.value();
-    }
-    const auto right_boundary = right_function.get_points()[1];
-    if (value >= right_boundary) {
-      memberships[mid_functions.size() + 1] = 1.0;
+    if (value >= points.back()) {
+      memberships[points.size() - 1] = 1.0;
+      return memberships;
+    }
+    const auto segment = find_segment(value);
+    const auto segment_begin = static_cast<double>(points[segment]);
+    const auto segment_end = static_cast<double>(points[segment + 1]);
+    const auto crisp_value = static_cast<double>(value);
+    memberships[segment] = (segment_end - crisp_value) / (segment_end - segment_begin);
+    if (crisp_value > segment_begin) {
+      memberships[segment + 1] = (crisp_value - segment_begin) / (segment_end - segment_begin);
     }
     return memberships;
   };
-  [[nodiscard]] auto get_categories() const -> std::size_t { return mid_functions.size() + 2; }
+  // Fuzzification of a whole column of crisp values into segments and degrees, see fuzzify_column
+  void fuzzify(std::span<const double> values, std::span<std::uint32_t> segments, std::span<double> degrees) const
+    requires std::same_as<VARIABLE, double>
+  {
+    fuzzify_column(points, values, segments, degrees);
+  }
+  [[nodiscard]] auto get_categories() const -> std::size_t { return points.size(); }
   void set_points(const std::vector<double>& characteristic_points) {
-    if (characteristic_points.size() != mid_functions.size() + 2) {
+    if (characteristic_points.size() != points.size()) {
       throw std::runtime_error("Invalid number of characteristic points");
     }
-    left_function.set_points(characteristic_points[0], characteristic_points[1]);
-    for (std::size_t i = 0; i < mid_functions.size(); ++i) {
-      mid_functions[i].set_points(characteristic_points[i], characteristic_points[i + 1], characteristic_points[i + 2]);
-    }
-    right_function.set_points(characteristic_points[characteristic_points.size() - 2], characteristic_points.back());
+    std::ranges::transform(characteristic_points, points.begin(), [](const double point) { return static_cast<VARIABLE>(point); });
+    update_uniform_step();
   }
 
   [[nodiscard]] auto get_points() const -> std::vector<double> {
-    std::vector<double> points;
-    points.push_back(left_function.get_points()[0]);
-    for (const auto& function : mid_functions) {
-      points.push_back(function.get_peak());
-    }
-    points.push_back(right_function.get_points()[1]);
-    return points;
+    return points | std::views::transform([](const VARIABLE point) { return static_cast<double>(point); }) |
+           std::ranges::to<std::vector<double>>();
   }
 
 private:
-  LinearMemberFunctDesc<VARIABLE> left_function;
-  std::vector<LinearMemberFunct<VARIABLE>> mid_functions;
-  LinearMemberFunctAsc<VARIABLE> right_function;
+  static auto make_points(const LinearMemberFunctDesc<VARIABLE>& lfunction, const std::vector<LinearMemberFunct<VARIABLE>>& functions,
+                          const LinearMemberFunctAsc<VARIABLE>& rfunction) -> std::vector<VARIABLE> {
+    std::vector<VARIABLE> characteristic_points{lfunction.get_left_bound()};
+    for (const auto& function : functions) {
+      characteristic_points.push_back(function.get_peak());
+    }
+    characteristic_points.push_back(rfunction.get_right_bound());
+    return characteristic_points;
+  }
+
+  // Precondition: points.front() <= value < points.back(), so value is not NaN. The returned segment satisfies
+  // points[segment] <= value < points[segment + 1], also for not sorted points set by an optimizer
+  [[nodiscard]] auto find_segment(VARIABLE value) const -> std::size_t {
+    if (uniform_step > 0.0) {
+      const auto guess = static_cast<std::size_t>((static_cast<double>(value) - static_cast<double>(points.front())) / uniform_step);
+      const auto segment = std::min(guess, points.size() - 2);
+      if (points[segment] <= value && value < points[segment + 1]) {
+        return segment;
+      }
+    }
+    return bisect_points(std::span<const VARIABLE>{points}, value);
+  }
+
+  // Uniform step is positive only when all the points are equally spaced (up to the rounding errors)
+  void update_uniform_step() {
+    const auto first = static_cast<double>(points.front());
+    const auto step = (static_cast<double>(points.back()) - first) / static_cast<double>(points.size() - 1);
+    const auto tolerance = 1e-9 * std::abs(step);
+    const auto is_uniform = step > 0.0 && std::ranges::all_of(std::views::iota(std::size_t{0}, points.size()), [&](const auto index) {
+                              return std::abs(static_cast<double>(points[index]) - (first + (static_cast<double>(index) * step))) <= tolerance;
+                            });
+    uniform_step = is_uniform ? step : 0.0;
+  }
+
+  std::vector<VARIABLE> points;
+  double uniform_step{0.0};
 };
 }; // namespace fuzzyrulesml::mfunct
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "minibatch.hpp"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace fuzzyrulesml::training {
+StratifiedBatches::StratifiedBatches(const fuzzyrulesml::rules::BatchInputs& inputs, std::span<const std::uint32_t> targets,
+                                     std::size_t batch_rows, std::uint64_t seed)
+    : source_columns{inputs.get_columns()}, source_targets{targets}, seed{seed} {
+  const auto dataset_rows = inputs.get_rows();
+  if (targets.size() != dataset_rows) {
+    throw std::runtime_error("Targets count differs from the batch rows count");
+  }
+  if (batch_rows == 0 || dataset_rows == 0) {
+    throw std::runtime_error("Mini-batch of no rows");
+  }
+  batch_rows = std::min(batch_rows, dataset_rows);
+  for (std::size_t row = 0; row < dataset_rows; ++row) {
+    if (targets[row] >= class_rows.size()) {
+      class_rows.resize(targets[row] + 1);
+    }
+    class_rows[targets[row]].push_back(row);
+  }
+  // Shares of the classes by the largest remainders of batch_rows * class rows / dataset rows, so they sum up to
+  // batch_rows and no class is off by more than a row from its proportion
+  quotas.resize(class_rows.size());
+  std::vector<std::size_t> remainders(class_rows.size());
+  std::size_t assigned = 0;
+  for (std::size_t class_id = 0; class_id < class_rows.size(); ++class_id) {
+    const auto share = batch_rows * class_rows[class_id].size();
+    quotas[class_id] = share / dataset_rows;
+    remainders[class_id] = share % dataset_rows;
+    assigned += quotas[class_id];
+  }
+  std::vector<std::size_t> by_remainder(class_rows.size());
+  std::iota(by_remainder.begin(), by_remainder.end(), 0);
+  std::ranges::stable_sort(by_remainder, std::ranges::greater{}, [&remainders](std::size_t class_id) { return remainders[class_id]; });
+  for (std::size_t index = 0; assigned < batch_rows; ++index, ++assigned) {
+    ++quotas[by_remainder[index]];
+  }
+  swaps.reserve(std::ranges::max(quotas));
+
+  rows.resize(batch_rows);
+  this->targets.resize(batch_rows);
+  columns.resize(source_columns.size());
+  for (std::size_t column = 0; column < columns.size(); ++column) {
+    columns[column].resize(batch_rows);
+    this->inputs.add_column(inputs.get_variables()[column], columns[column]);
+  }
+  resample(0);
+}
+
+void StratifiedBatches::resample(std::size_t generation) {
+  std::seed_seq seeds{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32U), static_cast<std::uint32_t>(generation),
+                      static_cast<std::uint32_t>(static_cast<std::uint64_t>(generation) >> 32U)};
+  std::mt19937_64 generator{seeds};
+  // Partial Fisher-Yates shuffle of the rows of each class, undone after taking its first rows, so a draw does not
+  // depend on the previous ones
+  auto batch_row = rows.begin();
+  for (std::size_t class_id = 0; class_id < class_rows.size(); ++class_id) {
+    auto& candidates = class_rows[class_id];
+    swaps.clear();
+    for (std::size_t index = 0; index < quotas[class_id]; ++index) {
+      const auto chosen = std::uniform_int_distribution<std::size_t>{index, candidates.size() - 1}(generator);
+      std::swap(candidates[index], candidates[chosen]);
+      swaps.push_back(chosen);
+      *batch_row++ = candidates[index];
+    }
+    for (auto index = swaps.size(); index-- > 0;) {
+      std::swap(candidates[index], candidates[swaps[index]]);
+    }
+  }
+  // Gathered in the dataset order, which keeps the reads of the columns forward
+  std::ranges::sort(rows);
+  for (std::size_t column = 0; column < columns.size(); ++column) {
+    const auto source = source_columns[column];
+    std::ranges::transform(rows, columns[column].begin(), [source](std::size_t row) { return source[row]; });
+  }
+  std::ranges::transform(rows, targets.begin(), [this](std::size_t row) { return source_targets[row]; });
+}
+} // namespace fuzzyrulesml::training
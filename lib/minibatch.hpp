@@ -0,0 +1,48 @@
+#pragma once
+
+#include "rules.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace fuzzyrulesml::training {
+// StratifiedBatches draws mini-batches of the rows of a batch for the training objective: each class gets its share of
+// the batch rows by the classes counts (largest remainders), drawn without replacement within the class. The drawn rows
+// are gathered into owned columns, in the dataset order, so the objective scores them as any batch; drawing costs the
+// batch rows, not the dataset ones. A batch depends only on the seed and the generation, so a resumed training draws
+// the same batches
+class StratifiedBatches {
+public:
+  // batch_rows of more than the rows of the inputs takes all of them; draws the batch of generation 0
+  StratifiedBatches(const fuzzyrulesml::rules::BatchInputs& inputs, std::span<const std::uint32_t> targets, std::size_t batch_rows,
+                    std::uint64_t seed);
+  // The batch inputs refer to the owned columns, which a copy would not
+  StratifiedBatches(const StratifiedBatches&) = delete;
+  auto operator=(const StratifiedBatches&) -> StratifiedBatches& = delete;
+  StratifiedBatches(StratifiedBatches&&) = default;
+  auto operator=(StratifiedBatches&&) -> StratifiedBatches& = default;
+  ~StratifiedBatches() = default;
+
+  // Draws the batch of the generation into the columns, the batch inputs staying valid
+  void resample(std::size_t generation);
+
+  [[nodiscard]] auto get_inputs() const -> const fuzzyrulesml::rules::BatchInputs& { return inputs; }
+  [[nodiscard]] auto get_targets() const -> std::span<const std::uint32_t> { return targets; }
+  // Rows of the batch in the dataset, ascending
+  [[nodiscard]] auto get_rows() const -> std::span<const std::size_t> { return rows; }
+
+private:
+  std::vector<std::span<const double>> source_columns;
+  std::span<const std::uint32_t> source_targets;
+  // Dataset rows of each class, shuffled in part while drawing and restored after it
+  std::vector<std::vector<std::size_t>> class_rows;
+  std::vector<std::size_t> quotas;
+  // Positions swapped by the draw of a class, undone in the reverse order
+  std::vector<std::size_t> swaps;
+  std::uint64_t seed;
+  std::vector<std::size_t> rows;
+  std::vector<std::vector<double>> columns;
+  std::vector<std::uint32_t> targets;
+  fuzzyrulesml::rules::BatchInputs inputs;
+};
+} // namespace fuzzyrulesml::training
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <span>
+
+namespace fuzzyrulesml::reasoner {
+// Operators of the reasoning, given as policy types of the reasoners, so they are inlined without a call per rule. A
+// t-norm combines the degrees of the rule preconditions into the rule strength, starting from its identity; an
+// aggregation combines the strengths of the rules of the same conclusion into its score, starting from 0.0, which is
+// the identity of all the aggregations for the strengths within [0, 1]. Both operate on single values and on batches
+// of rules; the t-norms are branch-free, so their batch loops are vectorized by the compiler
+template <typename T>
+concept TNorm = requires(double value, std::span<double> strengths) {
+  { T::identity } -> std::convertible_to<double>;
+  { T::apply(value, value) } -> std::same_as<double>;
+  T::apply(strengths, value);
+};
+
+template <typename T>
+concept Aggregation = requires(double value, std::span<double> scores, std::span<const std::size_t> conclusions,
+                               std::span<const double> strengths) {
+  { T::combine(value, value) } -> std::same_as<double>;
+  T::combine(scores, conclusions, strengths);
+};
+
+// The t-norms apply the same degree to a batch of rule strengths
+template <typename OPERATION> struct TNormOf {
+  static constexpr double identity = 1.0;
+  [[nodiscard]] static constexpr auto apply(double strength, double degree) -> double { return OPERATION{}(strength, degree); }
+  static constexpr void apply(std::span<double> strengths, double degree) {
+    for (auto& strength : strengths) {
+      strength = OPERATION{}(strength, degree);
+    }
+  }
+};
+
+struct ProductOperation {
+  constexpr auto operator()(double strength, double degree) const -> double { return strength * degree; }
+};
+struct MinOperation {
+  constexpr auto operator()(double strength, double degree) const -> double { return std::min(strength, degree); }
+};
+struct LukasiewiczOperation {
+  constexpr auto operator()(double strength, double degree) const -> double { return std::max(0.0, strength + degree - 1.0); }
+};
+
+using ProductTNorm = TNormOf<ProductOperation>;
+using MinTNorm = TNormOf<MinOperation>;
+using LukasiewiczTNorm = TNormOf<LukasiewiczOperation>;
+
+// The aggregations scatter a batch of rule strengths into the scores of their conclusions
+template <typename OPERATION> struct AggregationOf {
+  [[nodiscard]] static constexpr auto combine(double score, double strength) -> double { return OPERATION{}(score, strength); }
+  static constexpr void combine(std::span<double> scores, std::span<const std::size_t> conclusions, std::span<const double> strengths) {
+    for (std::size_t rule = 0; rule < strengths.size(); ++rule) {
+      scores[conclusions[rule]] = OPERATION{}(scores[conclusions[rule]], strengths[rule]);
+    }
+  }
+};
+
+struct SumOperation {
+  constexpr auto operator()(double score, double strength) const -> double { return score + strength; }
+};
+struct MaxOperation {
+  constexpr auto operator()(double score, double strength) const -> double { return std::max(score, strength); }
+};
+struct ProbabilisticOrOperation {
+  constexpr auto operator()(double score, double strength) const -> double { return score + strength - (score * strength); }
+};
+
+using SumAggregation = AggregationOf<SumOperation>;
+using MaxAggregation = AggregationOf<MaxOperation>;
+using ProbabilisticOrAggregation = AggregationOf<ProbabilisticOrOperation>;
+} // namespace fuzzyrulesml::reasoner
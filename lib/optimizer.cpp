@@ -0,0 +1,169 @@
+#include "optimizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace fuzzyrulesml::training {
+namespace {
+// Decay rates of the Adam moments and the guard of its denominator, as Kingma and Ba suggest
+constexpr double adam_first_decay = 0.9;
+constexpr double adam_second_decay = 0.999;
+constexpr double adam_epsilon = 1e-8;
+// Sufficient decrease (Armijo) condition of the L-BFGS line search, and the step shrinking of each of its trials
+constexpr double armijo_factor = 1e-4;
+constexpr double backtracking_factor = 0.5;
+constexpr std::size_t backtracking_trials = 40;
+
+auto dot(std::span<const double> left, std::span<const double> right) -> double {
+  return std::inner_product(left.begin(), left.end(), right.begin(), 0.0);
+}
+
+auto norm(std::span<const double> values) -> double { return std::sqrt(dot(values, values)); }
+
+// Objective counting its evaluations and keeping the best parameters evaluated
+class TrackedObjective {
+public:
+  TrackedObjective(const DifferentiableObjective& objective, const Parameters& start) : objective{objective} {
+    state.best_parameters = start;
+  }
+
+  auto operator()(std::span<const double> parameters, std::span<double> gradient) -> double {
+    const auto value = objective(parameters, gradient);
+    ++state.evaluations;
+    if (value < state.best_value) {
+      state.best_value = value;
+      std::ranges::copy(parameters, state.best_parameters.begin());
+    }
+    return value;
+  }
+  [[nodiscard]] auto get_state() -> TrainingState& { return state; }
+
+private:
+  const DifferentiableObjective& objective;
+  TrainingState state;
+};
+
+auto run_adam(Parameters parameters, TrackedObjective& objective, const GradientSettings& settings) -> bool {
+  Parameters gradient(parameters.size());
+  Parameters first_moment(parameters.size(), 0.0);
+  Parameters second_moment(parameters.size(), 0.0);
+  double first_decay_power = 1.0;
+  double second_decay_power = 1.0;
+  static_cast<void>(objective(parameters, gradient));
+  for (std::size_t iteration = 1; iteration <= settings.iterations && not(norm(gradient) <= settings.gradient_tolerance); ++iteration) {
+    first_decay_power *= adam_first_decay;
+    second_decay_power *= adam_second_decay;
+    for (std::size_t index = 0; index < parameters.size(); ++index) {
+      first_moment[index] = (adam_first_decay * first_moment[index]) + ((1.0 - adam_first_decay) * gradient[index]);
+      second_moment[index] = (adam_second_decay * second_moment[index]) + ((1.0 - adam_second_decay) * gradient[index] * gradient[index]);
+      // The moments start at zero, so they are corrected by the weight of their decayed start
+      const auto first_corrected = first_moment[index] / (1.0 - first_decay_power);
+      const auto second_corrected = second_moment[index] / (1.0 - second_decay_power);
+      parameters[index] -= settings.learning_rate * first_corrected / (std::sqrt(second_corrected) + adam_epsilon);
+    }
+    static_cast<void>(objective(parameters, gradient));
+    objective.get_state().generation = iteration;
+  }
+  return norm(gradient) <= settings.gradient_tolerance;
+}
+
+// Each iteration moves along the direction of the two-loop recursion over the last corrections (the steps and the
+// changes of the gradient), so the inverse Hessian is never formed; the corrections of a negative curvature are
+// skipped, and the direction falls back to the steepest descent when it does not descend
+auto run_lbfgs(Parameters parameters, TrackedObjective& objective, const GradientSettings& settings) -> bool {
+  const auto size = parameters.size();
+  Parameters gradient(size);
+  Parameters direction(size);
+  Parameters trial(size);
+  Parameters trial_gradient(size);
+  std::deque<Parameters> steps;
+  std::deque<Parameters> changes;
+  std::deque<double> curvatures;
+  std::vector<double> alphas;
+  auto value = objective(parameters, gradient);
+  for (std::size_t iteration = 1; iteration <= settings.iterations && not(norm(gradient) <= settings.gradient_tolerance); ++iteration) {
+    std::ranges::copy(gradient, direction.begin());
+    alphas.resize(steps.size());
+    for (auto correction = steps.size(); correction-- > 0;) {
+      alphas[correction] = dot(steps[correction], direction) / curvatures[correction];
+      for (std::size_t index = 0; index < size; ++index) {
+        direction[index] -= alphas[correction] * changes[correction][index];
+      }
+    }
+    if (not steps.empty()) {
+      const auto scale = curvatures.back() / dot(changes.back(), changes.back());
+      std::ranges::transform(direction, direction.begin(), [scale](double component) { return component * scale; });
+    }
+    for (std::size_t correction = 0; correction < steps.size(); ++correction) {
+      const auto beta = dot(changes[correction], direction) / curvatures[correction];
+      for (std::size_t index = 0; index < size; ++index) {
+        direction[index] += (alphas[correction] - beta) * steps[correction][index];
+      }
+    }
+    std::ranges::transform(direction, direction.begin(), std::negate{});
+    auto slope = dot(gradient, direction);
+    if (not(slope < 0.0)) {
+      steps.clear();
+      changes.clear();
+      curvatures.clear();
+      std::ranges::transform(gradient, direction.begin(), std::negate{});
+      slope = -dot(gradient, gradient);
+    }
+
+    // Without corrections the direction is the gradient, so the first trial moves the parameters by a unit distance
+    auto step = steps.empty() ? std::min(1.0, 1.0 / norm(gradient)) : 1.0;
+    auto trial_value = value;
+    bool decreased = false;
+    for (std::size_t trial_count = 0; trial_count < backtracking_trials && not decreased; ++trial_count) {
+      for (std::size_t index = 0; index < size; ++index) {
+        trial[index] = parameters[index] + (step * direction[index]);
+      }
+      trial_value = objective(trial, trial_gradient);
+      decreased = trial_value <= value + (armijo_factor * step * slope);
+      if (not decreased) {
+        step *= backtracking_factor;
+      }
+    }
+    if (not decreased) {
+      return false;
+    }
+
+    Parameters step_taken(size);
+    Parameters change(size);
+    for (std::size_t index = 0; index < size; ++index) {
+      step_taken[index] = trial[index] - parameters[index];
+      change[index] = trial_gradient[index] - gradient[index];
+    }
+    const auto curvature = dot(step_taken, change);
+    if (curvature > 0.0) {
+      steps.push_back(std::move(step_taken));
+      changes.push_back(std::move(change));
+      curvatures.push_back(curvature);
+      if (steps.size() > settings.history) {
+        steps.pop_front();
+        changes.pop_front();
+        curvatures.pop_front();
+      }
+    }
+    std::swap(parameters, trial);
+    std::swap(gradient, trial_gradient);
+    value = trial_value;
+    objective.get_state().generation = iteration;
+  }
+  return norm(gradient) <= settings.gradient_tolerance;
+}
+} // namespace
+
+auto minimize_gradient(const Parameters& start, const DifferentiableObjective& objective, const GradientSettings& settings)
+    -> GradientResult {
+  TrackedObjective tracked{objective, start};
+  const auto converged =
+      settings.method == GradientMethod::adam ? run_adam(start, tracked, settings) : run_lbfgs(start, tracked, settings);
+  return {.state = std::move(tracked.get_state()), .converged = converged};
+}
+} // namespace fuzzyrulesml::training
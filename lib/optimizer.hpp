@@ -1,12 +1,33 @@
-#define OPTIM_ENABLE_EIGEN_WRAPPERS
-#include "optim/optim.hpp"
+#pragma once
 
-inline auto ackley_fn(const Eigen::VectorXd& vals_inp, Eigen::VectorXd * /*unused*/, void * /*unused*/) -> double {
-  const double x_value = vals_inp(0);
-  const double y_value = vals_inp(1);
+#include "training.hpp"
+#include <cstddef>
 
-  const double obj_val = 20 + std::numbers::e - 20 * std::exp(-0.2 * std::sqrt(0.5 * (x_value * x_value + y_value * y_value))) -
-                         std::exp(0.5 * (std::cos(2 * std::numbers::pi * x_value) + std::cos(2 * std::numbers::pi * y_value)));
+namespace fuzzyrulesml::training {
+// Methods of minimize_gradient for the differentiable objectives
+enum class GradientMethod { adam, lbfgs };
 
-  return obj_val;
-}
\ No newline at end of file
+struct GradientSettings {
+  GradientMethod method{GradientMethod::adam};
+  std::size_t iterations{200};
+  // Step size of Adam
+  double learning_rate{0.05};
+  // The method converges once the Euclidean norm of the gradient is not above it
+  double gradient_tolerance{1e-6};
+  // Corrections of the last iterations kept by L-BFGS
+  std::size_t history{10};
+};
+
+struct GradientResult {
+  TrainingState state;
+  // Whether the gradient tolerance was met: false when the iterations ran out before, or when the line search of
+  // L-BFGS found no decrease along its direction; the state then has the best parameters evaluated so far
+  bool converged{false};
+};
+
+// Minimizes the differentiable objective from the start parameters by Adam or by L-BFGS with a backtracking line
+// search; the state has the best parameters evaluated and their value, the iterations as the generation and the
+// objective evaluations, each one a dataset pass for a batch loss
+[[nodiscard]] auto minimize_gradient(const Parameters& start, const DifferentiableObjective& objective, const GradientSettings& settings)
+    -> GradientResult;
+} // namespace fuzzyrulesml::training
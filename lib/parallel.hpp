@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fuzzyrulesml::parallel {
+// Number of threads to use: 0 means all the hardware threads
+[[nodiscard]] inline auto get_threads_count(std::size_t threads) -> std::size_t {
+  return threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : threads;
+}
+
+// Number of the parts parallel_for splits the range into
+[[nodiscard]] inline auto get_parts_count(std::size_t threads, std::size_t size) -> std::size_t {
+  return std::clamp(get_threads_count(threads), std::size_t{1}, std::max(size, std::size_t{1}));
+}
+
+// Splits [0, size) into get_parts_count contiguous parts of nearly equal sizes and calls function(part, first, count)
+// for each of them concurrently, the first part on the calling thread. The first exception thrown by a part is rethrown
+// after all the parts finished
+template <typename FUNCTION> void parallel_for(std::size_t threads, std::size_t size, FUNCTION&& function) {
+  const auto parts = get_parts_count(threads, size);
+  std::vector<std::exception_ptr> errors(parts);
+  const auto run_part = [&](std::size_t part) {
+    const auto first = (size * part) / parts;
+    const auto last = (size * (part + 1)) / parts;
+    try {
+      function(part, first, last - first);
+    } catch (...) {
+      errors[part] = std::current_exception();
+    }
+  };
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(parts - 1);
+    for (std::size_t part = 1; part < parts; ++part) {
+      workers.emplace_back(run_part, part);
+    }
+    run_part(0);
+  }
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+// ThreadPool keeps its worker threads alive between the jobs, for the loops calling many short parallel jobs (e.g. one
+// per optimizer generation). The calling thread takes part in each job, so the pool of n threads starts n - 1 workers
+class ThreadPool {
+public:
+  explicit ThreadPool(std::size_t threads) {
+    const auto workers_count = get_threads_count(threads) - 1;
+    workers.reserve(workers_count);
+    for (std::size_t worker = 0; worker < workers_count; ++worker) {
+      workers.emplace_back([this]() { work(); });
+    }
+  }
+  ~ThreadPool() {
+    {
+      const std::scoped_lock lock{mutex};
+      stopping = true;
+    }
+    wake.notify_all();
+  }
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+  auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+  auto operator=(ThreadPool&&) -> ThreadPool& = delete;
+
+  [[nodiscard]] auto size() const -> std::size_t { return workers.size() + 1; }
+
+  // Calls function(index) for each index in [0, count) on the pool threads and waits for all of them; the first
+  // exception thrown is rethrown
+  template <typename FUNCTION> void for_each_index(std::size_t count, FUNCTION&& function) {
+    {
+      const std::scoped_lock lock{mutex};
+      task = [&function](std::size_t index) { function(index); };
+      tasks_count = count;
+      next_task = 0;
+      finished_tasks = 0;
+      ++job;
+    }
+    wake.notify_all();
+    run_tasks();
+    std::unique_lock lock{mutex};
+    done.wait(lock, [this]() { return finished_tasks == tasks_count; });
+    task = nullptr;
+    if (error) {
+      std::rethrow_exception(std::exchange(error, nullptr));
+    }
+  }
+
+private:
+  void run_tasks() {
+    while (true) {
+      std::size_t index{0};
+      {
+        const std::scoped_lock lock{mutex};
+        if (next_task >= tasks_count) {
+          return;
+        }
+        index = next_task++;
+      }
+      try {
+        task(index);
+      } catch (...) {
+        const std::scoped_lock lock{mutex};
+        if (not error) {
+          error = std::current_exception();
+        }
+      }
+      const std::scoped_lock lock{mutex};
+      if (++finished_tasks == tasks_count) {
+        done.notify_all();
+      }
+    }
+  }
+
+  void work() {
+    std::size_t seen_job{0};
+    while (true) {
+      {
+        std::unique_lock lock{mutex};
+        wake.wait(lock, [this, seen_job]() { return stopping || job != seen_job; });
+        if (stopping) {
+          return;
+        }
+        seen_job = job;
+      }
+      run_tasks();
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::function<void(std::size_t)> task;
+  std::size_t tasks_count{0};
+  std::size_t next_task{0};
+  std::size_t finished_tasks{0};
+  std::size_t job{0};
+  bool stopping{false};
+  std::exception_ptr error;
+  std::vector<std::jthread> workers;
+};
+} // namespace fuzzyrulesml::parallel
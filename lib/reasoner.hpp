@@ -1,83 +1,547 @@
 #pragma once
 
+#include "columnar.hpp"
+#include "operators.hpp"
+#include "parallel.hpp"
 #include "rules.hpp"
 #include "variable.hpp"
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
 
 namespace fuzzyrulesml::reasoner {
 class fuzzyLiteReasoner {};
 
-auto calculate_one(const auto test_data, auto& reasoner, const auto print) {
-  double goal_func{0.0};
-  if (print) {
-    std::print("------------------------- Printing all results -------------------------\n");
-  }
-  [[maybe_unused]] auto item = 1;
-  for (const auto& [state, results] : test_data) {
-    const auto reasoning_result = reasoner.do_reasoning(state);
-    const auto biggest_val =
-        std::ranges::max_element(reasoning_result, [](const auto& l_item, const auto& r_item) { return l_item.second < r_item.second; });
+// Class id of each conclusion item within the dataset classes, no_class for the items the dataset does not contain
+inline constexpr std::uint32_t no_class = std::numeric_limits<std::uint32_t>::max();
+inline auto get_conclusions_classes(const std::vector<fuzzyrulesml::rules::ConclusionChosen>& conclusions,
+                                    const std::vector<std::string>& classes) -> std::vector<std::uint32_t> {
+  return conclusions | std::views::transform([&classes](const auto& conclusion) {
+           const auto found = std::ranges::find(classes, conclusion.item);
+           return found == classes.end() ? no_class : static_cast<std::uint32_t>(std::distance(classes.begin(), found));
+         }) |
+         std::ranges::to<std::vector<std::uint32_t>>();
+}
 
-    if (print) {
-      std::print("[{}]\t Match: {:6}\t Expected: {:20}\t inferred: {}\n", item++, results == biggest_val->first.item, results,
-                 biggest_val->first.item);
-    }
-    if (results == biggest_val->first.item) {
-      goal_func += 1.0;
+// Index of the best scored conclusion, the first one of the ties; scores must not be empty
+inline auto get_best_conclusion(std::span<const double> scores) -> std::size_t {
+  return static_cast<std::size_t>(std::distance(scores.begin(), std::ranges::max_element(scores)));
+}
+
+// Conclusion inferred for a row of scores: the best scored one, no_inference when no rule fired, all the scores being
+// 0, or there are no conclusions
+inline constexpr std::size_t no_inference = std::numeric_limits<std::size_t>::max();
+inline auto get_inferred_conclusion(std::span<const double> scores) -> std::size_t {
+  const auto best = std::ranges::max_element(scores);
+  return best == scores.end() || *best <= 0.0 ? no_inference : static_cast<std::size_t>(std::distance(scores.begin(), best));
+}
+
+// Scores the rows of a batch with score_rows(first, count, scores) in contiguous parts, concurrently with more threads
+// (0 means all the hardware threads), and counts the rows whose best scored conclusion is of the target class;
+// targets are class ids into the classes, matched against the conclusions mapped to the class ids once per batch.
+// Partial goal functions are reduced in the parts order and the results are printed in the rows order afterwards, so
+// the output does not depend on the threads count. A row firing no rule, e.g. of a missing value, or a reasoner
+// without conclusions infers nothing and matches no row, see get_inferred_conclusion
+auto calculate_batch(const std::vector<fuzzyrulesml::rules::ConclusionChosen>& conclusions, std::span<const std::uint32_t> targets,
+                     const std::vector<std::string>& classes, const auto& score_rows, const bool print, const std::size_t threads)
+    -> double {
+  const auto conclusions_classes = get_conclusions_classes(conclusions, classes);
+  std::vector<double> scores(targets.size() * conclusions.size());
+  const auto get_inferred = [&conclusions, &scores](std::size_t row) -> std::size_t {
+    return get_inferred_conclusion(std::span<const double>{scores}.subspan(row * conclusions.size(), conclusions.size()));
+  };
+
+  std::vector<double> partial_goal_funcs(fuzzyrulesml::parallel::get_parts_count(threads, targets.size()), 0.0);
+  fuzzyrulesml::parallel::parallel_for(threads, targets.size(), [&](std::size_t part, std::size_t first, std::size_t count) {
+    score_rows(first, count, std::span{scores}.subspan(first * conclusions.size(), count * conclusions.size()));
+    for (std::size_t row = first; row < first + count; ++row) {
+      const auto inferred = get_inferred(row);
+      if (inferred != no_inference && targets[row] == conclusions_classes[inferred]) {
+        partial_goal_funcs[part] += 1.0;
+      }
     }
-  }
+  });
+
   if (print) {
+    std::print("------------------------- Printing all results -------------------------\n");
+    for (std::size_t row = 0; row < targets.size(); ++row) {
+      const auto inferred = get_inferred(row);
+      if (inferred == no_inference) {
+        std::print("[{}]\t Match: {:6}\t Expected: {:20}\t inferred: none\n", row + 1, false, classes.at(targets[row]));
+        continue;
+      }
+      std::print("[{}]\t Match: {:6}\t Expected: {:20}\t inferred: {}\n", row + 1, targets[row] == conclusions_classes[inferred],
+                 classes.at(targets[row]), conclusions[inferred].item);
+    }
     std::print("------------------------- End of results -------------------------\n");
   }
-  return goal_func;
+  return std::accumulate(partial_goal_funcs.begin(), partial_goal_funcs.end(), 0.0);
 }
 
-auto get_membership(const auto fuzzy_variable, const auto crisp_value) { return fuzzy_variable.get_membership(crisp_value); }
+// Batch version of calculate_one: scores all the rows of the inputs at once and compares the best scored conclusions
+// with the target class ids, see calculate_batch
+auto calculate_one(const fuzzyrulesml::rules::BatchInputs& inputs, std::span<const std::uint32_t> targets,
+                   const std::vector<std::string>& classes, const auto& reasoner, const bool print, const std::size_t threads = 1)
+    -> double {
+  if (targets.size() != inputs.get_rows()) {
+    throw std::runtime_error("Targets count differs from the batch rows count");
+  }
+  return calculate_batch(
+      reasoner.get_conclusions(), targets, classes,
+      [&inputs, &reasoner](std::size_t first, std::size_t count, std::span<double> scores) {
+        if (count == inputs.get_rows()) {
+          reasoner.do_reasoning(inputs, scores);
+        } else {
+          reasoner.do_reasoning(inputs.slice(first, count), scores);
+        }
+      },
+      print, threads);
+}
 
-void set_rule_membership_value(auto& rule_memberships, const auto fuzzy_variable, const auto membership) {
-  const fuzzyrulesml::rules::FuzzyVarMembership fvmem{fuzzy_variable, membership.first};
-  const auto found = rule_memberships.find(fvmem);
-  if (found != rule_memberships.end()) {
-    found->second = membership.second;
+// calculate_one scoring the inputs with the characteristic points of the candidate parameters, see ParametersBinding
+auto calculate_one(const fuzzyrulesml::rules::BatchInputs& inputs, const fuzzyrulesml::rules::ParametersBinding& binding,
+                   std::span<const double> candidate, std::span<const std::uint32_t> targets, const std::vector<std::string>& classes,
+                   const auto& reasoner, const bool print, const std::size_t threads = 1) -> double {
+  if (targets.size() != inputs.get_rows()) {
+    throw std::runtime_error("Targets count differs from the batch rows count");
   }
+  return calculate_batch(
+      reasoner.get_conclusions(), targets, classes,
+      [&inputs, &binding, candidate, &reasoner](std::size_t first, std::size_t count, std::span<double> scores) {
+        if (count == inputs.get_rows()) {
+          reasoner.do_reasoning(inputs, binding, candidate, scores);
+        } else {
+          reasoner.do_reasoning(inputs.slice(first, count), binding, candidate, scores);
+        }
+      },
+      print, threads);
+}
+
+// Targets given by their names are interned into class ids first
+auto calculate_one(const fuzzyrulesml::rules::BatchInputs& inputs, const std::vector<std::string>& targets, const auto& reasoner,
+                   const bool print, const std::size_t threads = 1) -> double {
+  fuzzyrulesml::dataset::StringInterner classes;
+  const auto class_ids = targets | std::views::transform([&classes](const auto& target) { return classes.intern(target); }) |
+                         std::ranges::to<std::vector<std::uint32_t>>();
+  return calculate_one(inputs, class_ids, classes.get_values(), reasoner, print, threads);
+}
+
+auto calculate_one(const fuzzyrulesml::rules::BatchInputs& inputs, const fuzzyrulesml::rules::ParametersBinding& binding,
+                   std::span<const double> candidate, const std::vector<std::string>& targets, const auto& reasoner, const bool print,
+                   const std::size_t threads = 1) -> double {
+  fuzzyrulesml::dataset::StringInterner classes;
+  const auto class_ids = targets | std::views::transform([&classes](const auto& target) { return classes.intern(target); }) |
+                         std::ranges::to<std::vector<std::uint32_t>>();
+  return calculate_one(inputs, binding, candidate, class_ids, classes.get_values(), reasoner, print, threads);
+}
+
+// calculate_one of the DataSet::get_items view: its binding of the variables to the columns is scored by the batch
+// reasoning, without building the per-row samples
+auto calculate_one(const auto& items, const auto& reasoner, const bool print, const std::size_t threads = 1) -> double
+  requires requires { items.get_batch_inputs(); }
+{
+  return calculate_one(items.get_batch_inputs(), items.get_targets(), items.get_classes(), reasoner, print, threads);
 }
 
-class SimpleReasoner {
+// Representation of the rules the batch reasoning scores with: the posting lists of the rules preconditions, or the
+// dense grid of the rules over the terms of their variables, see RulesSet::get_dense_grid; automatic takes the dense
+// grid when the rules set has one, filled by half at least
+enum class RulesLayout { automatic, sparse, dense };
+
+// Reasoner of a rules set with the t-norm of the rules preconditions and the aggregation of the rules strengths given
+// as policies, see operators.hpp; SimpleReasoner is the one of the product t-norm and the sum aggregation
+template <TNorm TNORM = ProductTNorm, Aggregation AGGREGATION = SumAggregation> class BasicReasoner {
 public:
-  SimpleReasoner(const fuzzyrulesml::rules::RulesSet& rules) : stored_rules{rules} {};
+  // Rows fuzzified at once by the batch reasoning
+  static constexpr std::size_t batch_chunk_rows = 256;
+
+  BasicReasoner(const fuzzyrulesml::rules::RulesSet& rules, RulesLayout layout = RulesLayout::automatic)
+      : stored_rules{rules}, conclusions{rules.get_conclusions()}, rules_conclusions{get_rules_conclusions(rules, conclusions)},
+        dense_grid{get_dense_grid(rules, layout)} {
+    for (std::size_t rule_id = 0; rule_id < rules_conclusions.size(); ++rule_id) {
+      max_preconditions = std::max(max_preconditions, rules.get_preconditions_count(rule_id));
+    }
+    if (dense_grid) {
+      cells_conclusions = dense_grid->get_cells() | std::views::transform([this](const auto rule_id) {
+                            return rule_id == fuzzyrulesml::rules::DenseRulesGrid::no_rule ? no_conclusion : rules_conclusions[rule_id];
+                          }) |
+                          std::ranges::to<std::vector<std::size_t>>();
+    }
+  };
   [[nodiscard]] auto do_reasoning(const fuzzyrulesml::rules::RuleTestingValues& variables_map) const
       -> std::map<fuzzyrulesml::rules::ConclusionChosen, double> {
-    const auto usefeul_rules = stored_rules.get_rules(variables_map);
-    std::multimap<fuzzyrulesml::rules::ConclusionChosen, double> conclusions;
-    for (const auto& rule : usefeul_rules) {
-      conclusions.insert(std::pair{rule.get_conclusion(), evaluate_rule(rule.get_preconditions(), variables_map)});
+    std::map<fuzzyrulesml::rules::ConclusionChosen, double> conclusions;
+    for (const auto rule_id : stored_rules.get_rules_ids(variables_map)) {
+      const auto& rule = stored_rules.get_all_rules()[rule_id];
+      auto& score = conclusions[rule.get_conclusion()];
+      score = AGGREGATION::combine(score, evaluate_rule(rule.get_preconditions(), variables_map));
+    }
+    return conclusions;
+  }
+
+  using TNormPolicy = TNORM;
+  using AggregationPolicy = AGGREGATION;
+
+  [[nodiscard]] auto get_rules() const -> const fuzzyrulesml::rules::RulesSet& { return stored_rules; }
+  // Conclusions being the columns of the batch scores matrix
+  [[nodiscard]] auto get_conclusions() const -> const std::vector<fuzzyrulesml::rules::ConclusionChosen>& { return conclusions; }
+  // Whether the batch reasoning scores with the dense grid of the rules
+  [[nodiscard]] auto is_dense() const -> bool { return dense_grid.has_value(); }
+
+  // Batch reasoning: scores is a preallocated row-major matrix of inputs.get_rows() x get_conclusions().size(); the
+  // input variables are resolved to the rules index once per batch, the columns are fuzzified in chunks by the
+  // vectorized kernels, and fired rules are found by counting the hits of their preconditions, as RulesSet::get_rules does
+  void do_reasoning(const fuzzyrulesml::rules::BatchInputs& inputs, std::span<double> scores) const {
+    score_batch(inputs, scores, [&inputs](std::size_t column, auto values, auto segments, auto degrees) {
+      inputs.get_variables()[column].fuzzify(values, segments, degrees);
+    });
+  }
+
+  // Batch reasoning with the characteristic points taken from the candidate parameters of the binding layout instead
+  // of the input variables; the reasoner, the inputs and the binding are not modified, so candidates can be scored
+  // concurrently
+  void do_reasoning(const fuzzyrulesml::rules::BatchInputs& inputs, const fuzzyrulesml::rules::ParametersBinding& binding,
+                    std::span<const double> candidate, std::span<double> scores) const {
+    if (binding.get_columns_count() != inputs.get_variables().size() || candidate.size() != binding.size()) {
+      throw std::runtime_error("Parameters binding does not match the batch");
+    }
+    score_batch(inputs, scores, [&inputs, &binding, candidate](std::size_t variable, auto values, auto segments, auto degrees) {
+      inputs.get_variables()[variable].fuzzify(binding.get_points(candidate, variable), values, segments, degrees);
+    });
+  }
+
+  // Scratch of the rules firing counters, or of the dense grid cells, for score_row, reused across the rows
+  class RowScratch {
+  public:
+    RowScratch(std::size_t rules_count, std::size_t cells_count)
+        : hits(rules_count, 0), strengths(std::max(rules_count, cells_count), TNORM::identity), cells(cells_count) {
+      // A rule fires once per row at most, so the fired rules never reallocate; the dense grid scores the cells
+      // directly, its fired rules grow on the first rows of fire_row only
+      fired_rules.reserve(rules_count);
+      fired_conclusions.reserve(rules_count);
+      fired_strengths.reserve(rules_count);
+    }
+
+  private:
+    friend class BasicReasoner;
+    // Hits of the rules counted from the base of the current row: the counters below the base are left by the previous
+    // rows, so they are reset on the first hit instead of after each row
+    std::vector<std::size_t> hits;
+    std::size_t hits_base = 1;
+    // Strengths of the rules, or of the cells around the row
+    std::vector<double> strengths;
+    std::vector<std::size_t> cells;
+    // Rules fired by the current row with their conclusions and strengths, aggregated into its scores at once
+    std::vector<std::size_t> fired_rules;
+    std::vector<std::size_t> fired_conclusions;
+    std::vector<double> fired_strengths;
+  };
+
+  // Input variables of a batch resolved to the rules once per batch, see get_batch_plan
+  class BatchPlan {
+  public:
+    // Whether any rule tests the variable of the column, so score_row takes its fuzzified values
+    [[nodiscard]] auto uses(std::size_t column) const -> bool { return postings[column] != nullptr; }
+
+  private:
+    friend class BasicReasoner;
+    // Posting lists of each column, nullptr for the variables no rule uses
+    std::vector<const fuzzyrulesml::rules::RulesSet::RulesPostings*> postings;
+    // Column of each dense grid axis, empty when some grid variable is not in the batch, so no rule fires
+    std::vector<std::size_t> axes_columns;
+  };
+
+  // Scratch of the single sample reasoning, and of score_row
+  [[nodiscard]] auto make_sample_scratch() const -> RowScratch { return RowScratch{rules_conclusions.size(), 0}; }
+  [[nodiscard]] auto make_row_scratch() const -> RowScratch {
+    return dense_grid ? RowScratch{0, std::size_t{1} << dense_grid->get_variables().size()} : RowScratch{rules_conclusions.size(), 0};
+  }
+  [[nodiscard]] auto get_batch_plan(const fuzzyrulesml::rules::BatchInputs& inputs) const -> BatchPlan {
+    BatchPlan plan;
+    plan.postings = inputs.get_variables() |
+                    std::views::transform([this](const auto& variable) { return stored_rules.get_postings(variable); }) |
+                    std::ranges::to<std::vector<const fuzzyrulesml::rules::RulesSet::RulesPostings*>>();
+    if (dense_grid) {
+      for (const auto variable_id : dense_grid->get_variables()) {
+        const auto found = std::ranges::find_if(inputs.get_variables(), [this, variable_id](const auto& variable) {
+          return variable.get_id() == variable_id && stored_rules.contains(variable);
+        });
+        if (found == inputs.get_variables().end()) {
+          plan.axes_columns.clear();
+          break;
+        }
+        plan.axes_columns.push_back(static_cast<std::size_t>(std::distance(inputs.get_variables().begin(), found)));
+      }
+    }
+    return plan;
+  }
+
+  // Single sample reasoning into a preallocated array of get_conclusions().size() scores, indexed as get_conclusions(),
+  // that is by the output variable and its category; the rules are matched through the posting lists with the
+  // counters of the scratch from make_sample_scratch, so reusing the scores and the scratch, the call does not allocate.
+  // See get_best_conclusion for the best scored conclusion
+  void do_reasoning(const fuzzyrulesml::rules::RuleTestingValues& variables_map, std::span<double> scores, RowScratch& scratch) const {
+    if (scores.size() != conclusions.size() || scratch.hits.size() != rules_conclusions.size()) {
+      throw std::runtime_error("Invalid size of the scores or the scratch");
     }
-    return std::accumulate(conclusions.begin(), conclusions.end(), std::map<fuzzyrulesml::rules::ConclusionChosen, double>{},
-                           [](auto acc, const auto& pair) {
-                             acc[pair.first] += pair.second;
-                             return acc;
-                           });
+    std::ranges::fill(scores, 0.0);
+    add_unconditional_rules(scratch);
+    for (const auto& [variable, crisp_value] : variables_map) {
+      const auto* postings = stored_rules.get_postings(variable);
+      if (postings == nullptr) {
+        continue;
+      }
+      for (const auto& [membership_index, degree] : variable.get_membership(crisp_value)) {
+        fire_rules(*postings, membership_index, degree, scratch);
+      }
+    }
+    next_row(scratch);
+    AGGREGATION::combine(scores, scratch.fired_conclusions, scratch.fired_strengths);
+  }
+
+  // Rules fired by a row: their ids into get_rules().get_all_rules(), the indices of their conclusions in
+  // get_conclusions() and their strengths, in the order they are aggregated; the spans refer to the scratch, so they
+  // are valid until it fires the next row
+  struct FiredRules {
+    std::span<const std::size_t> rules;
+    std::span<const std::size_t> conclusions;
+    std::span<const double> strengths;
+  };
+
+  // Fires the rules of a single fuzzified row, through the dense grid or the posting lists, without aggregating them;
+  // fuzzified(variable) returns the (segment, degree) pair of the variable value, see fuzzify_column. The scores of the
+  // row are AGGREGATION::combine of the fired rules, so the callers analysing the rules fire them as the scores do
+  [[nodiscard]] auto fire_row(const BatchPlan& plan, const auto& fuzzified, RowScratch& scratch) const -> FiredRules {
+    if (dense_grid) {
+      scratch.fired_rules.clear();
+      scratch.fired_conclusions.clear();
+      scratch.fired_strengths.clear();
+      const auto count = fire_dense_cells(plan, fuzzified, scratch);
+      const auto& cells_rules = dense_grid->get_cells();
+      for (std::size_t cell = 0; cell < count; ++cell) {
+        const auto rule_id = cells_rules[scratch.cells[cell]];
+        if (rule_id != fuzzyrulesml::rules::DenseRulesGrid::no_rule) {
+          add_fired_rule(rule_id, scratch.strengths[cell], scratch);
+        }
+      }
+    } else {
+      add_unconditional_rules(scratch);
+      const auto& postings = plan.postings;
+      for (std::size_t variable = 0; variable < postings.size(); ++variable) {
+        if (postings[variable] == nullptr) {
+          continue;
+        }
+        const auto [segment, degree] = fuzzified(variable);
+        if (segment == fuzzyrulesml::mfunct::no_segment) {
+          continue;
+        }
+        fire_rules(*postings[variable], segment, degree, scratch);
+        fire_rules(*postings[variable], segment + 1, 1.0 - degree, scratch);
+      }
+      next_row(scratch);
+    }
+    return {.rules = scratch.fired_rules, .conclusions = scratch.fired_conclusions, .strengths = scratch.fired_strengths};
+  }
+
+  // Adds the strengths of the rules fired by a single fuzzified row to its scores, get_conclusions().size() of them;
+  // fuzzified(variable) returns the (segment, degree) pair of the variable value, see fuzzify_column
+  void score_row(const BatchPlan& plan, const auto& fuzzified, std::span<double> row_scores, RowScratch& scratch) const {
+    if (dense_grid) {
+      score_dense_row(plan, fuzzified, row_scores, scratch);
+      return;
+    }
+    const auto fired = fire_row(plan, fuzzified, scratch);
+    AGGREGATION::combine(row_scores, fired.conclusions, fired.strengths);
+  }
+
+  // Fuzzifies the rows [first, first + count) of the batch in chunks of batch_chunk_rows, the columns the plan uses
+  // only, and calls on_row(row, fuzzified) for each row in order, fuzzified as score_row and fire_row take it;
+  // fuzzify(column, values, segments, degrees) fuzzifies the values of a column, by the points of its variable when
+  // not given
+  void for_each_fuzzified_row(const BatchPlan& plan, const fuzzyrulesml::rules::BatchInputs& inputs, std::size_t first, std::size_t count,
+                              const auto& fuzzify, const auto& on_row) const {
+    const auto& columns = inputs.get_columns();
+    std::vector<std::uint32_t> segments(columns.size() * batch_chunk_rows);
+    std::vector<double> degrees(columns.size() * batch_chunk_rows);
+    for (std::size_t chunk = first; chunk < first + count; chunk += batch_chunk_rows) {
+      const auto chunk_rows = std::min(batch_chunk_rows, first + count - chunk);
+      for (std::size_t column = 0; column < columns.size(); ++column) {
+        if (plan.uses(column)) {
+          fuzzify(column, columns[column].subspan(chunk, chunk_rows), std::span{segments}.subspan(column * batch_chunk_rows, chunk_rows),
+                  std::span{degrees}.subspan(column * batch_chunk_rows, chunk_rows));
+        }
+      }
+      for (std::size_t row = 0; row < chunk_rows; ++row) {
+        on_row(chunk + row, [&](std::size_t column) {
+          return std::pair{segments[(column * batch_chunk_rows) + row], degrees[(column * batch_chunk_rows) + row]};
+        });
+      }
+    }
+  }
+  void for_each_fuzzified_row(const BatchPlan& plan, const fuzzyrulesml::rules::BatchInputs& inputs, std::size_t first, std::size_t count,
+                              const auto& on_row) const {
+    for_each_fuzzified_row(
+        plan, inputs, first, count,
+        [&inputs](std::size_t column, auto values, auto segments, auto degrees) {
+          inputs.get_variables()[column].fuzzify(values, segments, degrees);
+        },
+        on_row);
   }
 
 private:
+  void add_fired_rule(std::size_t rule_id, double strength, RowScratch& scratch) const {
+    scratch.fired_rules.push_back(rule_id);
+    scratch.fired_conclusions.push_back(rules_conclusions[rule_id]);
+    scratch.fired_strengths.push_back(strength);
+  }
+  // Starts the fired rules of a row with the unconditional rules
+  void add_unconditional_rules(RowScratch& scratch) const {
+    scratch.fired_rules.clear();
+    scratch.fired_conclusions.clear();
+    scratch.fired_strengths.clear();
+    for (const auto rule_id : stored_rules.get_unconditional_rules()) {
+      add_fired_rule(rule_id, TNORM::identity, scratch);
+    }
+  }
+  // Applies the degree of the fired membership function to the rules of its posting list, adding the rules of all the
+  // preconditions fired to the fired rules of the row
+  void fire_rules(const fuzzyrulesml::rules::RulesSet::RulesPostings& variable_postings, std::size_t membership_index, double degree,
+                  RowScratch& scratch) const {
+    if (degree <= 0.0 || membership_index >= variable_postings.size()) {
+      return;
+    }
+    const auto base = scratch.hits_base;
+    for (const auto rule_id : variable_postings[membership_index]) {
+      auto& hits = scratch.hits[rule_id];
+      auto& strength = scratch.strengths[rule_id];
+      const bool first_hit = hits < base;
+      strength = TNORM::apply(first_hit ? TNORM::identity : strength, degree);
+      hits = (first_hit ? base : hits) + 1;
+      if (hits == base + stored_rules.get_preconditions_count(rule_id)) {
+        add_fired_rule(rule_id, strength, scratch);
+      }
+    }
+  }
+  // A rule is hit at most once per precondition in a row, so the next base is above all the counters of the row
+  void next_row(RowScratch& scratch) const { scratch.hits_base += max_preconditions + 1; }
+
+  void score_batch(const fuzzyrulesml::rules::BatchInputs& inputs, std::span<double> scores, const auto& fuzzify) const {
+    if (scores.size() != inputs.get_rows() * conclusions.size()) {
+      throw std::runtime_error("Invalid size of the scores matrix");
+    }
+    const auto plan = get_batch_plan(inputs);
+    auto scratch = make_row_scratch();
+    std::ranges::fill(scores, 0.0);
+    for_each_fuzzified_row(plan, inputs, 0, inputs.get_rows(), fuzzify, [&](std::size_t row, const auto& fuzzified) {
+      score_row(plan, fuzzified, scores.subspan(row * conclusions.size(), conclusions.size()), scratch);
+    });
+  }
+
+  // Adds the strengths of the cells around the row: each grid variable fires its segment with the degree and the next
+  // term with 1 - degree, as the posting lists do, so the cells are built axis by axis, doubled only for the variables
+  // firing both terms; the strength of a cell is the t-norm of the degrees in the axes order
+  void score_dense_row(const BatchPlan& plan, const auto& fuzzified, std::span<double> row_scores, RowScratch& scratch) const {
+    const auto count = fire_dense_cells(plan, fuzzified, scratch);
+    for (std::size_t cell = 0; cell < count; ++cell) {
+      const auto conclusion = cells_conclusions[scratch.cells[cell]];
+      if (conclusion != no_conclusion) {
+        row_scores[conclusion] = AGGREGATION::combine(row_scores[conclusion], scratch.strengths[cell]);
+      }
+    }
+  }
+  // Fills the cells around the row and their strengths into the scratch; returns their count
+  auto fire_dense_cells(const BatchPlan& plan, const auto& fuzzified, RowScratch& scratch) const -> std::size_t {
+    if (plan.axes_columns.empty()) {
+      return 0;
+    }
+    auto cells = std::span{scratch.cells};
+    auto strengths = std::span{scratch.strengths};
+    cells[0] = 0;
+    strengths[0] = TNORM::identity;
+    std::size_t count = 1;
+    const auto& strides = dense_grid->get_strides();
+    for (std::size_t axis = 0; axis < plan.axes_columns.size(); ++axis) {
+      const auto [segment, degree] = fuzzified(plan.axes_columns[axis]);
+      if (segment == fuzzyrulesml::mfunct::no_segment) {
+        return 0;
+      }
+      const auto lower = segment * strides[axis];
+      const auto upper = lower + strides[axis];
+      if (degree <= 0.0 || 1.0 - degree <= 0.0) {
+        // A single term fired
+        const auto offset = degree <= 0.0 ? upper : lower;
+        for (std::size_t cell = 0; cell < count; ++cell) {
+          cells[cell] += offset;
+        }
+        TNORM::apply(strengths.first(count), degree <= 0.0 ? 1.0 - degree : degree);
+        continue;
+      }
+      for (std::size_t cell = 0; cell < count; ++cell) {
+        cells[count + cell] = cells[cell] + upper;
+        strengths[count + cell] = TNORM::apply(strengths[cell], 1.0 - degree);
+        cells[cell] += lower;
+        strengths[cell] = TNORM::apply(strengths[cell], degree);
+      }
+      count *= 2;
+    }
+    return count;
+  }
+
+  [[nodiscard]] static auto get_dense_grid(const fuzzyrulesml::rules::RulesSet& rules, RulesLayout layout)
+      -> std::optional<fuzzyrulesml::rules::DenseRulesGrid> {
+    if (layout == RulesLayout::sparse) {
+      return std::nullopt;
+    }
+    auto grid = rules.get_dense_grid();
+    if (layout == RulesLayout::dense && not grid) {
+      throw std::runtime_error("Rules set has no dense grid");
+    }
+    if (layout == RulesLayout::automatic && grid && grid->get_filled() * 2 < grid->get_cells().size()) {
+      return std::nullopt;
+    }
+    return grid;
+  }
+
   [[nodiscard]] static auto evaluate_rule(const std::map<typename fuzzyrulesml::rules::FuzzyVarMembership::MembershipKey,
                                                          typename fuzzyrulesml::rules::FuzzyVarMembership::MembershipIndex>& rule_variables,
                                           const fuzzyrulesml::rules::RuleTestingValues& crisp_values_for_rule_variables) -> double {
-    std::map<fuzzyrulesml::rules::FuzzyVarMembership, double> rule_memberships{};
+    // The membership is taken from the testing values variable, as it carries the current characteristic points
+    double strength = TNORM::identity;
     for (const auto& [fuzzy_variable, member_funct] : rule_variables) {
-      rule_memberships[fuzzyrulesml::rules::FuzzyVarMembership(fuzzy_variable, member_funct)] = 0.0;
-    }
-    for (const auto& [fuzzy_variable, crisp_value] : crisp_values_for_rule_variables) {
-      const auto memberships = get_membership(fuzzy_variable, crisp_value);
-      for (const auto& membership : memberships) {
-        set_rule_membership_value(rule_memberships, fuzzy_variable, membership);
+      const auto found = crisp_values_for_rule_variables.find(fuzzy_variable);
+      if (found == crisp_values_for_rule_variables.end()) {
+        return 0.0;
       }
+      strength = TNORM::apply(strength, found->first.get_membership(found->second).get_membership(member_funct));
     }
-    return std::accumulate(rule_memberships.begin(), rule_memberships.end(), 1.0,
-                           [](auto acc, const auto& pair) { return acc * pair.second; });
+    return strength;
   };
+  // Index of each rule conclusion in the conclusions vector
+  [[nodiscard]] static auto get_rules_conclusions(const fuzzyrulesml::rules::RulesSet& rules,
+                                                  const std::vector<fuzzyrulesml::rules::ConclusionChosen>& conclusions)
+      -> std::vector<std::size_t> {
+    return std::views::iota(std::size_t{0}, rules.get_rules_count()) | std::views::transform([&rules, &conclusions](const auto rule_id) {
+             const auto found = std::lower_bound(conclusions.begin(), conclusions.end(), rules.get_rule_conclusion(rule_id));
+             return static_cast<std::size_t>(std::distance(conclusions.begin(), found));
+           }) |
+           std::ranges::to<std::vector<std::size_t>>();
+  }
   fuzzyrulesml::rules::RulesSet stored_rules;
+  std::vector<fuzzyrulesml::rules::ConclusionChosen> conclusions;
+  std::vector<std::size_t> rules_conclusions;
+  std::size_t max_preconditions = 0;
+  // Conclusion index of each dense grid cell, no_conclusion for the empty cells
+  static constexpr std::size_t no_conclusion = std::numeric_limits<std::size_t>::max();
+  std::optional<fuzzyrulesml::rules::DenseRulesGrid> dense_grid;
+  std::vector<std::size_t> cells_conclusions;
 };
 
+using SimpleReasoner = BasicReasoner<>;
+
 template <typename REASONER> auto create_reasoner() -> REASONER { return REASONER{}; }
 } // namespace fuzzyrulesml::reasoner
@@ -1,6 +1,13 @@
 #include "rules.hpp"
+#include <array>
+#include <functional>
+#include <numeric>
 
 namespace fuzzyrulesml::rules {
+namespace {
+// Scattered writes resetting the hits counters cost about as much as this many sequential ones
+const std::size_t scattered_reset_ratio = 8;
+} // namespace
 
 auto all_variables_match(const std::multimap<FuzzyVarUnion, std::size_t>& variables_map,
                          const std::map<FuzzyVarUnion, std::size_t>& preconditions) -> bool {
@@ -11,7 +18,8 @@ auto all_variables_match(const std::multimap<FuzzyVarUnion, std::size_t>& variab
   }));
 }
 
-auto get_matching_rules(const auto rules, const std::multimap<FuzzyVarUnion, std::size_t>& variables_map) -> std::vector<Rule> {
+auto get_matching_rules(const std::vector<Rule>& rules, const std::multimap<FuzzyVarUnion, std::size_t>& variables_map)
+    -> std::vector<Rule> {
   return rules |
          std::views::filter([&variables_map](const auto& rule) { return all_variables_match(variables_map, rule.get_preconditions()); }) |
          std::ranges::to<std::vector<Rule>>();
@@ -22,36 +30,296 @@ auto RulesSet::add_output_variable(std::string_view variable_name, std::vector<s
   if (!is_inserted) {
     throw std::runtime_error("Output variable already exists");
   }
+  for (const auto& category : pointer->second) {
+    conclusions_table.push_back({pointer->first, category});
+  }
   return Conclusion{pointer->first, pointer->second};
 }
 
 void RulesSet::add_rule(const std::map<FuzzyVarUnion, std::size_t>& variables_map, const ConclusionChosen& conclusion) {
-  if (not std::ranges::all_of(variables_map | std::views::keys,
-                              [this](const auto& variable) { return input_variables.contains(variable); })) {
+  if (not std::ranges::all_of(variables_map | std::views::keys, [this](const auto& variable) { return contains(variable); })) {
     throw std::runtime_error("Input variable not found");
   }
+  const auto conclusion_id = find_conclusion(conclusion);
+  auto& cache = get_own_rules_cache();
+  const auto rule_id = get_rules_count();
+  const auto offset = preconditions.size();
+  for (const auto& [variable, membership_index] : variables_map) {
+    preconditions.push_back({static_cast<std::uint32_t>(variable.get_id()), static_cast<std::uint32_t>(membership_index)});
+  }
+  store_rule(offset, variables_map.size(), conclusion_id);
+  // The rule object is kept when the ones before it are, so the rules added in code are not built again
+  if (cache.rules.size() == rule_id) {
+    cache.rules.emplace_back(variables_map, conclusion);
+    cache.built.store(cache.rules.size(), std::memory_order_release);
+  }
+}
 
-  const auto found = output_variables.find(conclusion.name);
-  if (found == output_variables.end()) {
-    throw std::runtime_error("Output variable not found");
-  };
-  const auto internal_found = std::ranges::find(found->second, conclusion.item);
-  if (internal_found == found->second.end()) {
+void RulesSet::add_rule_by_ids(std::span<const std::uint32_t> precondition_pairs, const ConclusionChosen& conclusion) {
+  const std::array<std::uint32_t, 1> preconditions_counts{static_cast<std::uint32_t>(precondition_pairs.size() / 2)};
+  const std::array<std::uint32_t, 1> conclusions{find_conclusion(conclusion)};
+  add_rules_by_ids(precondition_pairs, preconditions_counts, conclusions);
+}
+
+void RulesSet::add_rules_by_ids(std::span<const std::uint32_t> precondition_pairs, std::span<const std::uint32_t> preconditions_counts,
+                                std::span<const std::uint32_t> conclusions) {
+  if (preconditions_counts.size() != conclusions.size()) {
+    throw std::runtime_error("Rules preconditions counts and conclusions differ in size");
+  }
+  if (std::ranges::any_of(conclusions, [this](const auto conclusion) { return conclusion >= conclusions_table.size(); })) {
     throw std::runtime_error("Conclusion item not found");
   }
-  rules.emplace_back(variables_map, conclusion);
+  const auto preconditions_total = std::accumulate(preconditions_counts.begin(), preconditions_counts.end(), std::uint64_t{0});
+  if (precondition_pairs.size() % 2 != 0 || precondition_pairs.size() / 2 != preconditions_total) {
+    throw std::runtime_error("Preconditions are not (variable id, term) pairs of the rules");
+  }
+  const auto terms_counts = input_variables | std::views::transform([](const auto& variable) { return variable.get_points().size(); }) |
+                            std::ranges::to<std::vector<std::size_t>>();
+  std::size_t index = 0;
+  for (const auto rule_preconditions_count : preconditions_counts) {
+    // By the increasing ids within a rule, so a variable is tested once
+    for (std::size_t precondition = 0; precondition < rule_preconditions_count; ++precondition, index += 2) {
+      const auto variable_id = precondition_pairs[index];
+      if (variable_id >= input_variables.size() || (precondition > 0 && variable_id <= precondition_pairs[index - 2])) {
+        throw std::runtime_error("Input variable not found");
+      }
+      if (precondition_pairs[index + 1] >= terms_counts[variable_id]) {
+        throw std::runtime_error("Membership function not found");
+      }
+    }
+  }
+
+  static_cast<void>(get_own_rules_cache());
+  // The storage of a rules set without rules is sized once, the posting lists from the terms counts of all the rules
+  if (get_rules_count() == 0) {
+    rules_conclusions.reserve(conclusions.size());
+    preconditions_offsets.reserve(conclusions.size());
+    preconditions_count.reserve(conclusions.size());
+    preconditions.reserve(precondition_pairs.size() / 2);
+    std::vector<std::vector<std::size_t>> postings_sizes(input_variables.size());
+    for (std::size_t variable_id = 0; variable_id < input_variables.size(); ++variable_id) {
+      postings_sizes[variable_id].resize(terms_counts[variable_id]);
+    }
+    for (index = 0; index < precondition_pairs.size(); index += 2) {
+      ++postings_sizes[precondition_pairs[index]][precondition_pairs[index + 1]];
+    }
+    for (std::size_t variable_id = 0; variable_id < input_variables.size(); ++variable_id) {
+      // Up to the last term used, as index_precondition sizes them
+      const auto& sizes = postings_sizes[variable_id];
+      auto& postings = rules_index[variable_id];
+      for (auto term = sizes.size(); term-- > 0;) {
+        if (sizes[term] == 0) {
+          continue;
+        }
+        if (postings.size() <= term) {
+          postings.resize(term + 1);
+        }
+        postings[term].reserve(sizes[term]);
+      }
+    }
+  }
+  auto offset = preconditions.size();
+  for (index = 0; index < precondition_pairs.size(); index += 2) {
+    preconditions.push_back({precondition_pairs[index], precondition_pairs[index + 1]});
+  }
+  for (std::size_t rule = 0; rule < conclusions.size(); ++rule) {
+    store_rule(offset, preconditions_counts[rule], conclusions[rule]);
+    offset += preconditions_counts[rule];
+  }
 }
 
-auto RulesSet::get_rules(const RuleTestingValues& variables_map) const -> std::vector<Rule> {
-  std::multimap<FuzzyVarUnion, std::size_t> output_map;
-  for (const auto& variable : variables_map) {
-    const Membership memberships = variable.first.get_membership(variable.second);
+void RulesSet::store_rule(std::size_t offset, std::size_t count, std::uint32_t conclusion) {
+  const auto rule_id = get_rules_count();
+  preconditions_offsets.push_back(offset);
+  preconditions_count.push_back(count);
+  rules_conclusions.push_back(conclusion);
+  if (count == 0) {
+    unconditional_rules.push_back(rule_id);
+  }
+  for (const auto& [variable_id, term] : get_rule_preconditions(rule_id)) {
+    index_precondition(variable_id, term, rule_id);
+  }
+}
 
+auto RulesSet::find_conclusion(const ConclusionChosen& conclusion) const -> std::uint32_t {
+  const auto found = std::ranges::find_if(conclusions_table, [&conclusion](const auto& chosen) {
+    return chosen.name == conclusion.name && chosen.item == conclusion.item;
+  });
+  if (found != conclusions_table.end()) {
+    return static_cast<std::uint32_t>(std::distance(conclusions_table.begin(), found));
+  }
+  if (not output_variables.contains(conclusion.name)) {
+    throw std::runtime_error("Output variable not found");
+  }
+  throw std::runtime_error("Conclusion item not found");
+}
+
+void RulesSet::index_precondition(std::size_t variable_id, std::size_t membership_index, std::size_t rule_id) {
+  auto& postings = rules_index[variable_id];
+  if (postings.size() <= membership_index) {
+    postings.resize(membership_index + 1);
+  }
+  postings[membership_index].push_back(rule_id);
+}
+
+auto RulesSet::get_own_rules_cache() -> RulesCache& {
+  if (rules_cache == nullptr || rules_cache.use_count() > 1) {
+    rules_cache = std::make_shared<RulesCache>();
+  }
+  return *rules_cache;
+}
+
+auto RulesSet::make_rule(std::size_t rule_id) const -> Rule {
+  std::map<FuzzyVarUnion, std::size_t> variables_map;
+  for (const auto& [variable_id, term] : get_rule_preconditions(rule_id)) {
+    variables_map.emplace_hint(variables_map.end(), input_variables[variable_id], term);
+  }
+  return {std::move(variables_map), ConclusionChosen{get_rule_conclusion(rule_id)}};
+}
+
+auto RulesSet::get_rules_ids(const RuleTestingValues& variables_map) const -> std::vector<std::size_t> {
+  thread_local MatchScratch scratch;
+  return get_rules_ids(variables_map, scratch);
+}
+
+// A rule matches when all its preconditions are fired; each fired (variable, membership index) pair increments the
+// counters of the rules from its posting list, so the rule matches when its counter reaches its preconditions count
+auto RulesSet::get_rules_ids(const RuleTestingValues& variables_map, MatchScratch& scratch) const -> std::vector<std::size_t> {
+  const auto rules_count = get_rules_count();
+  if (scratch.hits.size() < rules_count) {
+    scratch.hits.resize(rules_count, 0);
+  }
+  const std::span hits{scratch.hits};
+  auto& fired = scratch.fired;
+  fired.clear();
+  std::vector<std::size_t> matched{unconditional_rules};
+  for (const auto& [variable, crisp_value] : variables_map) {
+    const auto* postings = get_postings(variable);
+    if (postings == nullptr) {
+      continue;
+    }
+    const Membership memberships = variable.get_membership(crisp_value);
     for (const auto& member : memberships) {
-      output_map.insert(std::pair{variable.first, member.first});
+      if (member.first >= postings->size()) {
+        continue;
+      }
+      const std::span<const std::size_t> posting{(*postings)[member.first]};
+      fired.push_back(posting);
+      for (const auto rule_id : posting) {
+        if (++hits[rule_id] == preconditions_count[rule_id]) {
+          matched.push_back(rule_id);
+        }
+      }
+    }
+  }
+  // The counters are left at zero for the next call: those of the visited posting lists only, or all of them at once
+  // when the lists cover a large part of the rules, as sequential writes cost less than scattered ones
+  std::size_t visited = 0;
+  for (const auto posting : fired) {
+    visited += posting.size();
+  }
+  if (visited > rules_count / scattered_reset_ratio) {
+    std::ranges::fill(hits.first(rules_count), 0);
+  } else {
+    for (const auto posting : fired) {
+      for (const auto rule_id : posting) {
+        hits[rule_id] = 0;
+      }
     }
   }
-  return get_matching_rules(this->rules, output_map);
+  std::ranges::sort(matched);
+  return matched;
+}
+
+auto RulesSet::get_rules(const RuleTestingValues& variables_map) const -> std::vector<Rule> {
+  const auto& rules = get_all_rules();
+  return get_rules_ids(variables_map) | std::views::transform([&rules](const auto rule_id) { return rules[rule_id]; }) |
+         std::ranges::to<std::vector<Rule>>();
+}
+
+// The rules added by their ids are built once, by the first call of any thread
+auto RulesSet::get_all_rules() const -> const std::vector<Rule>& {
+  static const std::vector<Rule> no_rules;
+  if (rules_cache == nullptr) {
+    return no_rules;
+  }
+  auto& cache = *rules_cache;
+  if (cache.built.load(std::memory_order_acquire) < get_rules_count()) {
+    const std::scoped_lock lock{cache.mutex};
+    cache.rules.reserve(get_rules_count());
+    for (auto rule_id = cache.rules.size(); rule_id < get_rules_count(); ++rule_id) {
+      cache.rules.push_back(make_rule(rule_id));
+    }
+    cache.built.store(cache.rules.size(), std::memory_order_release);
+  }
+  return cache.rules;
+}
+
+auto RulesSet::get_postings(const FuzzyVarUnion& variable) const -> const RulesPostings* {
+  // Ids alias across the rules sets, so a variable of another one gets no postings instead of those of its id
+  if (not contains(variable) || variable.get_id() >= rules_index.size() || rules_index[variable.get_id()].empty()) {
+    return nullptr;
+  }
+  return &rules_index[variable.get_id()];
+}
+
+auto RulesSet::get_dense_grid() const -> std::optional<DenseRulesGrid> {
+  if (get_rules_count() == 0 || not unconditional_rules.empty()) {
+    return std::nullopt;
+  }
+  DenseRulesGrid grid;
+  std::vector<std::size_t> terms;
+  std::size_t cells = 1;
+  // Preconditions are ordered by the variables ids, so are the axes
+  for (const auto& precondition : get_rule_preconditions(0)) {
+    const auto variable_terms = input_variables[precondition.variable_id].get_points().size();
+    if (variable_terms < 2 || cells > DenseRulesGrid::max_cells / variable_terms) {
+      return std::nullopt;
+    }
+    grid.variables.push_back(precondition.variable_id);
+    terms.push_back(variable_terms);
+    cells *= variable_terms;
+  }
+  grid.strides.resize(terms.size());
+  std::exclusive_scan(terms.rbegin(), terms.rend(), grid.strides.rbegin(), std::size_t{1}, std::multiplies{});
+  grid.cells.assign(cells, DenseRulesGrid::no_rule);
+
+  for (std::size_t rule_id = 0; rule_id < get_rules_count(); ++rule_id) {
+    const auto rule_preconditions = get_rule_preconditions(rule_id);
+    if (rule_preconditions.size() != grid.variables.size()) {
+      return std::nullopt;
+    }
+    std::size_t cell = 0;
+    std::size_t axis = 0;
+    for (const auto& [variable_id, membership_index] : rule_preconditions) {
+      if (variable_id != grid.variables[axis] || membership_index >= terms[axis]) {
+        return std::nullopt;
+      }
+      cell += membership_index * grid.strides[axis++];
+    }
+    if (grid.cells[cell] != DenseRulesGrid::no_rule) {
+      return std::nullopt;
+    }
+    grid.cells[cell] = rule_id;
+    ++grid.filled;
+  }
+  return grid;
+}
+
+// Ids are dense indices within a rules set, so the name check rejects variables of another rules set
+auto RulesSet::contains(const FuzzyVarUnion& variable) const -> bool {
+  return variable.get_id() < input_variables.size() && input_variables[variable.get_id()].get_name() == variable.get_name();
+}
+
+auto RulesSet::get_conclusions() const -> std::vector<ConclusionChosen> {
+  std::vector<ConclusionChosen> conclusions;
+  for (const auto& [name, categories] : output_variables) {
+    for (const auto& category : categories) {
+      conclusions.push_back({name, category});
+    }
+  }
+  std::sort(conclusions.begin(), conclusions.end());
+  return conclusions;
 }
 
 auto RulesSet::get_input_variables_labels() const -> std::vector<std::string> {
@@ -59,11 +327,43 @@ auto RulesSet::get_input_variables_labels() const -> std::vector<std::string> {
          std::ranges::to<std::vector<std::string>>();
 };
 
-auto Rule::get_preconditions() const -> std::map<FuzzyVarMembership::MembershipKey, FuzzyVarMembership::MembershipIndex> {
+void BatchInputs::add_column(const fuzzyrulesml::rules::FuzzyVarUnion& fuzzy_variable, std::span<const double> column) {
+  if (not columns.empty() && column.size() != rows) {
+    throw std::runtime_error("Column length differs from the batch rows count");
+  }
+  if (std::ranges::find(variables, fuzzy_variable) != variables.end()) {
+    throw std::runtime_error("Input variable already in the batch");
+  }
+  variables.push_back(fuzzy_variable);
+  columns.push_back(column);
+  rows = column.size();
+}
+
+auto BatchInputs::slice(std::size_t first, std::size_t count) const -> BatchInputs {
+  if (first + count > rows) {
+    throw std::runtime_error("Slice out of the batch rows");
+  }
+  BatchInputs sliced;
+  sliced.variables = variables;
+  sliced.columns = columns | std::views::transform([first, count](const auto& column) { return column.subspan(first, count); }) |
+                   std::ranges::to<std::vector<std::span<const double>>>();
+  sliced.rows = count;
+  return sliced;
+}
+
+ParametersBinding::ParametersBinding(const BatchInputs& inputs) : offsets{0} {
+  for (const auto& variable : inputs.get_variables()) {
+    const auto points = variable.get_points();
+    parameters.insert(parameters.end(), points.begin(), points.end());
+    offsets.push_back(parameters.size());
+  }
+}
+
+auto Rule::get_preconditions() const -> const std::map<FuzzyVarMembership::MembershipKey, FuzzyVarMembership::MembershipIndex>& {
   return preconditions;
 }
 
-auto Rule::get_conclusion() const -> ConclusionChosen { return conclusion; }
+auto Rule::get_conclusion() const -> const ConclusionChosen& { return conclusion; }
 
 auto Conclusion::get_name() const -> std::string { return name; }
 
@@ -94,18 +394,10 @@ auto FuzzyVarMembership::operator<(const FuzzyVarMembership& other) const -> boo
   return membership_index < other.membership_index; // If names are equal, compare by item
 };
 
-auto FuzzyVarUnion::operator<(const FuzzyVarUnion& other) const -> bool {
-  return this->payload.index() < other.payload.index() ||
-         (this->payload.index() == other.payload.index() &&
-          std::visit([](const auto& lhs, const auto& rhs) { return lhs.compare(rhs); }, this->payload, other.payload));
-};
-
-auto FuzzyVarUnion::operator==(const FuzzyVarUnion& other) const -> bool { return this->payload == other.payload; }
-
 auto FuzzyVarUnion::to_string() const -> std::string {
   return std::visit([](const auto& var) { return var.get_name(); }, this->payload);
 }
-auto FuzzyVarUnion::get_name() const -> std::string {
-  return std::visit([](const auto& var) { return var.get_name(); }, this->payload);
+auto FuzzyVarUnion::get_name() const -> const std::string& {
+  return std::visit([](const auto& var) -> const std::string& { return var.get_name(); }, this->payload);
 }
 } // namespace fuzzyrulesml::rules
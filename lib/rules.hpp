@@ -2,14 +2,22 @@
 
 #include "variable.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <format>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <ranges>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -20,17 +28,33 @@ using ConclusionItem = std::string;
 // mapping to the memebreship functions
 class FuzzyVarUnion {
 public:
-  template <typename VARIABLE_TYPE> FuzzyVarUnion(const FuzzyVariable<VARIABLE_TYPE>& variable) : payload(variable){};
-  template <typename VARIABLE_TYPE> FuzzyVarUnion(FuzzyVariable<VARIABLE_TYPE>&& variable) : payload(std::move(variable)){};
+  template <typename VARIABLE_TYPE>
+  FuzzyVarUnion(const FuzzyVariable<VARIABLE_TYPE>& variable) : id(variable.get_id()), payload(variable){};
+  template <typename VARIABLE_TYPE>
+  FuzzyVarUnion(FuzzyVariable<VARIABLE_TYPE>&& variable) : id(variable.get_id()), payload(std::move(variable)){};
   [[nodiscard]] auto get_membership(const auto val) const -> Membership {
     return std::visit([val](const auto& var) { return var.operator()(val).get_membership(); }, this->payload);
   }
-  [[nodiscard]] auto operator<(const FuzzyVarUnion& other) const -> bool;
-  [[nodiscard]] auto operator==(const FuzzyVarUnion& other) const -> bool;
+  void fuzzify(std::span<const double> values, std::span<std::uint32_t> segments, std::span<double> degrees) const {
+    std::visit([&](const auto& var) { var.fuzzify(values, segments, degrees); }, this->payload);
+  }
+  void fuzzify(std::span<const double> points, std::span<const double> values, std::span<std::uint32_t> segments,
+               std::span<double> degrees) const {
+    std::visit([&](const auto& var) { var.fuzzify(points, values, segments, degrees); }, this->payload);
+  }
+  [[nodiscard]] auto get_points() const -> std::vector<double> {
+    return std::visit([](const auto& var) { return var.get_points(); }, this->payload);
+  }
+  // Variables are ordered and compared by their ids only, without visiting the payload
+  [[nodiscard]] auto operator<(const FuzzyVarUnion& other) const -> bool { return id < other.id; }
+  [[nodiscard]] auto operator==(const FuzzyVarUnion& other) const -> bool { return id == other.id; }
   [[nodiscard]] auto to_string() const -> std::string;
-  [[nodiscard]] auto get_name() const -> std::string;
+  [[nodiscard]] auto get_name() const -> const std::string&;
+  [[nodiscard]] auto get_id() const -> std::size_t { return id; }
+  [[nodiscard]] auto is_integer() const -> bool { return std::holds_alternative<FuzzyVariable<int>>(payload); }
 
 private:
+  std::size_t id;
   std::variant<FuzzyVariable<double>, FuzzyVariable<int>> payload;
 };
 
@@ -67,8 +91,10 @@ public:
   Rule(const std::map<FuzzyVarMembership::MembershipKey, FuzzyVarMembership::MembershipIndex>& preconditions,
        const ConclusionChosen& conclusion)
       : preconditions{preconditions}, conclusion{conclusion} {};
-  [[nodiscard]] auto get_preconditions() const -> std::map<FuzzyVarMembership::MembershipKey, FuzzyVarMembership::MembershipIndex>;
-  [[nodiscard]] auto get_conclusion() const -> ConclusionChosen;
+  Rule(std::map<FuzzyVarMembership::MembershipKey, FuzzyVarMembership::MembershipIndex>&& preconditions, ConclusionChosen&& conclusion)
+      : preconditions{std::move(preconditions)}, conclusion{std::move(conclusion)} {};
+  [[nodiscard]] auto get_preconditions() const -> const std::map<FuzzyVarMembership::MembershipKey, FuzzyVarMembership::MembershipIndex>&;
+  [[nodiscard]] auto get_conclusion() const -> const ConclusionChosen&;
 
 private:
   std::map<FuzzyVarMembership::MembershipKey, FuzzyVarMembership::MembershipIndex> preconditions;
@@ -92,6 +118,7 @@ public:
       : crisp_values(std::move(crisp_value)) {}
   [[nodiscard]] auto begin() const { return crisp_values.begin(); }
   [[nodiscard]] auto end() const { return crisp_values.end(); }
+  [[nodiscard]] auto find(const fuzzyrulesml::rules::FuzzyVarUnion& fuzzy_variable) const { return crisp_values.find(fuzzy_variable); }
   void add(fuzzyrulesml::rules::FuzzyVarUnion&& fuzzy_value,
            fuzzyrulesml::rules::CrispValuesUnion&&
                crisp_value); // NOLINT(performance-move-const-arg): CrispValuesUnion variables might be more complex in the future
@@ -101,32 +128,215 @@ private:
   std::map<fuzzyrulesml::rules::FuzzyVarUnion, fuzzyrulesml::rules::CrispValuesUnion> crisp_values;
 };
 
+// BatchInputs is a column-major matrix of crisp values: one contiguous column per input variable, all of the same
+// length; it is an input for evaluation of the rules for many samples at once
+class BatchInputs {
+public:
+  void add_column(const fuzzyrulesml::rules::FuzzyVarUnion& fuzzy_variable, std::span<const double> column);
+  // Batch of the rows [first, first + count) of this one, sharing the columns
+  [[nodiscard]] auto slice(std::size_t first, std::size_t count) const -> BatchInputs;
+  [[nodiscard]] auto get_rows() const -> std::size_t { return rows; }
+  [[nodiscard]] auto get_variables() const -> const std::vector<fuzzyrulesml::rules::FuzzyVarUnion>& { return variables; }
+  [[nodiscard]] auto get_columns() const -> const std::vector<std::span<const double>>& { return columns; }
+
+private:
+  std::vector<fuzzyrulesml::rules::FuzzyVarUnion> variables;
+  std::vector<std::span<const double>> columns;
+  std::size_t rows{0};
+};
+
+// ParametersBinding is a flat vector of the characteristic points of all the batch input variables, laid out in the
+// columns order; the batch reasoning can take these points instead of the ones carried by the variables, so an
+// optimizer can write a candidate in place and rescore the same batch without copying the variables or the reasoner
+class ParametersBinding {
+public:
+  explicit ParametersBinding(const BatchInputs& inputs);
+  [[nodiscard]] auto get_parameters() -> std::span<double> { return parameters; }
+  [[nodiscard]] auto get_parameters() const -> std::span<const double> { return parameters; }
+  [[nodiscard]] auto size() const -> std::size_t { return parameters.size(); }
+  [[nodiscard]] auto get_columns_count() const -> std::size_t { return offsets.size() - 1; }
+  // Characteristic points of the column variable within a parameters vector of this binding layout
+  [[nodiscard]] auto get_points(std::span<const double> candidate, std::size_t column) const -> std::span<const double> {
+    return candidate.subspan(offsets[column], offsets[column + 1] - offsets[column]);
+  }
+
+private:
+  std::vector<double> parameters;
+  std::vector<std::size_t> offsets;
+};
+
+// DenseRulesGrid lays a rules set out over the Cartesian grid of the terms of the variables its rules test: a flat
+// row-major array, with the axes in the variables ids order, holding the rule id of each cell (no_rule for the empty
+// cells), so the rules fired by a sample are the 2^k cells around its segments, k being the number of the axes. See
+// RulesSet::get_dense_grid
+class DenseRulesGrid {
+public:
+  static constexpr std::size_t no_rule = std::numeric_limits<std::size_t>::max();
+  // Limit of the cells count, so the grid of many variables does not exhaust the memory
+  static constexpr std::size_t max_cells = std::size_t{1} << 24U;
+
+  // Ids of the variables of the axes
+  [[nodiscard]] auto get_variables() const -> const std::vector<std::size_t>& { return variables; }
+  [[nodiscard]] auto get_strides() const -> const std::vector<std::size_t>& { return strides; }
+  [[nodiscard]] auto get_cells() const -> const std::vector<std::size_t>& { return cells; }
+  // Number of the cells holding a rule
+  [[nodiscard]] auto get_filled() const -> std::size_t { return filled; }
+
+private:
+  friend class RulesSet;
+  std::vector<std::size_t> variables;
+  std::vector<std::size_t> strides;
+  std::vector<std::size_t> cells;
+  std::size_t filled{0};
+};
+
+// RulePrecondition is a precondition of a rule by the id of its variable and the term, the index of a membership
+// function of the variable
+struct RulePrecondition {
+  std::uint32_t variable_id;
+  std::uint32_t term;
+};
+
 class RulesSet {
 public:
+  // Posting lists of a single input variable: ids of the rules using each of its membership function indices
+  using RulesPostings = std::vector<std::vector<std::size_t>>;
+
+  // Scratch of the rules hits counters of get_rules_ids, reused across the calls, e.g. of any rules sets on a thread
+  class MatchScratch {
+  private:
+    friend class RulesSet;
+    // Hits of the rules, all zero between the calls
+    std::vector<std::size_t> hits;
+    // Posting lists visited by the current call, whose counters it resets
+    std::vector<std::span<const std::size_t>> fired;
+  };
+
   template <typename VARIABLE_TYPE>
   auto add_input_variable(std::string_view name, initial_distribution::Uniform<VARIABLE_TYPE> dist) -> FuzzyVariable<VARIABLE_TYPE>;
+  // Input variable of the given characteristic points, e.g. of a rules set read from a file
+  template <typename VARIABLE_TYPE>
+  auto add_input_variable(std::string_view name, const std::vector<double>& points) -> FuzzyVariable<VARIABLE_TYPE>;
   [[nodiscard]] auto add_output_variable(std::string_view name, std::vector<std::string> categories) -> Conclusion;
 
   void add_rule(const std::map<FuzzyVarUnion, std::size_t>& variables_map, const ConclusionChosen& conclusion);
+  // Adds a rule of the flat (variable id, term) pairs by the increasing ids: the variables are taken by their ids
+  // instead of being looked up, and the posting lists are indexed straight from the pairs
+  void add_rule_by_ids(std::span<const std::uint32_t> precondition_pairs, const ConclusionChosen& conclusion);
+  // Adds the rules of flat arrays, e.g. of a binary rules set: the (variable id, term) pairs of all the rules, by the
+  // increasing ids within a rule, the preconditions count of each rule, and its conclusion as an index of
+  // get_conclusions_table. The arrays are validated at once, then the rules are stored without building their Rule
+  // objects, see get_all_rules; nothing is added when they are invalid
+  void add_rules_by_ids(std::span<const std::uint32_t> precondition_pairs, std::span<const std::uint32_t> preconditions_counts,
+                        std::span<const std::uint32_t> conclusions);
   [[nodiscard]] auto get_rules(const RuleTestingValues& variables_map) const -> std::vector<Rule>;
+  // Ids of the rules get_rules returns, indices into get_all_rules; the hits counters are kept in a scratch of the
+  // calling thread instead of being allocated for all the rules on each call
+  [[nodiscard]] auto get_rules_ids(const RuleTestingValues& variables_map) const -> std::vector<std::size_t>;
+  [[nodiscard]] auto get_rules_ids(const RuleTestingValues& variables_map, MatchScratch& scratch) const -> std::vector<std::size_t>;
+  // The rules with the maps of their preconditions, built on the first call after the rules were added by their ids;
+  // the copies of the rules set share them until one of them adds a rule. The rules are also available without the
+  // maps, see get_rules_count, get_rule_preconditions and get_rule_conclusion
+  [[nodiscard]] auto get_all_rules() const -> const std::vector<Rule>&;
+  [[nodiscard]] auto get_rules_count() const -> std::size_t { return rules_conclusions.size(); }
+  // Preconditions of the rule by the increasing variables ids
+  [[nodiscard]] auto get_rule_preconditions(std::size_t rule_id) const -> std::span<const RulePrecondition> {
+    return std::span{preconditions}.subspan(preconditions_offsets[rule_id], preconditions_count[rule_id]);
+  }
+  [[nodiscard]] auto get_rule_conclusion(std::size_t rule_id) const -> const ConclusionChosen& {
+    return conclusions_table[rules_conclusions[rule_id]];
+  }
+  // Index of the rule conclusion in get_conclusions_table
+  [[nodiscard]] auto get_rule_conclusion_id(std::size_t rule_id) const -> std::uint32_t { return rules_conclusions[rule_id]; }
+  // Labels of the input variables in their ids order
   [[nodiscard]] auto get_input_variables_labels() const -> std::vector<std::string>;
+  // Input variables in their ids order
+  [[nodiscard]] auto get_input_variables() const -> const std::vector<FuzzyVarUnion>& { return input_variables; }
+  // Categories of the output variables by their names
+  [[nodiscard]] auto get_output_variables() const -> const std::map<std::string, std::vector<std::string>>& { return output_variables; }
+  // All the output variables categories, ordered as ConclusionChosen::operator< does
+  [[nodiscard]] auto get_conclusions() const -> std::vector<ConclusionChosen>;
+  // All the output variables categories in the order of their addition, indexed by the conclusions of add_rules_by_ids
+  [[nodiscard]] auto get_conclusions_table() const -> const std::vector<ConclusionChosen>& { return conclusions_table; }
+
+  // Whether the variable is the input variable of its id in this rules set, not the one of another rules set
+  [[nodiscard]] auto contains(const FuzzyVarUnion& variable) const -> bool;
+  // Posting lists of the variable terms, nullptr when no rule tests it or the rules set does not contain it
+  [[nodiscard]] auto get_postings(const FuzzyVarUnion& variable) const -> const RulesPostings*;
+  [[nodiscard]] auto get_preconditions_count(std::size_t rule_id) const -> std::size_t { return preconditions_count[rule_id]; }
+  [[nodiscard]] auto get_unconditional_rules() const -> const std::vector<std::size_t>& { return unconditional_rules; }
+  // Dense grid of the rules, when all of them test the same variables, each cell by one rule at most, and the grid is
+  // not larger than DenseRulesGrid::max_cells; the grid might be partially filled
+  [[nodiscard]] auto get_dense_grid() const -> std::optional<DenseRulesGrid>;
 
 private:
-  std::set<FuzzyVarUnion> input_variables;
+  // RulesIndex maps each variable id and its membership function index to the ids of the rules using that pair as a
+  // precondition (posting lists); it is updated in add_rule, so get_rules only visits rules of the fired terms
+  using RulesIndex = std::vector<RulesPostings>;
+  // Rule objects of the first rules, built of them being complete; the mutex guards building the others
+  struct RulesCache {
+    std::mutex mutex;
+    std::atomic<std::size_t> built{0};
+    std::vector<Rule> rules;
+  };
+  // Adds a rule of the validated preconditions stored from the offset on, without its Rule object
+  void store_rule(std::size_t offset, std::size_t count, std::uint32_t conclusion);
+  void index_precondition(std::size_t variable_id, std::size_t membership_index, std::size_t rule_id);
+  [[nodiscard]] auto find_conclusion(const ConclusionChosen& conclusion) const -> std::uint32_t;
+  // Cache of this rules set only, so the rules being added do not change the ones of its copies
+  [[nodiscard]] auto get_own_rules_cache() -> RulesCache&;
+  [[nodiscard]] auto make_rule(std::size_t rule_id) const -> Rule;
+  template <typename VARIABLE_TYPE> auto emplace_input_variable(FuzzyVariable<VARIABLE_TYPE>&& created_variable) -> FuzzyVariable<VARIABLE_TYPE>;
+
+  // Input variables indexed by their ids
+  std::vector<FuzzyVarUnion> input_variables;
   std::map<std::string, std::vector<std::string>> output_variables;
-  std::vector<Rule> rules;
+  std::vector<ConclusionChosen> conclusions_table;
+  // Rules as the flat preconditions of all of them, the first precondition and the count of each, and the index of its
+  // conclusion in the conclusions table
+  std::vector<RulePrecondition> preconditions;
+  std::vector<std::size_t> preconditions_offsets;
+  std::vector<std::size_t> preconditions_count;
+  std::vector<std::uint32_t> rules_conclusions;
+  RulesIndex rules_index;
+  std::vector<std::size_t> unconditional_rules;
+  std::shared_ptr<RulesCache> rules_cache{std::make_shared<RulesCache>()};
 };
 
+// Reference implementation of the rules matching: linear scan over all the rules, checking each precondition against
+// all fired (variable, membership index) pairs; RulesSet::get_rules uses the compiled index instead
+[[nodiscard]] auto get_matching_rules(const std::vector<Rule>& rules, const std::multimap<FuzzyVarUnion, std::size_t>& variables_map)
+    -> std::vector<Rule>;
+
 template <typename VARIABLE_TYPE>
 auto RulesSet::add_input_variable(std::string_view variable_name,
                                   initial_distribution::Uniform<VARIABLE_TYPE> distribution) -> FuzzyVariable<VARIABLE_TYPE> {
-  const auto found = std::ranges::find(input_variables, variable_name, [](auto const& variable) { return variable.get_name(); });
+  return emplace_input_variable(FuzzyVariable<typename initial_distribution::Uniform<VARIABLE_TYPE>::UnderlyingType>(
+      variable_name, distribution, input_variables.size()));
+}
+
+template <typename VARIABLE_TYPE>
+auto RulesSet::add_input_variable(std::string_view variable_name, const std::vector<double>& points) -> FuzzyVariable<VARIABLE_TYPE> {
+  if (points.size() < 2) {
+    throw std::runtime_error("Invalid number of characteristic points");
+  }
+  FuzzyVariable<VARIABLE_TYPE> created_variable{
+      variable_name,
+      initial_distribution::Uniform<VARIABLE_TYPE>(static_cast<VARIABLE_TYPE>(points.front()), static_cast<VARIABLE_TYPE>(points.back()), points.size()),
+      input_variables.size()};
+  created_variable.set_points(points);
+  return emplace_input_variable(std::move(created_variable));
+}
+
+template <typename VARIABLE_TYPE> auto RulesSet::emplace_input_variable(FuzzyVariable<VARIABLE_TYPE>&& created_variable) -> FuzzyVariable<VARIABLE_TYPE> {
+  const auto found = std::ranges::find(input_variables, std::string_view{created_variable.get_name()},
+                                       [](auto const& variable) -> std::string_view { return variable.get_name(); });
   if (found != input_variables.end()) {
     throw std::runtime_error("Input variable already exists");
   }
-  auto created_variable = FuzzyVariable<typename initial_distribution::Uniform<VARIABLE_TYPE>::UnderlyingType>(variable_name, distribution);
-  input_variables.emplace(created_variable);
-  return created_variable;
+  input_variables.emplace_back(created_variable);
+  rules_index.emplace_back();
+  return std::move(created_variable);
 }
 } // namespace fuzzyrulesml::rules
 
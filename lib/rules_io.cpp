@@ -0,0 +1,336 @@
+#include "rules_io.hpp"
+#include "binary_dataset.hpp"
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace fuzzyrulesml::rules {
+namespace {
+static_assert(std::endian::native == std::endian::little, "The binary rules format is little endian");
+
+auto is_word(std::string_view name) -> bool {
+  return not name.empty() && name.find_first_of(" \t\r\n=#") == std::string_view::npos;
+}
+
+auto get_word(std::string_view name) -> std::string_view {
+  if (not is_word(name)) {
+    throw std::runtime_error(std::format("Name \"{}\" is not a single word of the rules text format", name));
+  }
+  return name;
+}
+
+// Index of each conclusion in the categories of all the outputs, in the output variables order
+auto get_conclusions_indices(const RulesSet& rules_set) -> std::map<ConclusionChosen, std::uint32_t> {
+  std::map<ConclusionChosen, std::uint32_t> indices;
+  std::uint32_t index = 0;
+  for (const auto& [name, categories] : rules_set.get_output_variables()) {
+    for (const auto& category : categories) {
+      indices.emplace(ConclusionChosen{name, category}, index++);
+    }
+  }
+  return indices;
+}
+
+auto parse_number(std::string_view token, std::size_t line_number) -> double {
+  double value{};
+  const auto [end, error] = std::from_chars(token.data(), std::next(token.data(), static_cast<std::ptrdiff_t>(token.size())), value);
+  if (error != std::errc{} || end != std::next(token.data(), static_cast<std::ptrdiff_t>(token.size()))) {
+    throw std::runtime_error(std::format("Invalid number \"{}\" in the rules text line {}", token, line_number));
+  }
+  return value;
+}
+
+// Term of a precondition, a membership function index: decimal digits only, so fractions, signs and NaN are rejected
+auto parse_term(std::string_view token, std::size_t line_number) -> std::size_t {
+  std::size_t value{};
+  const auto [end, error] = std::from_chars(token.data(), std::next(token.data(), static_cast<std::ptrdiff_t>(token.size())), value);
+  if (error != std::errc{} || end != std::next(token.data(), static_cast<std::ptrdiff_t>(token.size()))) {
+    throw std::runtime_error(std::format("Invalid term \"{}\" in the rules text line {}", token, line_number));
+  }
+  return value;
+}
+
+// Splits the "<name>=<value>" token
+auto split_assignment(std::string_view token, std::size_t line_number) -> std::pair<std::string_view, std::string_view> {
+  const auto separator = token.find('=');
+  if (separator == std::string_view::npos || separator == 0 || separator + 1 == token.size()) {
+    throw std::runtime_error(std::format("Invalid assignment \"{}\" in the rules text line {}", token, line_number));
+  }
+  return {token.substr(0, separator), token.substr(separator + 1)};
+}
+
+class RulesWriter {
+public:
+  explicit RulesWriter(const std::string& file) : output{file, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc} {
+    if (not output.is_open()) {
+      throw std::runtime_error(std::format("Cannot open the file {}", file));
+    }
+  }
+  template <typename VALUE> void write(const VALUE& value) { write_bytes(std::as_bytes(std::span{&value, 1})); }
+  template <typename VALUE> void write(std::span<const VALUE> values) { write_bytes(std::as_bytes(values)); }
+  void write(std::string_view value) {
+    write(get_count(value.size()));
+    write_bytes(std::as_bytes(std::span{value}));
+  }
+  void close() {
+    output.close();
+    if (output.fail()) {
+      throw std::runtime_error("Cannot write the binary rules set");
+    }
+  }
+  [[nodiscard]] static auto get_count(std::size_t count) -> std::uint32_t {
+    if (count > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::runtime_error("Too large rules set for the binary format");
+    }
+    return static_cast<std::uint32_t>(count);
+  }
+
+private:
+  void write_bytes(std::span<const std::byte> bytes) {
+    output.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+
+  std::ofstream output;
+};
+
+// Reads the mapped bytes, checking each read against the file size
+class RulesReader {
+public:
+  explicit RulesReader(std::span<const std::byte> bytes) : bytes{bytes} {}
+  template <typename VALUE> auto read() -> VALUE {
+    VALUE value{};
+    std::memcpy(&value, take(sizeof(VALUE)).data(), sizeof(VALUE));
+    return value;
+  }
+  // The arrays are copied out, as the mapping does not align them
+  template <typename VALUE> auto read_array(std::uint64_t count) -> std::vector<VALUE> {
+    if (count > (bytes.size() - offset) / sizeof(VALUE)) {
+      throw std::runtime_error("Truncated binary rules set");
+    }
+    std::vector<VALUE> values(count);
+    std::memcpy(values.data(), take(count * sizeof(VALUE)).data(), count * sizeof(VALUE));
+    return values;
+  }
+  auto read_string() -> std::string {
+    const auto length = read<std::uint32_t>();
+    const auto characters = take(length);
+    return {reinterpret_cast<const char*>(characters.data()), characters.size()}; // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+  [[nodiscard]] auto is_finished() const -> bool { return offset == bytes.size(); }
+
+private:
+  auto take(std::size_t count) -> std::span<const std::byte> {
+    if (count > bytes.size() - offset) {
+      throw std::runtime_error("Truncated binary rules set");
+    }
+    const auto taken = bytes.subspan(offset, count);
+    offset += count;
+    return taken;
+  }
+
+  std::span<const std::byte> bytes;
+  std::size_t offset{0};
+};
+} // namespace
+
+void write_rules_text(const RulesSet& rules_set, std::ostream& output) {
+  for (const auto& variable : rules_set.get_input_variables()) {
+    output << std::format("input {} {}", get_word(variable.get_name()), variable.is_integer() ? "int" : "double");
+    for (const auto point : variable.get_points()) {
+      output << std::format(" {}", point);
+    }
+    output << '\n';
+  }
+  for (const auto& [name, categories] : rules_set.get_output_variables()) {
+    output << std::format("output {}", get_word(name));
+    for (const auto& category : categories) {
+      output << std::format(" {}", get_word(category));
+    }
+    output << '\n';
+  }
+  const auto& variables = rules_set.get_input_variables();
+  for (std::size_t rule_id = 0; rule_id < rules_set.get_rules_count(); ++rule_id) {
+    output << "rule";
+    for (const auto& [variable_id, term] : rules_set.get_rule_preconditions(rule_id)) {
+      output << std::format(" {}={}", variables[variable_id].get_name(), term);
+    }
+    const auto& conclusion = rules_set.get_rule_conclusion(rule_id);
+    output << std::format(" -> {}={}\n", conclusion.name, conclusion.item);
+  }
+}
+
+auto read_rules_text(std::istream& input) -> RulesSet {
+  RulesSet rules_set;
+  std::unordered_map<std::string, FuzzyVarUnion> variables;
+  std::string line;
+  std::size_t line_number = 0;
+  while (std::getline(input, line)) {
+    ++line_number;
+    std::istringstream tokens{line.substr(0, line.find('#'))};
+    std::string keyword;
+    if (not(tokens >> keyword)) {
+      continue;
+    }
+    std::string name;
+    if (keyword == "input") {
+      std::string type;
+      if (not(tokens >> name >> type) || (type != "double" && type != "int")) {
+        throw std::runtime_error(std::format("Invalid input declaration in the rules text line {}", line_number));
+      }
+      std::vector<double> points;
+      for (std::string token; tokens >> token;) {
+        points.push_back(parse_number(token, line_number));
+      }
+      auto variable = type == "int" ? FuzzyVarUnion{rules_set.add_input_variable<int>(name, points)}
+                                    : FuzzyVarUnion{rules_set.add_input_variable<double>(name, points)};
+      variables.emplace(name, std::move(variable));
+    } else if (keyword == "output") {
+      if (not(tokens >> name)) {
+        throw std::runtime_error(std::format("Invalid output declaration in the rules text line {}", line_number));
+      }
+      std::vector<std::string> categories;
+      for (std::string category; tokens >> category;) {
+        categories.push_back(category);
+      }
+      static_cast<void>(rules_set.add_output_variable(name, std::move(categories)));
+    } else if (keyword == "rule") {
+      std::map<FuzzyVarUnion, std::size_t> preconditions;
+      std::string token;
+      while (tokens >> token && token != "->") {
+        const auto [variable_name, term] = split_assignment(token, line_number);
+        const auto found = variables.find(std::string{variable_name});
+        if (found == variables.end()) {
+          throw std::runtime_error(std::format("Unknown input \"{}\" in the rules text line {}", variable_name, line_number));
+        }
+        preconditions.emplace(found->second, parse_term(term, line_number));
+      }
+      if (token != "->" || not(tokens >> token)) {
+        throw std::runtime_error(std::format("Missing conclusion in the rules text line {}", line_number));
+      }
+      const auto [output_name, category] = split_assignment(token, line_number);
+      rules_set.add_rule(preconditions, {std::string{output_name}, std::string{category}});
+    } else {
+      throw std::runtime_error(std::format("Unknown declaration \"{}\" in the rules text line {}", keyword, line_number));
+    }
+  }
+  return rules_set;
+}
+
+void write_rules_binary(const RulesSet& rules_set, const std::string& file) {
+  const auto rules_count = rules_set.get_rules_count();
+  // The conclusions of the rules set are indexed in the order of the outputs addition, those of the file in their order
+  const auto conclusions_indices = get_conclusions_indices(rules_set);
+  const auto file_conclusions =
+      rules_set.get_conclusions_table() |
+      std::views::transform([&conclusions_indices](const auto& conclusion) { return conclusions_indices.at(conclusion); }) |
+      std::ranges::to<std::vector<std::uint32_t>>();
+  std::vector<std::uint32_t> conclusions;
+  std::vector<std::uint32_t> preconditions_counts;
+  std::vector<std::uint32_t> preconditions;
+  for (std::size_t rule_id = 0; rule_id < rules_count; ++rule_id) {
+    const auto rule_preconditions = rules_set.get_rule_preconditions(rule_id);
+    conclusions.push_back(file_conclusions[rules_set.get_rule_conclusion_id(rule_id)]);
+    preconditions_counts.push_back(RulesWriter::get_count(rule_preconditions.size()));
+    for (const auto& [variable_id, term] : rule_preconditions) {
+      preconditions.push_back(variable_id);
+      preconditions.push_back(term);
+    }
+  }
+
+  RulesWriter writer{file};
+  writer.write(std::as_bytes(std::span{rules_format::magic}));
+  writer.write(rules_format::version);
+  writer.write(RulesWriter::get_count(rules_set.get_input_variables().size()));
+  writer.write(RulesWriter::get_count(rules_set.get_output_variables().size()));
+  writer.write(static_cast<std::uint64_t>(rules_count));
+  writer.write(static_cast<std::uint64_t>(preconditions.size() / 2));
+  for (const auto& variable : rules_set.get_input_variables()) {
+    const auto points = variable.get_points();
+    writer.write(std::string_view{variable.get_name()});
+    writer.write(variable.is_integer() ? rules_format::VariableType::int32 : rules_format::VariableType::float64);
+    writer.write(RulesWriter::get_count(points.size()));
+    writer.write(std::span<const double>{points});
+  }
+  for (const auto& [name, categories] : rules_set.get_output_variables()) {
+    writer.write(std::string_view{name});
+    writer.write(RulesWriter::get_count(categories.size()));
+    for (const auto& category : categories) {
+      writer.write(std::string_view{category});
+    }
+  }
+  writer.write(std::span<const std::uint32_t>{conclusions});
+  writer.write(std::span<const std::uint32_t>{preconditions_counts});
+  writer.write(std::span<const std::uint32_t>{preconditions});
+  writer.close();
+}
+
+auto read_rules_binary(const std::string& file) -> RulesSet {
+  const fuzzyrulesml::dataset::MappedFile mapping{file};
+  RulesReader reader{mapping.get_bytes()};
+  std::array<char, rules_format::magic.size()> magic{};
+  for (auto& character : magic) {
+    character = reader.read<char>();
+  }
+  if (std::string_view{magic.data(), magic.size()} != rules_format::magic) {
+    throw std::runtime_error(std::format("{} is not a binary rules set", file));
+  }
+  if (reader.read<std::uint32_t>() != rules_format::version) {
+    throw std::runtime_error("Unsupported version of the binary rules set");
+  }
+  const auto inputs_count = reader.read<std::uint32_t>();
+  const auto outputs_count = reader.read<std::uint32_t>();
+  const auto rules_count = reader.read<std::uint64_t>();
+  const auto preconditions_total = reader.read<std::uint64_t>();
+
+  RulesSet rules_set;
+  for (std::uint32_t input = 0; input < inputs_count; ++input) {
+    const auto name = reader.read_string();
+    const auto type = reader.read<rules_format::VariableType>();
+    const auto points = reader.read_array<double>(reader.read<std::uint32_t>());
+    if (type == rules_format::VariableType::float64) {
+      static_cast<void>(rules_set.add_input_variable<double>(name, points));
+    } else if (type == rules_format::VariableType::int32) {
+      static_cast<void>(rules_set.add_input_variable<int>(name, points));
+    } else {
+      throw std::runtime_error("Unsupported variable type of the binary rules set");
+    }
+  }
+  // The outputs are added in the file order, so the conclusions of the file index the conclusions table of the set
+  for (std::uint32_t output = 0; output < outputs_count; ++output) {
+    auto name = reader.read_string();
+    const auto categories_count = reader.read<std::uint32_t>();
+    std::vector<std::string> categories;
+    for (std::uint32_t category = 0; category < categories_count; ++category) {
+      categories.push_back(reader.read_string());
+    }
+    static_cast<void>(rules_set.add_output_variable(name, std::move(categories)));
+  }
+  const auto conclusions = reader.read_array<std::uint32_t>(rules_count);
+  const auto preconditions_counts = reader.read_array<std::uint32_t>(rules_count);
+  if (preconditions_total > std::numeric_limits<std::uint64_t>::max() / 2) {
+    throw std::runtime_error("Truncated binary rules set");
+  }
+  const auto preconditions = reader.read_array<std::uint32_t>(preconditions_total * 2);
+  if (not reader.is_finished()) {
+    throw std::runtime_error("Unexpected data after the binary rules set");
+  }
+  try {
+    rules_set.add_rules_by_ids(preconditions, preconditions_counts, conclusions);
+  } catch (const std::runtime_error& error) {
+    throw std::runtime_error(std::format("Invalid rules of the binary rules set: {}", error.what()));
+  }
+  return rules_set;
+}
+} // namespace fuzzyrulesml::rules
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "rules.hpp"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace fuzzyrulesml::rules {
+// Text format of a rules set for authoring, one declaration per line, '#' starting a comment; names are single words
+// without '=', terms are the membership function indices of the variables:
+//   input <name> <double|int> <characteristic point>...
+//   output <name> <category>...
+//   rule <input name>=<term>... -> <output name>=<category>
+// The inputs are declared in their ids order and before the rules using them; the rules are checked by add_rule
+void write_rules_text(const RulesSet& rules_set, std::ostream& output);
+[[nodiscard]] auto read_rules_text(std::istream& input) -> RulesSet;
+
+// Binary format of a rules set for deployment, native (little endian) byte order:
+//   header:   magic "FRMLRUL1", version, inputs count, outputs count, rules count (uint64), preconditions count (uint64)
+//   inputs:   name (its length as uint32 and characters), variable type, points count (uint32), float64 points
+//   outputs:  name, categories count (uint32), categories names
+//   rules:    uint32 conclusion of each rule, indexing the categories of all the outputs in the file order, uint32
+//             preconditions count of each rule, then (variable id, term) uint32 pairs of all the rules, by the ids
+// The file is mapped and read without parsing; the rules arrays are checked against the variables and the outputs of the
+// file at once and stored as they are, see RulesSet::add_rules_by_ids, so no rule builds the map of its preconditions
+// until RulesSet::get_all_rules is called
+namespace rules_format {
+inline constexpr std::string_view magic{"FRMLRUL1"};
+inline constexpr std::uint32_t version = 1;
+enum class VariableType : std::uint32_t { float64 = 1, int32 = 2 };
+} // namespace rules_format
+
+void write_rules_binary(const RulesSet& rules_set, const std::string& file);
+[[nodiscard]] auto read_rules_binary(const std::string& file) -> RulesSet;
+} // namespace fuzzyrulesml::rules
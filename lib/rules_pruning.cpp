@@ -0,0 +1,169 @@
+#include "rules_pruning.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <tuple>
+#include <utility>
+
+namespace fuzzyrulesml::rules {
+namespace {
+// Rule under compaction: the terms of its preconditions by the variables ids
+struct CompactedRule {
+  std::map<std::size_t, std::size_t> preconditions;
+  ConclusionChosen conclusion;
+};
+
+// Rules of the rules set as the terms of their preconditions by the variables ids
+auto get_compacted_rules(const RulesSet& rules_set) -> std::vector<CompactedRule> {
+  std::vector<CompactedRule> rules;
+  for (std::size_t rule_id = 0; rule_id < rules_set.get_rules_count(); ++rule_id) {
+    auto& compacted = rules.emplace_back(CompactedRule{.preconditions = {}, .conclusion = rules_set.get_rule_conclusion(rule_id)});
+    for (const auto& [variable_id, term] : rules_set.get_rule_preconditions(rule_id)) {
+      compacted.preconditions.emplace_hint(compacted.preconditions.end(), variable_id, term);
+    }
+  }
+  return rules;
+}
+
+// Rules set of the same variables as the source one, the rules replaced by the given ones
+auto make_rules_set(const RulesSet& source, const std::vector<CompactedRule>& rules) -> RulesSet {
+  RulesSet rules_set;
+  for (const auto& variable : source.get_input_variables()) {
+    if (variable.is_integer()) {
+      static_cast<void>(rules_set.add_input_variable<int>(variable.get_name(), variable.get_points()));
+    } else {
+      static_cast<void>(rules_set.add_input_variable<double>(variable.get_name(), variable.get_points()));
+    }
+  }
+  for (const auto& [name, categories] : source.get_output_variables()) {
+    static_cast<void>(rules_set.add_output_variable(name, categories));
+  }
+  const auto& variables = rules_set.get_input_variables();
+  for (const auto& rule : rules) {
+    std::map<FuzzyVarUnion, std::size_t> preconditions;
+    for (const auto& [variable_id, term] : rule.preconditions) {
+      preconditions.emplace(variables[variable_id], term);
+    }
+    rules_set.add_rule(preconditions, rule.conclusion);
+  }
+  return rules_set;
+}
+
+// Merges the rules of the same conclusion and other preconditions covering all the terms of the variable; returns
+// whether any were merged
+auto merge_variable(std::vector<CompactedRule>& rules, std::size_t variable_id, std::size_t terms) -> bool {
+  using GroupKey = std::tuple<std::string, std::string, std::map<std::size_t, std::size_t>>;
+  std::map<GroupKey, std::vector<std::size_t>> groups;
+  for (std::size_t index = 0; index < rules.size(); ++index) {
+    const auto& rule = rules[index];
+    if (not rule.preconditions.contains(variable_id)) {
+      continue;
+    }
+    auto others = rule.preconditions;
+    others.erase(variable_id);
+    groups[{rule.conclusion.name, rule.conclusion.item, std::move(others)}].push_back(index);
+  }
+  std::vector<bool> replaced(rules.size(), false);
+  std::vector<CompactedRule> merged_rules;
+  for (const auto& [key, indices] : groups) {
+    std::vector<bool> covered(terms, false);
+    for (const auto index : indices) {
+      const auto term = rules[index].preconditions.at(variable_id);
+      if (term < terms) {
+        covered[term] = true;
+      }
+    }
+    if (indices.size() != terms || not std::ranges::all_of(covered, std::identity{})) {
+      continue;
+    }
+    for (const auto index : indices) {
+      replaced[index] = true;
+    }
+    merged_rules.push_back({.preconditions = std::get<2>(key), .conclusion = rules[indices.front()].conclusion});
+  }
+  if (merged_rules.empty()) {
+    return false;
+  }
+  std::vector<CompactedRule> remaining;
+  for (std::size_t index = 0; index < rules.size(); ++index) {
+    if (not replaced[index]) {
+      remaining.push_back(std::move(rules[index]));
+    }
+  }
+  std::ranges::move(merged_rules, std::back_inserter(remaining));
+  rules = std::move(remaining);
+  return true;
+}
+} // namespace
+
+auto get_rules_classes(const RulesSet& rules_set, const std::vector<std::string>& classes) -> std::vector<std::uint32_t> {
+  std::vector<std::uint32_t> rules_classes;
+  for (std::size_t rule_id = 0; rule_id < rules_set.get_rules_count(); ++rule_id) {
+    const auto found = std::ranges::find(classes, rules_set.get_rule_conclusion(rule_id).item);
+    rules_classes.push_back(found == classes.end() ? fuzzyrulesml::reasoner::no_class
+                                                   : static_cast<std::uint32_t>(std::distance(classes.begin(), found)));
+  }
+  return rules_classes;
+}
+
+auto remove_dominated_rules(const RulesSet& rules_set, const std::vector<RuleStatistics>& statistics) -> RulesSet {
+  auto rules = get_compacted_rules(rules_set);
+  std::map<std::map<std::size_t, std::size_t>, std::size_t> best_rules;
+  for (std::size_t rule_id = 0; rule_id < rules.size(); ++rule_id) {
+    const auto [found, inserted] = best_rules.emplace(rules[rule_id].preconditions, rule_id);
+    if (not inserted && statistics[rule_id].target_strength > statistics[found->second].target_strength) {
+      found->second = rule_id;
+    }
+  }
+  std::vector<CompactedRule> kept;
+  for (std::size_t rule_id = 0; rule_id < rules.size(); ++rule_id) {
+    if (best_rules.at(rules[rule_id].preconditions) == rule_id) {
+      kept.push_back(std::move(rules[rule_id]));
+    }
+  }
+  return make_rules_set(rules_set, kept);
+}
+
+auto merge_rules(const RulesSet& rules_set, const BatchInputs& inputs) -> RulesSet {
+  // The terms of a variable sum up to 1 at a value only: a missing one, or a variable out of the batch, fires none of
+  // them, where the merged rule would fire
+  const auto& variables = inputs.get_variables();
+  const auto is_bound = [&rules_set, &inputs, &variables](const FuzzyVarUnion& variable) {
+    const auto found = std::ranges::find_if(variables, [&rules_set, &variable](const FuzzyVarUnion& bound) {
+      return bound.get_id() == variable.get_id() && rules_set.contains(bound);
+    });
+    if (found == variables.end()) {
+      return false;
+    }
+    const auto column = inputs.get_columns()[std::distance(variables.begin(), found)];
+    return std::ranges::none_of(column, [](double value) { return std::isnan(value); });
+  };
+  std::vector<std::pair<std::size_t, std::size_t>> mergeable;
+  for (const auto& variable : rules_set.get_input_variables()) {
+    if (not variable.is_integer() && is_bound(variable)) {
+      mergeable.emplace_back(variable.get_id(), variable.get_points().size());
+    }
+  }
+  auto rules = get_compacted_rules(rules_set);
+  for (bool merging = true; merging;) {
+    merging = false;
+    for (const auto& [variable_id, terms] : mergeable) {
+      merging = merge_variable(rules, variable_id, terms) || merging;
+    }
+  }
+  return make_rules_set(rules_set, rules);
+}
+
+auto remove_dead_rules(const RulesSet& rules_set, const std::vector<RuleStatistics>& statistics) -> RulesSet {
+  auto rules = get_compacted_rules(rules_set);
+  std::vector<CompactedRule> live;
+  for (std::size_t rule_id = 0; rule_id < rules.size(); ++rule_id) {
+    if (statistics[rule_id].fired_rows > 0) {
+      live.push_back(std::move(rules[rule_id]));
+    }
+  }
+  return make_rules_set(rules_set, live);
+}
+} // namespace fuzzyrulesml::rules
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "parallel.hpp"
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fuzzyrulesml::rules {
+// Firing statistics of a rule over the rows of a batch, as the reasoner fires it, see BasicReasoner::fire_row
+struct RuleStatistics {
+  // Rows the rule fires on with a positive strength
+  std::size_t fired_rows{0};
+  // Sum of the strengths over all the rows
+  double strength{0.0};
+  // Sum of the strengths over the rows of the class of the rule conclusion, the support of the rule
+  double target_strength{0.0};
+};
+
+// Class of each rule conclusion, fuzzyrulesml::reasoner::no_class for the conclusions of no class
+[[nodiscard]] auto get_rules_classes(const RulesSet& rules_set, const std::vector<std::string>& classes) -> std::vector<std::uint32_t>;
+
+// Adds the fired rules of the rows [first, first + count) to their statistics
+template <fuzzyrulesml::reasoner::TNorm TNORM, fuzzyrulesml::reasoner::Aggregation AGGREGATION>
+void add_rows_statistics(const fuzzyrulesml::reasoner::BasicReasoner<TNORM, AGGREGATION>& reasoner, const BatchInputs& inputs,
+                         std::span<const std::uint32_t> targets, std::span<const std::uint32_t> rules_classes, std::size_t first,
+                         std::size_t count, std::vector<RuleStatistics>& statistics) {
+  const auto plan = reasoner.get_batch_plan(inputs);
+  auto scratch = reasoner.make_row_scratch();
+  statistics.assign(rules_classes.size(), {});
+  reasoner.for_each_fuzzified_row(plan, inputs, first, count, [&](std::size_t row, const auto& fuzzified) {
+    const auto fired = reasoner.fire_row(plan, fuzzified, scratch);
+    for (std::size_t index = 0; index < fired.rules.size(); ++index) {
+      auto& rule_statistics = statistics[fired.rules[index]];
+      ++rule_statistics.fired_rows;
+      rule_statistics.strength += fired.strengths[index];
+      if (rules_classes[fired.rules[index]] == targets[row]) {
+        rule_statistics.target_strength += fired.strengths[index];
+      }
+    }
+  });
+}
+
+// Firing statistics of each rule of the reasoner, indexed as get_rules().get_all_rules(); the variables of the inputs
+// carry the characteristic points. The rules of the variables out of the batch, or of the int variables, never fire,
+// as they do not in the batch reasoning. The rows are split between the threads (0 means all the hardware threads) and
+// the parts reduced in the rows order, so the sums are the same for the same threads count, and differ by the rounding
+// only for another one
+template <fuzzyrulesml::reasoner::TNorm TNORM, fuzzyrulesml::reasoner::Aggregation AGGREGATION>
+[[nodiscard]] auto get_rules_statistics(const fuzzyrulesml::reasoner::BasicReasoner<TNORM, AGGREGATION>& reasoner,
+                                        const BatchInputs& inputs, std::span<const std::uint32_t> targets,
+                                        const std::vector<std::string>& classes, std::size_t threads = 1) -> std::vector<RuleStatistics> {
+  if (targets.size() != inputs.get_rows()) {
+    throw std::runtime_error("Targets count differs from the batch rows count");
+  }
+  const auto rules_classes = get_rules_classes(reasoner.get_rules(), classes);
+  std::vector<std::vector<RuleStatistics>> parts(fuzzyrulesml::parallel::get_parts_count(threads, inputs.get_rows()));
+  fuzzyrulesml::parallel::parallel_for(threads, inputs.get_rows(), [&](std::size_t part, std::size_t first, std::size_t count) {
+    add_rows_statistics(reasoner, inputs, targets, rules_classes, first, count, parts[part]);
+  });
+  std::vector<RuleStatistics> statistics(rules_classes.size());
+  for (const auto& part : parts) {
+    for (std::size_t rule_id = 0; rule_id < part.size(); ++rule_id) {
+      statistics[rule_id].fired_rows += part[rule_id].fired_rows;
+      statistics[rule_id].strength += part[rule_id].strength;
+      statistics[rule_id].target_strength += part[rule_id].target_strength;
+    }
+  }
+  return statistics;
+}
+
+// Of the rules of the same preconditions keeps the best supported one, the first one of equal supports
+[[nodiscard]] auto remove_dominated_rules(const RulesSet& rules_set, const std::vector<RuleStatistics>& statistics) -> RulesSet;
+// Merges the rules of the same conclusion and the same other preconditions covering all the terms of a double variable
+// into a single rule without that variable, repeated while any merges. Only the variables bound to a column of the
+// batch with no missing value are merged
+[[nodiscard]] auto merge_rules(const RulesSet& rules_set, const BatchInputs& inputs) -> RulesSet;
+// Removes the rules firing on no row
+[[nodiscard]] auto remove_dead_rules(const RulesSet& rules_set, const std::vector<RuleStatistics>& statistics) -> RulesSet;
+
+struct CompactedRules {
+  RulesSet rules_set;
+  // Rules of the same preconditions as a better supported one, the conflicting and the duplicated ones
+  std::size_t dominated{0};
+  // Rules replaced by the merged rules
+  std::size_t merged{0};
+  // Rules firing on no row of the batch after the merging
+  std::size_t dead{0};
+};
+
+// Compacts the rules set of the reasoner for the rows of the batch by remove_dominated_rules, merge_rules and
+// remove_dead_rules, the statistics fired by the reasoner policies. The memberships of the terms sum up to 1 at any
+// value, so a merged rule scores the same as the sum of the merged ones under the product t-norm and the sum
+// aggregation, for any points and the values of the merged variables other than missing; the rules are merged for
+// these policies and the variables of the batch columns with no missing value only. The variables of the compacted
+// rules set have the same ids, names and points, so the batch inputs built for the original one score it as well
+template <fuzzyrulesml::reasoner::TNorm TNORM, fuzzyrulesml::reasoner::Aggregation AGGREGATION>
+[[nodiscard]] auto compact_rules(const fuzzyrulesml::reasoner::BasicReasoner<TNORM, AGGREGATION>& reasoner, const BatchInputs& inputs,
+                                 std::span<const std::uint32_t> targets, const std::vector<std::string>& classes,
+                                 std::size_t threads = 1) -> CompactedRules {
+  const auto& rules_set = reasoner.get_rules();
+  const auto kept = remove_dominated_rules(rules_set, get_rules_statistics(reasoner, inputs, targets, classes, threads));
+  CompactedRules compacted{.rules_set = {}, .dominated = rules_set.get_rules_count() - kept.get_rules_count()};
+
+  auto merged = kept;
+  if constexpr (std::same_as<TNORM, fuzzyrulesml::reasoner::ProductTNorm> &&
+                std::same_as<AGGREGATION, fuzzyrulesml::reasoner::SumAggregation>) {
+    merged = merge_rules(kept, inputs);
+  }
+  compacted.merged = kept.get_rules_count() - merged.get_rules_count();
+
+  const fuzzyrulesml::reasoner::BasicReasoner<TNORM, AGGREGATION> merged_reasoner{merged};
+  compacted.rules_set = remove_dead_rules(merged, get_rules_statistics(merged_reasoner, inputs, targets, classes, threads));
+  compacted.dead = merged.get_rules_count() - compacted.rules_set.get_rules_count();
+  return compacted;
+}
+} // namespace fuzzyrulesml::rules
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "fuzzify_kernels.hpp"
+#include "operators.hpp"
+#include "rules.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace fuzzyrulesml::reasoner {
+// Term of a static rule for the variables not among its preconditions
+inline constexpr std::uint32_t any_term = std::numeric_limits<std::uint32_t>::max();
+
+// Row of a static rules table: the membership function of each input variable tested by the rule (any_term for the
+// other ones) and the index of its conclusion within the output categories
+template <std::size_t VARIABLES> struct StaticRule {
+  std::array<std::uint32_t, VARIABLES> terms;
+  std::uint32_t conclusion;
+};
+
+// StaticReasoner is the compile-time counterpart of SimpleReasoner for a rule base known when building: TERMS is the
+// number of the membership functions of each input variable, RULES is the table of StaticRule and CONCLUSIONS is the
+// number of the output categories. Inference is unrolled over the variables and the rules into straight-line code
+// without the variants, the maps and the posting lists; only the characteristic points are set at runtime, laid out
+// as ParametersBinding does for the columns in the TERMS order. Scores are the ones BasicReasoner of the same operators
+// gives for the rules set built by add_rules, with the conclusions in the categories order, which is the reasoner one
+// for the sorted categories, also for the not sorted points an optimizer may set; the unrolling is meant for small rule
+// bases such as iris
+template <std::array TERMS, std::array RULES, std::size_t CONCLUSIONS, TNorm TNORM = ProductTNorm, Aggregation AGGREGATION = SumAggregation>
+class StaticReasoner {
+public:
+  static constexpr std::size_t variables_count = TERMS.size();
+  static constexpr std::size_t rules_count = RULES.size();
+  static constexpr std::size_t conclusions_count = CONCLUSIONS;
+  static constexpr std::size_t parameters_count = std::accumulate(TERMS.begin(), TERMS.end(), std::size_t{0});
+  using Row = std::array<double, variables_count>;
+  using Scores = std::array<double, CONCLUSIONS>;
+
+  static_assert(variables_count > 0, "Static rule base needs input variables");
+  static_assert(std::ranges::all_of(TERMS, [](auto terms) { return terms >= 2; }), "Each variable needs at least two terms");
+  static_assert(std::is_same_v<typename std::remove_cvref_t<decltype(RULES)>::value_type, StaticRule<variables_count>>,
+                "Static rules need a term for each input variable");
+
+  constexpr explicit StaticReasoner(std::span<const double> parameters) { set_parameters(parameters); }
+
+  constexpr void set_parameters(std::span<const double> parameters) {
+    if (parameters.size() != parameters_count) {
+      throw std::runtime_error("Parameters count differs from the static rule base points count");
+    }
+    std::ranges::copy(parameters, points.begin());
+    for (std::size_t variable = 0; variable < variables_count; ++variable) {
+      sorted[variable] = std::ranges::is_sorted(points.begin() + offsets[variable], points.begin() + offsets[variable + 1]);
+    }
+  }
+  [[nodiscard]] constexpr auto get_parameters() const -> std::span<const double> { return points; }
+
+  [[nodiscard]] constexpr auto do_reasoning(const Row& values) const -> Scores {
+    const auto memberships = fuzzify(values, std::make_index_sequence<variables_count>{});
+    Scores scores{};
+    add_strengths(memberships, scores, std::make_index_sequence<rules_count>{});
+    return scores;
+  }
+
+  // Batch reasoning of the columns in the TERMS order; scores is a preallocated row-major matrix of rows x CONCLUSIONS
+  void do_reasoning(std::span<const std::span<const double>> columns, std::span<double> scores) const {
+    if (columns.size() != variables_count) {
+      throw std::runtime_error("Columns count differs from the static rule base variables count");
+    }
+    const auto rows = columns.front().size();
+    if (std::ranges::any_of(columns, [rows](const auto& column) { return column.size() != rows; }) ||
+        scores.size() != rows * CONCLUSIONS) {
+      throw std::runtime_error("Invalid size of the scores matrix");
+    }
+    for (std::size_t row = 0; row < rows; ++row) {
+      Row values{};
+      for (std::size_t variable = 0; variable < variables_count; ++variable) {
+        values[variable] = columns[variable][row];
+      }
+      std::ranges::copy(do_reasoning(values), scores.subspan(row * CONCLUSIONS, CONCLUSIONS).begin());
+    }
+  }
+  // The variables of the inputs are only checked for their count, the columns are taken in the TERMS order
+  void do_reasoning(const fuzzyrulesml::rules::BatchInputs& inputs, std::span<double> scores) const {
+    do_reasoning(inputs.get_columns(), scores);
+  }
+
+  // Adds the rules of the table to a dynamic rules set, for the input variables in the TERMS order and the categories
+  // of the output variable, e.g. to cross-check the scores with SimpleReasoner
+  static void add_rules(fuzzyrulesml::rules::RulesSet& rules_set, const std::array<fuzzyrulesml::rules::FuzzyVarUnion, variables_count>& variables,
+                        const fuzzyrulesml::rules::Conclusion& output) {
+    const auto categories = output.get_categories();
+    for (const auto& rule : RULES) {
+      std::map<fuzzyrulesml::rules::FuzzyVarUnion, std::size_t> preconditions;
+      for (std::size_t variable = 0; variable < variables_count; ++variable) {
+        if (rule.terms[variable] != any_term) {
+          preconditions.emplace(variables[variable], rule.terms[variable]);
+        }
+      }
+      rules_set.add_rule(preconditions, {output.get_name(), categories.at(rule.conclusion)});
+    }
+  }
+
+private:
+  static constexpr auto offsets = [] {
+    std::array<std::size_t, variables_count + 1> offsets{};
+    std::partial_sum(TERMS.begin(), TERMS.end(), std::next(offsets.begin()));
+    return offsets;
+  }();
+  static_assert(std::ranges::all_of(RULES,
+                                    [](const auto& rule) {
+                                      for (std::size_t variable = 0; variable < variables_count; ++variable) {
+                                        if (rule.terms[variable] != any_term && rule.terms[variable] >= TERMS[variable]) {
+                                          return false;
+                                        }
+                                      }
+                                      return rule.conclusion < CONCLUSIONS;
+                                    }),
+                "Static rule refers to a term or a conclusion out of the rule base");
+
+  // Degrees of all the membership functions of the variable, the same as fuzzify_column gives for its segment: counted
+  // for sorted points, by bisect_points for not sorted ones; a missing (NaN) value has no segment, so both degrees are 0
+  // and the rules testing the variable do not fire
+  template <std::size_t VARIABLE> constexpr void fuzzify_variable(double value, std::array<double, parameters_count>& memberships) const {
+    constexpr auto first = offsets[VARIABLE];
+    constexpr auto terms = TERMS[VARIABLE];
+    std::size_t segment = 0;
+    if (sorted[VARIABLE]) {
+      for (std::size_t point = 1; point + 1 < terms; ++point) {
+        segment += points[first + point] <= value ? 1U : 0U;
+      }
+    } else if (value >= points[first + terms - 1]) {
+      segment = terms - 2;
+    } else if (value >= points[first]) {
+      segment = mfunct::bisect_points(std::span<const double>{points}.subspan(first, terms), value);
+    }
+    const auto segment_end = points[first + segment + 1];
+    auto degree = (segment_end - value) / (segment_end - points[first + segment]);
+    degree = value >= points[first + terms - 1] ? 0.0 : degree;
+    degree = value < points[first] ? 1.0 : degree;
+    // Unlike std::isnan, usable in the constant evaluation
+    const bool missing = value != value;
+    memberships[first + segment] = missing ? 0.0 : degree;
+    memberships[first + segment + 1] = missing ? 0.0 : 1.0 - degree;
+  }
+  template <std::size_t... VARIABLE>
+  constexpr auto fuzzify(const Row& values, std::index_sequence<VARIABLE...> /*variables*/) const -> std::array<double, parameters_count> {
+    std::array<double, parameters_count> memberships{};
+    (fuzzify_variable<VARIABLE>(values[VARIABLE], memberships), ...);
+    return memberships;
+  }
+
+  // T-norm of the degrees of the rule preconditions in the variables order, as SimpleReasoner applies it
+  template <std::size_t RULE, std::size_t... VARIABLE>
+  static constexpr auto get_strength(const std::array<double, parameters_count>& memberships, std::index_sequence<VARIABLE...> /*variables*/)
+      -> double {
+    double strength = TNORM::identity;
+    ((strength = apply_degree<RULES[RULE].terms[VARIABLE], VARIABLE>(strength, memberships)), ...);
+    return strength;
+  }
+  template <std::uint32_t TERM, std::size_t VARIABLE>
+  static constexpr auto apply_degree(double strength, const std::array<double, parameters_count>& memberships) -> double {
+    if constexpr (TERM == any_term) {
+      return strength;
+    } else {
+      return TNORM::apply(strength, memberships[offsets[VARIABLE] + TERM]);
+    }
+  }
+  template <std::size_t... RULE>
+  static constexpr void add_strengths(const std::array<double, parameters_count>& memberships, Scores& scores,
+                                      std::index_sequence<RULE...> /*rules*/) {
+    ((scores[RULES[RULE].conclusion] = AGGREGATION::combine(scores[RULES[RULE].conclusion],
+                                                            get_strength<RULE>(memberships, std::make_index_sequence<variables_count>{}))),
+     ...);
+  }
+
+  std::array<double, parameters_count> points{};
+  std::array<bool, variables_count> sorted{};
+};
+} // namespace fuzzyrulesml::reasoner
@@ -0,0 +1,292 @@
+#include "training.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace fuzzyrulesml::training {
+namespace {
+// Checkpoint text, one record per line:
+//   <magic> <version>
+//   generation <generation> population <members count> dimensions <parameters count>
+//   best <objective value> <parameters>...
+//   member <objective value> <parameters>...        (one line per member)
+//   generator <state of std::mt19937_64>
+// The values are written in their shortest round-trip form, so the restored ones are the same bit for bit
+struct Checkpoint {
+  std::size_t generation{0};
+  double best_value{0.0};
+  Parameters best_parameters;
+  std::vector<Parameters> population;
+  std::vector<double> population_values;
+  std::string generator;
+};
+
+void write_values(std::ostream& output, std::string_view key, double value, const Parameters& parameters) {
+  output << std::format("{} {}", key, value);
+  for (const auto parameter : parameters) {
+    output << std::format(" {}", parameter);
+  }
+  output << '\n';
+}
+
+void expect_key(std::istream& input, std::string_view key) {
+  std::string token;
+  if (not(input >> token) || token != key) {
+    throw std::runtime_error(std::format("Invalid checkpoint, expected \"{}\"", key));
+  }
+}
+
+auto read_count(std::istream& input, std::string_view key) -> std::size_t {
+  expect_key(input, key);
+  std::size_t count = 0;
+  if (not(input >> count)) {
+    throw std::runtime_error(std::format("Invalid checkpoint {}", key));
+  }
+  return count;
+}
+
+// Numbers are parsed by from_chars, which reads the infinities written by format too
+auto read_number(std::istream& input) -> double {
+  std::string token;
+  double value{};
+  if (not(input >> token)) {
+    throw std::runtime_error("Truncated checkpoint");
+  }
+  const auto [end, error] = std::from_chars(token.data(), std::next(token.data(), static_cast<std::ptrdiff_t>(token.size())), value);
+  if (error != std::errc{} || end != std::next(token.data(), static_cast<std::ptrdiff_t>(token.size()))) {
+    throw std::runtime_error(std::format("Invalid checkpoint number \"{}\"", token));
+  }
+  return value;
+}
+
+auto read_values(std::istream& input, std::string_view key, std::size_t dimensions) -> std::pair<double, Parameters> {
+  expect_key(input, key);
+  const auto value = read_number(input);
+  Parameters parameters(dimensions);
+  for (auto& parameter : parameters) {
+    parameter = read_number(input);
+  }
+  return {value, std::move(parameters)};
+}
+
+auto read_checkpoint(const std::string& file) -> Checkpoint {
+  std::ifstream input{file};
+  if (not input.is_open()) {
+    throw std::runtime_error(std::format("Cannot open the file {}", file));
+  }
+  expect_key(input, checkpoint_format::magic);
+  std::uint32_t version = 0;
+  if (not(input >> version) || version != checkpoint_format::version) {
+    throw std::runtime_error("Unsupported version of the checkpoint");
+  }
+  Checkpoint checkpoint;
+  checkpoint.generation = read_count(input, "generation");
+  const auto members = read_count(input, "population");
+  const auto dimensions = read_count(input, "dimensions");
+  std::tie(checkpoint.best_value, checkpoint.best_parameters) = read_values(input, "best", dimensions);
+  for (std::size_t member = 0; member < members; ++member) {
+    auto [value, parameters] = read_values(input, "member", dimensions);
+    checkpoint.population_values.push_back(value);
+    checkpoint.population.push_back(std::move(parameters));
+  }
+  expect_key(input, "generator");
+  std::getline(input >> std::ws, checkpoint.generator);
+  return checkpoint;
+}
+} // namespace
+
+DifferentialEvolution::DifferentialEvolution(Parameters lower_bounds, Parameters upper_bounds,
+                                             const DifferentialEvolutionSettings& settings)
+    : lower_bounds{std::move(lower_bounds)}, upper_bounds{std::move(upper_bounds)}, settings{settings}, thread_pool{settings.threads},
+      generator{settings.seed} {
+  if (this->lower_bounds.size() != this->upper_bounds.size()) {
+    throw std::runtime_error("Lower and upper bounds of different sizes");
+  }
+  const std::size_t minimal_population = 4;
+  if (settings.population_size < minimal_population) {
+    throw std::runtime_error("Differential evolution needs at least four population members");
+  }
+}
+
+void DifferentialEvolution::initialize(const Parameters& start, const Objective& objective) {
+  if (start.size() != lower_bounds.size()) {
+    throw std::runtime_error("Start parameters and bounds of different sizes");
+  }
+  population.assign(1, start);
+  for (std::size_t member = 1; member < settings.population_size; ++member) {
+    Parameters parameters(start.size());
+    for (std::size_t i = 0; i < parameters.size(); ++i) {
+      parameters[i] = std::uniform_real_distribution<double>{lower_bounds[i], upper_bounds[i]}(generator);
+    }
+    population.push_back(std::move(parameters));
+  }
+  state = TrainingState{};
+  evaluate(objective, population, population_values);
+  update_best();
+}
+
+auto DifferentialEvolution::step(const Objective& objective) -> bool {
+  const auto population_size = population.size();
+  const auto dimensions = lower_bounds.size();
+  std::uniform_int_distribution<std::size_t> member_distribution{0, population_size - 1};
+  std::uniform_int_distribution<std::size_t> dimension_distribution{0, dimensions - 1};
+  std::uniform_real_distribution<double> crossover_distribution{0.0, 1.0};
+
+  std::vector<Parameters> trials(population_size);
+  for (std::size_t member = 0; member < population_size; ++member) {
+    // Three distinct donors, all different from the target member
+    std::array<std::size_t, 3> donors{member, member, member};
+    for (auto& donor : donors) {
+      while (std::ranges::count(donors, donor) > 1 || donor == member) {
+        donor = member_distribution(generator);
+      }
+    }
+    const auto forced_dimension = dimension_distribution(generator);
+    trials[member] = population[member];
+    for (std::size_t i = 0; i < dimensions; ++i) {
+      if (i == forced_dimension || crossover_distribution(generator) < settings.crossover_rate) {
+        trials[member][i] =
+            population[donors[0]][i] + (settings.mutation_factor * (population[donors[1]][i] - population[donors[2]][i]));
+      }
+    }
+  }
+  // A resampled objective scores the population again in the pass of the trials, so their values are comparable
+  std::vector<double> trial_values;
+  if (resample) {
+    trials.insert(trials.end(), population.begin(), population.end());
+    evaluate(objective, trials, trial_values);
+    std::ranges::copy(std::span{trial_values}.subspan(population_size), population_values.begin());
+    trials.resize(population_size);
+    trial_values.resize(population_size);
+    state.best_value = std::numeric_limits<double>::infinity();
+    update_best();
+  } else {
+    evaluate(objective, trials, trial_values);
+  }
+  for (std::size_t member = 0; member < population_size; ++member) {
+    if (trial_values[member] <= population_values[member]) {
+      population[member] = std::move(trials[member]);
+      population_values[member] = trial_values[member];
+    }
+  }
+  ++state.generation;
+  return update_best();
+}
+
+auto DifferentialEvolution::run(const Parameters& start, const Objective& objective, const ImprovementCallback& on_improvement)
+    -> TrainingState {
+  initialize(start, objective);
+  if (on_improvement) {
+    on_improvement(state);
+  }
+  return resume(objective, on_improvement);
+}
+
+auto DifferentialEvolution::resume(const Objective& objective, const ImprovementCallback& on_improvement) -> TrainingState {
+  if (population.empty()) {
+    throw std::runtime_error("Differential evolution is not initialized");
+  }
+  while (not is_finished()) {
+    if (resample) {
+      resample(state.generation + 1);
+    }
+    if (step(objective) && on_improvement) {
+      on_improvement(state);
+    }
+    if (resample && confirm && state.best_value <= settings.target_value) {
+      confirmed_value = confirm(state.best_parameters);
+      ++state.evaluations;
+    }
+    checkpoint_generation();
+  }
+  if (not settings.checkpoint_file.empty()) {
+    save_checkpoint(settings.checkpoint_file);
+  }
+  return state;
+}
+
+auto DifferentialEvolution::reevaluate(const Objective& objective) -> const TrainingState& {
+  if (population.empty()) {
+    throw std::runtime_error("Differential evolution is not initialized");
+  }
+  evaluate(objective, population, population_values);
+  state.best_value = std::numeric_limits<double>::infinity();
+  update_best();
+  return state;
+}
+
+void DifferentialEvolution::save_checkpoint(const std::string& file) const {
+  if (population.empty()) {
+    throw std::runtime_error("Differential evolution is not initialized");
+  }
+  const auto temporary = file + ".tmp";
+  {
+    std::ofstream output{temporary, std::ofstream::out | std::ofstream::trunc};
+    if (not output.is_open()) {
+      throw std::runtime_error(std::format("Cannot open the file {}", temporary));
+    }
+    output << std::format("{} {}\n", checkpoint_format::magic, checkpoint_format::version);
+    output << std::format("generation {} population {} dimensions {}\n", state.generation, population.size(), lower_bounds.size());
+    write_values(output, "best", state.best_value, state.best_parameters);
+    for (std::size_t member = 0; member < population.size(); ++member) {
+      write_values(output, "member", population_values[member], population[member]);
+    }
+    output << "generator " << generator << '\n';
+    output.close();
+    if (output.fail()) {
+      throw std::runtime_error(std::format("Cannot write the checkpoint {}", temporary));
+    }
+  }
+  std::filesystem::rename(temporary, file);
+}
+
+void DifferentialEvolution::restore(const std::string& file) {
+  auto checkpoint = read_checkpoint(file);
+  if (checkpoint.population.size() != settings.population_size || checkpoint.best_parameters.size() != lower_bounds.size()) {
+    throw std::runtime_error("Checkpoint of a different population size or dimensions");
+  }
+  std::istringstream generator_state{checkpoint.generator};
+  if (not(generator_state >> generator)) {
+    throw std::runtime_error("Invalid checkpoint generator state");
+  }
+  population = std::move(checkpoint.population);
+  population_values = std::move(checkpoint.population_values);
+  state = TrainingState{.generation = checkpoint.generation,
+                        .best_parameters = std::move(checkpoint.best_parameters),
+                        .best_value = checkpoint.best_value,
+                        .evaluations = 0};
+}
+
+void DifferentialEvolution::checkpoint_generation() const {
+  if (not settings.checkpoint_file.empty() && settings.checkpoint_generations > 0 && state.generation % settings.checkpoint_generations == 0) {
+    save_checkpoint(settings.checkpoint_file);
+  }
+}
+
+void DifferentialEvolution::evaluate(const Objective& objective, const std::vector<Parameters>& candidates, std::vector<double>& values) {
+  values.assign(candidates.size(), 0.0);
+  thread_pool.for_each_index(candidates.size(), [&](std::size_t member) { values[member] = objective(candidates[member]); });
+  state.evaluations += candidates.size();
+}
+
+auto DifferentialEvolution::update_best() -> bool {
+  const auto best = std::ranges::min_element(population_values);
+  if (best == population_values.end() || *best >= state.best_value) {
+    return false;
+  }
+  state.best_value = *best;
+  state.best_parameters = population[static_cast<std::size_t>(std::distance(population_values.begin(), best))];
+  return true;
+}
+
+auto read_checkpoint_parameters(const std::string& file) -> Parameters { return read_checkpoint(file).best_parameters; }
+} // namespace fuzzyrulesml::training
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "parallel.hpp"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace fuzzyrulesml::training {
+using Parameters = std::vector<double>;
+// Objective function minimized by the training; it is called concurrently, so it must not modify shared state
+using Objective = std::function<double(std::span<const double>)>;
+
+struct DifferentialEvolutionSettings {
+  std::size_t population_size{20};
+  std::size_t generations{100};
+  double mutation_factor{0.8};
+  double crossover_rate{0.9};
+  // Threads evaluating the population, 0 means all the hardware threads
+  std::size_t threads{1};
+  std::uint64_t seed{1};
+  // The training stops after the generation reaching this objective value
+  double target_value{-std::numeric_limits<double>::infinity()};
+  // The state is checkpointed to the file every checkpoint_generations generations and when the training finishes; no
+  // checkpoints for an empty file name or 0 generations
+  std::string checkpoint_file;
+  std::size_t checkpoint_generations{0};
+};
+
+struct TrainingState {
+  std::size_t generation{0};
+  Parameters best_parameters;
+  double best_value{std::numeric_limits<double>::infinity()};
+  // Objective evaluations since the start or the restore of the training
+  std::size_t evaluations{0};
+};
+
+// Called on the training thread each time the best parameters improve
+using ImprovementCallback = std::function<void(const TrainingState&)>;
+// Called on the training thread before each generation with its number, the first one being 1, e.g. to draw the
+// mini-batch the objective scores next
+using GenerationCallback = std::function<void(std::size_t)>;
+
+// DifferentialEvolution minimizes an objective with the DE/rand/1/bin scheme. The trial vectors of a generation are
+// generated on the training thread and evaluated concurrently on a thread pool; selection and the best-so-far tracking
+// happen on the training thread after each generation, so results do not depend on the threads count. Lower and
+// upper bounds are used for the initial population only; the objective should penalize the points out of them
+class DifferentialEvolution {
+public:
+  DifferentialEvolution(Parameters lower_bounds, Parameters upper_bounds, const DifferentialEvolutionSettings& settings);
+
+  // Creates the initial population around the start parameters: the start itself and members uniformly spread within
+  // the bounds
+  void initialize(const Parameters& start, const Objective& objective);
+  // Runs a single generation; returns true when the best parameters improved
+  auto step(const Objective& objective) -> bool;
+  // Initializes and runs the generations until their limit or the target value is reached
+  auto run(const Parameters& start, const Objective& objective, const ImprovementCallback& on_improvement = {}) -> TrainingState;
+  // Runs the generations of the initialized or restored population until their limit or the target value is reached
+  auto resume(const Objective& objective, const ImprovementCallback& on_improvement = {}) -> TrainingState;
+
+  // Changes the objective before each generation; the population is scored again after it, along with the trial
+  // vectors in the same concurrent pass, so the selection and the best parameters compare the values of the same
+  // objective at the cost of a population evaluation per generation, see TrainingState::evaluations. The values are
+  // estimates then, so the target value stops the training only when the confirming objective, e.g. of the full
+  // dataset, scores the best parameters within it too; without it the target is not checked while resampling
+  void set_resampling(GenerationCallback resample, Objective confirm = {}) {
+    this->resample = std::move(resample);
+    this->confirm = std::move(confirm);
+    confirmed_value = std::numeric_limits<double>::infinity();
+  }
+  // Scores the population with the objective and takes its best member as the best parameters, e.g. to verify the
+  // training of mini-batches on the full dataset
+  auto reevaluate(const Objective& objective) -> const TrainingState&;
+
+  // Checkpoint of the generation, the best parameters, the population with its objective values and the random
+  // generator, so the restored training continues exactly as the interrupted one would. The file is written to a
+  // temporary one first and renamed, so a restart never sees a partial checkpoint
+  void save_checkpoint(const std::string& file) const;
+  // Restores the checkpoint of a training of the same population size and dimensions
+  void restore(const std::string& file);
+
+  [[nodiscard]] auto get_state() const -> const TrainingState& { return state; }
+  [[nodiscard]] auto is_target_reached() const -> bool {
+    return (resample ? confirmed_value : state.best_value) <= settings.target_value;
+  }
+  [[nodiscard]] auto is_finished() const -> bool { return is_target_reached() || state.generation >= settings.generations; }
+
+private:
+  void evaluate(const Objective& objective, const std::vector<Parameters>& candidates, std::vector<double>& values);
+  void checkpoint_generation() const;
+  auto update_best() -> bool;
+
+  Parameters lower_bounds;
+  Parameters upper_bounds;
+  DifferentialEvolutionSettings settings;
+  parallel::ThreadPool thread_pool;
+  std::mt19937_64 generator;
+  std::vector<Parameters> population;
+  std::vector<double> population_values;
+  TrainingState state;
+  GenerationCallback resample;
+  Objective confirm;
+  // Confirming objective value of the best parameters, checked once their resampled value reaches the target
+  double confirmed_value{std::numeric_limits<double>::infinity()};
+};
+
+// Objective writing its gradient at the parameters into the second argument, see minimize_gradient in optimizer.hpp
+using DifferentiableObjective = std::function<double(std::span<const double>, std::span<double>)>;
+
+namespace checkpoint_format {
+inline constexpr std::string_view magic{"fuzzyRulesML-DE-checkpoint"};
+inline constexpr std::uint32_t version = 1;
+} // namespace checkpoint_format
+
+// Best parameters of a checkpoint, e.g. to start inference from a trained model
+[[nodiscard]] auto read_checkpoint_parameters(const std::string& file) -> Parameters;
+} // namespace fuzzyrulesml::training
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "membership_functions.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <format>
 #include <map>
 #include <print>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -46,7 +49,9 @@ template <typename VARIABLE> class FuzzyValue;
 template <typename UNDERLYING_TYPE> class FuzzyVariable {
 public:
   using UnderlyingType = UNDERLYING_TYPE;
-  FuzzyVariable(std::string_view name, const initial_distribution::Uniform<UnderlyingType>& distribution);
+  // The id is a dense index of the variable within its rules set, see RulesSet::add_input_variable; the variables are
+  // compared by their ids, the names are kept for I/O only
+  FuzzyVariable(std::string_view name, const initial_distribution::Uniform<UnderlyingType>& distribution, std::size_t id);
   ~FuzzyVariable() = default;
   FuzzyVariable(const FuzzyVariable& other) = default;
   FuzzyVariable(FuzzyVariable&& other) noexcept = default;
@@ -55,12 +60,18 @@ public:
   [[nodiscard]] auto operator=(FuzzyVariable&& other) noexcept -> FuzzyVariable&;
   [[nodiscard]] auto operator()(const UnderlyingType& value) const -> FuzzyValue<UnderlyingType>;
   [[nodiscard]] auto operator()(const CrispValuesUnion& value) const -> FuzzyValue<UnderlyingType>;
+  // Column fuzzification, see fuzzyrulesml::mfunct::fuzzify_column
+  void fuzzify(std::span<const double> values, std::span<std::uint32_t> segments, std::span<double> degrees) const;
+  // Column fuzzification with the given characteristic points instead of the variable ones
+  void fuzzify(std::span<const double> points, std::span<const double> values, std::span<std::uint32_t> segments,
+               std::span<double> degrees) const;
   [[nodiscard]] auto operator==(const FuzzyVariable& other) const -> bool;
   [[nodiscard]] auto operator==(std::string_view name) const -> bool;
   [[nodiscard]] auto operator<(const FuzzyVariable& other) const -> bool;
-  [[nodiscard]] auto compare(const auto& other) const -> bool { return this->name < other.get_name(); }
+  [[nodiscard]] auto compare(const auto& other) const -> bool { return this->id < other.get_id(); }
 
-  [[nodiscard]] auto get_name() const -> std::string { return name; }
+  [[nodiscard]] auto get_name() const -> const std::string& { return name; }
+  [[nodiscard]] auto get_id() const -> std::size_t { return id; }
   [[nodiscard]] auto size() const -> int { return distribution.get_categories(); }
 
   void set_points(const std::vector<double>& characteristic_points) { distribution.set_points(characteristic_points); };
@@ -68,6 +79,7 @@ public:
 
 private:
   std::string name;
+  std::size_t id;
   fuzzyrulesml::mfunct::LinearDistribution<UNDERLYING_TYPE> distribution;
 };
 
@@ -86,28 +98,20 @@ private:
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename UNDERLYING_TYPE>
 inline auto make_linear_distribution(const initial_distribution::Uniform<UNDERLYING_TYPE>& distribution) {
-  const auto number_of_internal_functions = distribution.get_categories() - 2;
   const auto section_length =
       static_cast<UNDERLYING_TYPE>(distribution.get_max() - distribution.get_min()) / (distribution.get_categories() - 1);
-  const auto left = fuzzyrulesml::mfunct::LinearMemberFunctDesc{distribution.get_min(),
-                                                                distribution.get_min() + static_cast<UNDERLYING_TYPE>(section_length)};
-  const auto right = fuzzyrulesml::mfunct::LinearMemberFunctAsc(distribution.get_max() - static_cast<UNDERLYING_TYPE>(section_length),
-                                                                distribution.get_max());
-  std::vector<fuzzyrulesml::mfunct::LinearMemberFunct<UNDERLYING_TYPE>> functions;
-  for (std::size_t i = 0; i < number_of_internal_functions; i++) {
-    functions.push_back(
-        fuzzyrulesml::mfunct::LinearMemberFunct{distribution.get_min() + static_cast<UNDERLYING_TYPE>(i * section_length),
-                                                distribution.get_min() + static_cast<UNDERLYING_TYPE>((i + 1) * section_length),
-                                                distribution.get_min() + static_cast<UNDERLYING_TYPE>((i + 2) * section_length)});
-    const auto& added = functions.back();
-    std::print("Adding midfunction {} {} {} {}\n", section_length, added.get_left_bound(), added.get_peak(), added.get_right_bound());
+  std::vector<UNDERLYING_TYPE> points;
+  for (std::size_t i = 0; i + 1 < distribution.get_categories(); i++) {
+    points.push_back(distribution.get_min() + static_cast<UNDERLYING_TYPE>(i * section_length));
   }
-  return fuzzyrulesml::mfunct::LinearDistribution{fuzzyrulesml::mfunct::LinearDistribution{left, functions, right}};
+  points.push_back(distribution.get_max());
+  return fuzzyrulesml::mfunct::LinearDistribution<UNDERLYING_TYPE>{std::move(points)};
 };
 
 template <typename UNDERLYING_TYPE>
-FuzzyVariable<UNDERLYING_TYPE>::FuzzyVariable(std::string_view name, const initial_distribution::Uniform<UNDERLYING_TYPE>& distribution)
-    : name(name), distribution(make_linear_distribution(distribution)){};
+FuzzyVariable<UNDERLYING_TYPE>::FuzzyVariable(std::string_view name, const initial_distribution::Uniform<UNDERLYING_TYPE>& distribution,
+                                              std::size_t id)
+    : name(name), id(id), distribution(make_linear_distribution(distribution)){};
 
 template <typename UNDERLYING_TYPE>
 auto FuzzyVariable<UNDERLYING_TYPE>::operator()(const UnderlyingType& value) const -> FuzzyValue<UNDERLYING_TYPE> {
@@ -118,6 +122,33 @@ template <> inline auto FuzzyVariable<int>::operator()(const UnderlyingType& /*u
   return FuzzyValue<int>({}); // NOLINT(modernize-return-braced-init-list)
 }
 
+template <typename UNDERLYING_TYPE>
+void FuzzyVariable<UNDERLYING_TYPE>::fuzzify(std::span<const double> values, std::span<std::uint32_t> segments,
+                                             std::span<double> degrees) const {
+  this->distribution.fuzzify(values, segments, degrees);
+}
+
+template <>
+inline void FuzzyVariable<int>::fuzzify(std::span<const double> values, std::span<std::uint32_t> segments,
+                                        std::span<double> /*unused*/) const {
+  std::fill_n(segments.begin(), values.size(), fuzzyrulesml::mfunct::no_segment);
+}
+
+template <typename UNDERLYING_TYPE>
+void FuzzyVariable<UNDERLYING_TYPE>::fuzzify(std::span<const double> points, std::span<const double> values,
+                                             std::span<std::uint32_t> segments, std::span<double> degrees) const {
+  if (points.size() != this->distribution.get_categories()) {
+    throw std::runtime_error("Invalid number of characteristic points");
+  }
+  fuzzyrulesml::mfunct::fuzzify_column(points, values, segments, degrees);
+}
+
+template <>
+inline void FuzzyVariable<int>::fuzzify(std::span<const double> /*unused*/, std::span<const double> values,
+                                        std::span<std::uint32_t> segments, std::span<double> /*unused*/) const {
+  std::fill_n(segments.begin(), values.size(), fuzzyrulesml::mfunct::no_segment);
+}
+
 template <typename UNDERLYING_TYPE>
 auto FuzzyVariable<UNDERLYING_TYPE>::operator()(const CrispValuesUnion& value) const -> FuzzyValue<UNDERLYING_TYPE> {
   const auto decoded_value = value.get<UNDERLYING_TYPE>();
@@ -125,7 +156,7 @@ auto FuzzyVariable<UNDERLYING_TYPE>::operator()(const CrispValuesUnion& value) c
 }
 
 template <typename UNDERLYING_TYPE> auto FuzzyVariable<UNDERLYING_TYPE>::operator==(const FuzzyVariable& other) const -> bool {
-  return this->name == other.name;
+  return this->id == other.id;
 }
 
 template <typename UNDERLYING_TYPE> auto FuzzyVariable<UNDERLYING_TYPE>::operator==(std::string_view name) const -> bool {
@@ -133,13 +164,14 @@ template <typename UNDERLYING_TYPE> auto FuzzyVariable<UNDERLYING_TYPE>::operato
 }
 
 template <typename UNDERLYING_TYPE> auto FuzzyVariable<UNDERLYING_TYPE>::operator<(const FuzzyVariable& other) const -> bool {
-  return this->name < other.name;
+  return this->id < other.id;
 }
 
 template <typename UNDERLYING_TYPE>
 auto FuzzyVariable<UNDERLYING_TYPE>::operator=(const FuzzyVariable<UNDERLYING_TYPE>& other) -> FuzzyVariable<UNDERLYING_TYPE>& {
   if (this != &other) {
     name = other.name;
+    id = other.id;
   }
   return *this;
 }
@@ -147,6 +179,7 @@ template <typename UNDERLYING_TYPE>
 auto FuzzyVariable<UNDERLYING_TYPE>::operator=(FuzzyVariable<UNDERLYING_TYPE>&& other) noexcept -> FuzzyVariable<UNDERLYING_TYPE>& {
   if (this != &other) {
     name = std::move(other.name);
+    id = other.id;
   }
   return *this;
 }
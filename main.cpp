@@ -1,14 +1,23 @@
+#include "lib/binary_dataset.hpp"
 #include "lib/dataset.hpp"
+#include "lib/gradient.hpp"
+#include "lib/loader.hpp"
+#include "lib/minibatch.hpp"
 #include "lib/optimizer.hpp"
 #include "lib/reasoner.hpp"
 #include "lib/rules.hpp"
+#include "lib/rules_pruning.hpp"
+#include "lib/training.hpp"
 #include <CLI/CLI.hpp>
+#include <filesystem>
+#include <optional>
 #include <string>
 #include <tuple>
 
 namespace fru = fuzzyrulesml::rules;
 namespace fre = fuzzyrulesml::reasoner;
 namespace fdd = fuzzyrulesml::dataset;
+namespace frt = fuzzyrulesml::training;
 
 const int small = 0;
 const int large = 1;
@@ -38,97 +47,178 @@ auto get_rules_set(std::vector<double> vector_variables) {
   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
   return std::tuple{rules_set, sepal_length, sepal_width, petal_length, petal_width};
 }
+
+auto get_iris_columns(const auto& store) -> std::vector<std::span<const double>> {
+  return {store.get_column("sepal length"), store.get_column("sepal width"), store.get_column("petal length"),
+          store.get_column("petal width")};
+}
+
+// Binds the columns returned by get_iris_columns to the variables, carrying the current characteristic points
+auto get_batch_inputs(const std::vector<std::span<const double>>& columns, const auto& sepal_length, const auto& sepal_width,
+                      const auto& petal_length, const auto& petal_width) -> fru::BatchInputs {
+  fru::BatchInputs inputs;
+  inputs.add_column(sepal_length, columns[0]);
+  inputs.add_column(sepal_width, columns[1]);
+  inputs.add_column(petal_length, columns[2]);
+  inputs.add_column(petal_width, columns[3]);
+  return inputs;
+}
 } // namespace
 
-auto run_test(const auto features, const auto targets, const auto sepal_length, const auto sepal_width, const auto petal_length,
-              const auto petal_width, const auto reasoner, const bool print) -> void {
-  fdd::DataSet data_set(features, targets);
-  const auto test_data = data_set.get_items(std::pair{"sepal length", sepal_length}, std::pair{"sepal width", sepal_width},
-                                            std::pair{"petal length", petal_length}, std::pair{"petal width", petal_width});
+auto run_test(const auto& store, const auto sepal_length, const auto sepal_width, const auto petal_length,
+              const auto petal_width, const auto reasoner, const bool print, const std::size_t threads) -> void {
   if (print) {
-    test_data.print();
+    // The view reads the columns of the store in place, a mapped file is not copied
+    fdd::get_items(store, std::pair{"sepal length", sepal_length}, std::pair{"sepal width", sepal_width},
+                   std::pair{"petal length", petal_length}, std::pair{"petal width", petal_width})
+        .print();
   }
-  auto goal_func = calculate_one(test_data, reasoner, print);
+  const auto inputs = get_batch_inputs(get_iris_columns(store), sepal_length, sepal_width, petal_length, petal_width);
+  auto goal_func = calculate_one(inputs, store.get_targets(), store.get_classes(), reasoner, print, threads);
   std::print("Goal function value : {}\n", goal_func);
 }
 
-auto run_training(const auto features, const auto targets, auto sepal_length, auto sepal_width, auto petal_length, auto petal_width,
-                  auto reasoner, const bool print) -> void {
+auto run_training(const auto& store, const auto& sepal_length, const auto& sepal_width, const auto& petal_length,
+                  const auto& petal_width, const auto& reasoner, const bool print, const std::size_t threads,
+                  const std::string& checkpoint, const std::size_t batch_rows) -> void {
   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
-  const auto lower_bounds = Eigen::Matrix<double, 8, 1>(0.0, 7.9, 0.0, 4.4, 0.0, 6.9, -1.0, 2.5);
-  const auto upper_bounds = Eigen::Matrix<double, 8, 1>(4.3, 15.0, 2.0, 15.0, 1.0, 15.0, 0.1, 15.0);
+  const std::vector<double> lower_bounds{0.0, 7.9, 0.0, 4.4, 0.0, 6.9, -1.0, 2.5};
+  const std::vector<double> upper_bounds{4.3, 15.0, 2.0, 15.0, 1.0, 15.0, 0.1, 15.0};
   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
 
-  fdd::DataSet data_set(features, targets);
-  // NOLINTBEGIN(performance-unnecessary-value-param)
-  auto dataset_opt_fn = [sepal_length, sepal_width, petal_length, petal_width, &reasoner, &data_set, lower_bounds, upper_bounds,
-                         print](const Eigen::VectorXd local_vals_inp, Eigen::VectorXd *, void *) {
-    // NOLINTEND(performance-unnecessary-value-param)
-    auto local_reasoner = reasoner;
-    auto sepal_length_local = sepal_length;
-    auto sepal_width_local = sepal_width;
-    auto petal_length_local = petal_length;
-    auto petal_width_local = petal_width;
+  // Targets are the class ids of the store, compared with the class ids of the conclusions
+  const auto dataset_targets = store.get_targets();
+  const auto& dataset_classes = store.get_classes();
 
-    // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
-    sepal_length_local.set_points({local_vals_inp(0), local_vals_inp(1)});
-    sepal_width_local.set_points({local_vals_inp(2), local_vals_inp(3)});
-    petal_length_local.set_points({local_vals_inp(4), local_vals_inp(5)});
-    petal_width_local.set_points({local_vals_inp(6), local_vals_inp(7)});
-    // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+  // The parameters are the characteristic points of the variables in the columns order: sepal length (2 points), sepal
+  // width, petal length and petal width; candidates are scored through the binding, without copying the variables
+  const auto inputs = get_batch_inputs(get_iris_columns(store), sepal_length, sepal_width, petal_length, petal_width);
+  const fru::ParametersBinding binding{inputs};
 
-    const auto test_data = data_set.get_items(std::pair{"sepal length", sepal_length_local}, std::pair{"sepal width", sepal_width_local},
-                                              std::pair{"petal length", petal_length_local}, std::pair{"petal width", petal_width_local});
-    if (print) {
-      test_data.print();
-    }
-    static auto gfunc = static_cast<double>(test_data.size());
-    const auto goal_func = calculate_one(test_data, local_reasoner, print);
-    auto opt_target = double(test_data.size()) - goal_func;
+  // Mini-batches of batch_rows rows drawn again each generation, or the full dataset for 0 or as many rows as it has
+  const auto seed = frt::DifferentialEvolutionSettings{}.seed;
+  std::optional<frt::StratifiedBatches> batches;
+  if (batch_rows > 0 && batch_rows < inputs.get_rows()) {
+    batches.emplace(inputs, dataset_targets, batch_rows, seed);
+  }
+
+  // Called concurrently for the population members, so the dataset is evaluated on a single thread here; the
+  // misclassified rows of a mini-batch are scaled to the dataset rows, keeping the target value of the full dataset
+  auto penalized_opt_fn = [&binding, &reasoner, dataset_targets, &dataset_classes, &lower_bounds, &upper_bounds](
+                              const fru::BatchInputs& objective_inputs, std::span<const std::uint32_t> targets,
+                              std::span<const double> parameters) {
+    const auto goal_func = calculate_one(objective_inputs, binding, parameters, targets, dataset_classes, reasoner, false);
+    auto opt_target = (double(targets.size()) - goal_func) * double(dataset_targets.size()) / double(targets.size());
     const auto min_span = 0.5;
     // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
-    if (local_vals_inp(1) - local_vals_inp(0) < min_span || local_vals_inp(3) - local_vals_inp(2) < min_span ||
-        local_vals_inp(5) - local_vals_inp(4) < min_span || local_vals_inp(7) - local_vals_inp(6) < min_span) {
+    if (parameters[1] - parameters[0] < min_span || parameters[3] - parameters[2] < min_span || parameters[5] - parameters[4] < min_span ||
+        parameters[7] - parameters[6] < min_span) {
       opt_target += 30.0;
     }
-    for (int i = 0; i < 8; ++i) {
-      if (local_vals_inp(i) < lower_bounds(i) || local_vals_inp(i) > upper_bounds(i)) {
+    for (std::size_t i = 0; i < parameters.size(); ++i) {
+      if (parameters[i] < lower_bounds[i] || parameters[i] > upper_bounds[i]) {
         opt_target += 30.0;
       }
     }
-
-    if (opt_target < gfunc) {
-      std::print("Opt_target : {:.6f}\t goal_func {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t "
-                 "{:.6f}\t {:.6f}\t\n ",
-                 opt_target, goal_func, local_vals_inp(0), local_vals_inp(1), local_vals_inp(2), local_vals_inp(3), local_vals_inp(4),
-                 local_vals_inp(5), local_vals_inp(6), local_vals_inp(7));
-      gfunc = opt_target;
-      if (opt_target <= 3.1) {
-        std::print("Computations finished\n");
-        exit(0);
-      }
-      // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
-    }
+    // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
     return opt_target;
   };
+  auto dataset_opt_fn = [&penalized_opt_fn, &inputs, dataset_targets](std::span<const double> parameters) {
+    return penalized_opt_fn(inputs, dataset_targets, parameters);
+  };
+  auto batch_opt_fn = [&penalized_opt_fn, &batches, &dataset_opt_fn](std::span<const double> parameters) {
+    return batches ? penalized_opt_fn(batches->get_inputs(), batches->get_targets(), parameters) : dataset_opt_fn(parameters);
+  };
+
+  const auto start_parameters = binding.get_parameters();
+  const std::vector<double> start_vector{start_parameters.begin(), start_parameters.end()};
+
+  frt::DifferentialEvolutionSettings settings;
+  // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+  settings.population_size = 20;
+  settings.generations = 100;
+  settings.target_value = 3.1;
+  // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+  settings.threads = threads;
+  settings.seed = seed;
+  // A checkpoint per generation costs little against evaluating the dataset for the population
+  settings.checkpoint_file = checkpoint;
+  settings.checkpoint_generations = 1;
+
+  frt::DifferentialEvolution optimizer{lower_bounds, upper_bounds, settings};
+  // Goal function of the rows the objective scores, the mini-batch when training on them
+  const auto on_improvement = [&](const frt::TrainingState& state) {
+    const auto& best = state.best_parameters;
+    const auto goal_func = batches ? calculate_one(batches->get_inputs(), binding, best, batches->get_targets(), dataset_classes, reasoner, print)
+                                   : calculate_one(inputs, binding, best, dataset_targets, dataset_classes, reasoner, print);
+    std::print("Generation {}\t Opt_target : {:.6f}\t goal_func {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t "
+               "{:.6f}\t {:.6f}\t\n",
+               state.generation, state.best_value, goal_func, best[0], best[1], best[2], best[3], best[4], best[5], best[6], best[7]);
+  };
+  // An existing checkpoint resumes the training from its generation
+  const auto resumed = not checkpoint.empty() && std::filesystem::exists(checkpoint);
+  if (resumed) {
+    optimizer.restore(checkpoint);
+    std::print("Resumed from generation {} of {}\n", optimizer.get_state().generation, checkpoint);
+  }
+  // The values of the mini-batches are estimates: the target value stops the training once the full dataset confirms it
+  if (batches) {
+    optimizer.set_resampling([&batches](std::size_t generation) { batches->resample(generation); }, dataset_opt_fn);
+  }
+  auto result = resumed ? optimizer.resume(batch_opt_fn, on_improvement) : optimizer.run(start_vector, batch_opt_fn, on_improvement);
+  // A generation of mini-batches scores the population again along with the trials, twice the evaluations of the rows
+  std::print("Objective evaluations: {} in {} generations\n", result.evaluations, result.generation);
+  // The final population is scored on the full dataset and its best member is the result
+  if (batches) {
+    optimizer.set_resampling({});
+    result = optimizer.reevaluate(dataset_opt_fn);
+    const auto& best = result.best_parameters;
+    const auto goal_func = calculate_one(inputs, binding, best, dataset_targets, dataset_classes, reasoner, print);
+    std::print("Full dataset\t Opt_target : {:.6f}\t goal_func {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t "
+               "{:.6f}\t\n",
+               result.best_value, goal_func, best[0], best[1], best[2], best[3], best[4], best[5], best[6], best[7]);
+    if (not checkpoint.empty()) {
+      optimizer.save_checkpoint(checkpoint);
+    }
+  }
+  if (optimizer.is_target_reached()) {
+    std::print("Computations finished\n");
+  } else {
+    std::print("Generations limit reached, best opt_target : {:.6f}\n", result.best_value);
+  }
+}
 
-  const auto sepal_length_points = sepal_length.get_points();
-  const auto sepal_width_points = sepal_width.get_points();
-  const auto petal_length_points = petal_length.get_points();
-  const auto petal_width_points = petal_width.get_points();
+// Tunes the characteristic points by Adam or L-BFGS on the cross entropy of the normalized scores, one
+// dataset pass per objective evaluation with the exact gradient, instead of the population search of run_training
+auto run_gradient_training(const auto& store, const auto& sepal_length, const auto& sepal_width, const auto& petal_length,
+                           const auto& petal_width, const auto& reasoner, const bool print, const std::size_t threads,
+                           const frt::GradientMethod method) -> void {
+  const auto inputs = get_batch_inputs(get_iris_columns(store), sepal_length, sepal_width, petal_length, petal_width);
+  const fru::ParametersBinding binding{inputs};
+  const auto dataset_targets = store.get_targets();
+  const auto& dataset_classes = store.get_classes();
+  const frt::CrossEntropyLoss loss{reasoner, inputs, dataset_targets, dataset_classes};
 
+  frt::GradientSettings settings{.method = method};
   // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
-  Eigen::VectorXd start_vector =
-      Eigen::Matrix<double, 8, 1>(sepal_length_points[0], sepal_length_points[1], sepal_width_points[0], sepal_width_points[1],
-                                  petal_length_points[0], petal_length_points[1], petal_width_points[0], petal_width_points[1]);
-
-  optim::algo_settings_t settings;
-  settings.de_settings.check_freq = 10;
-  settings.print_level = 3;
-  settings.de_settings.n_pop = 20;
-  settings.de_settings.n_gen = 100;
+  settings.iterations = 300;
+  settings.learning_rate = 0.05;
+  const auto min_span = 0.5;
   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
-  optim::de(start_vector, dataset_opt_fn, &settings);
+  const auto objective = [&loss, min_span, threads](std::span<const double> parameters, std::span<double> gradient) {
+    return loss.evaluate_unconstrained(parameters, gradient, min_span, threads);
+  };
+  const auto [result, converged] = frt::minimize_gradient(loss.to_unconstrained(binding.get_parameters(), min_span), objective, settings);
+  const auto best = loss.from_unconstrained(result.best_parameters, min_span);
+  const auto goal_func = calculate_one(inputs, binding, best, dataset_targets, dataset_classes, reasoner, print, threads);
+  std::print("Dataset passes {}\t Loss : {:.6f}\t goal_func {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t {:.6f}\t "
+             "{:.6f}\t\n",
+             result.evaluations, result.best_value, goal_func, best[0], best[1], best[2], best[3], best[4], best[5], best[6], best[7]);
+  if (converged) {
+    std::print("Computations finished\n");
+  } else {
+    std::print("Not converged in {} iterations, best loss : {:.6f}\n", result.generation, result.best_value);
+  }
 }
 
 auto main(int argc, char **argv) -> int {
@@ -137,17 +227,47 @@ auto main(int argc, char **argv) -> int {
     argv = app.ensure_utf8(argv);
 
     std::string input_file;
-    app.add_option("-i,--input", input_file, "Input file");
+    app.add_option("-i,--input", input_file, "Input file: features JSON or CSV with the class column");
     std::string target_file;
-    app.add_option("-t,--target", target_file, "Target file");
+    app.add_option("-t,--target", target_file, "Target file, for the JSON input");
+    std::string convert_file;
+    app.add_option("--convert", convert_file, "Convert the input to the binary columnar file and exit");
     std::vector<double> test_vector{};
     app.add_option<std::vector<double>>("--test_vector", test_vector, "Vector of model params");
+    std::string checkpoint_file;
+    app.add_option("--checkpoint", checkpoint_file,
+                   "Training checkpoint: written each generation and resumed from when training, the model params when testing");
     bool train = false;
     app.add_option("--train", train, "Train the model, false - test the model");
     bool print = false;
     app.add_option("--print", print, "Print internal results");
+    std::size_t threads = 1;
+    app.add_option("--threads", threads, "Number of threads evaluating the dataset or the training population, 0 - all hardware threads");
+
+    std::size_t batch_rows = 0;
+    app.add_option("--batch_rows", batch_rows,
+                   "Training on stratified mini-batches of N rows drawn each generation, verified on the full dataset; "
+                   "0 - full dataset");
+
+    std::string gradient;
+    app.add_option("--gradient", gradient, "Train the model by the gradient of the cross entropy instead of the differential evolution")
+        ->check(CLI::IsMember({"adam", "lbfgs"}));
+
+    bool compact = false;
+    app.add_option("--compact", compact, "Remove the dominated and the dead rules on the input and merge the rules of the same conclusion");
 
     CLI11_PARSE(app, argc, argv);
+    if (not convert_file.empty() && input_file.ends_with(".bin")) {
+      throw CLI::ValidationError("--convert", "the input is a binary columnar file already");
+    }
+    // The gradient training neither writes the checkpoints nor draws the mini-batches; a test run still reads the model
+    // params of --checkpoint
+    if (train && not gradient.empty() && (not checkpoint_file.empty() || batch_rows > 0)) {
+      throw CLI::ValidationError("--gradient", "the gradient training takes neither --checkpoint nor --batch_rows");
+    }
+    if (not train && test_vector.empty() && not checkpoint_file.empty()) {
+      test_vector = frt::read_checkpoint_parameters(checkpoint_file);
+    }
 
     auto [rules_set, sepal_length, sepal_width, petal_length, petal_width] = get_rules_set(test_vector);
     const auto output_variable = rules_set.add_output_variable("iris_type", {"Iris-setosa", "Iris-versicolor", "Iris-virginica"});
@@ -181,14 +301,39 @@ auto main(int argc, char **argv) -> int {
     add_rule(large, large, large, small, versicolor); // 15
     add_rule(large, large, large, large, virginica);  // 16
 
-    const fre::SimpleReasoner reasoner{rules_set};
-    const auto [features, targets] = fdd::load_data(input_file, target_file);
-
-    if (train) {
-      run_training(features, targets, sepal_length, sepal_width, petal_length, petal_width, reasoner, print);
-    } else {
-      run_test(features, targets, sepal_length, sepal_width, petal_length, petal_width, reasoner, print);
+    const auto run = [&](const auto& store) {
+      // The merged rules score the same at any points for the values of the input, the dominated and the dead ones are
+      // found for the current points
+      if (compact) {
+        const auto inputs = get_batch_inputs(get_iris_columns(store), sepal_length, sepal_width, petal_length, petal_width);
+        auto compacted = fru::compact_rules(fre::SimpleReasoner{rules_set}, inputs, store.get_targets(), store.get_classes(), threads);
+        std::print("Rules compacted from {} to {}: {} dominated, {} merged, {} dead\n", rules_set.get_rules_count(),
+                   compacted.rules_set.get_rules_count(), compacted.dominated, compacted.merged, compacted.dead);
+        rules_set = std::move(compacted.rules_set);
+      }
+      const fre::SimpleReasoner reasoner{rules_set};
+      if (train && not gradient.empty()) {
+        run_gradient_training(store, sepal_length, sepal_width, petal_length, petal_width, reasoner, print, threads,
+                              gradient == "lbfgs" ? frt::GradientMethod::lbfgs : frt::GradientMethod::adam);
+      } else if (train) {
+        run_training(store, sepal_length, sepal_width, petal_length, petal_width, reasoner, print, threads, checkpoint_file, batch_rows);
+      } else {
+        run_test(store, sepal_length, sepal_width, petal_length, petal_width, reasoner, print, threads);
+      }
+    };
+    // The binary columnar file is mapped without reading the rows; other inputs are streamed into the columnar store: a
+    // CSV file with the class column, or the features and targets JSON files
+    if (input_file.ends_with(".bin")) {
+      run(fdd::MappedDataset{input_file});
+      return 0;
+    }
+    const auto store = input_file.ends_with(".csv") ? fdd::load_columnar_csv(input_file) : fdd::load_columnar(input_file, target_file);
+    if (not convert_file.empty()) {
+      fdd::write_binary(store, convert_file);
+      std::print("Converted {} rows to {}\n", store.get_rows(), convert_file);
+      return 0;
     }
+    run(store);
   } catch (const CLI::ParseError& parse_error) {
     std::cerr << "Parse error: " << parse_error.what() << "\n";
     return 1;
@@ -0,0 +1,25 @@
+#include "allocation_counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::size_t> allocations{0}; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+}
+
+// Replacements of the global allocation functions, counting every allocation of the test binary
+auto operator new(std::size_t size) -> void* {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) { // NOLINT(cppcoreguidelines-no-malloc)
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); } // NOLINT(cppcoreguidelines-no-malloc)
+
+void operator delete(void* pointer, std::size_t /*unused*/) noexcept { std::free(pointer); } // NOLINT(cppcoreguidelines-no-malloc)
+
+namespace fuzzyrulesml::testing {
+auto allocations_count() -> std::size_t { return allocations.load(std::memory_order_relaxed); }
+} // namespace fuzzyrulesml::testing
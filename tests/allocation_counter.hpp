@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+namespace fuzzyrulesml::testing {
+// Number of the global operator new calls made by the test binary so far
+[[nodiscard]] auto allocations_count() -> std::size_t;
+
+// AllocationCounter reports the number of heap allocations made since it was created
+class AllocationCounter {
+public:
+  AllocationCounter() : start{allocations_count()} {}
+  [[nodiscard]] auto count() const -> std::size_t { return allocations_count() - start; }
+
+private:
+  std::size_t start;
+};
+} // namespace fuzzyrulesml::testing
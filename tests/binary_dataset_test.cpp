@@ -0,0 +1,115 @@
+#include "binary_dataset.hpp"
+#include "columnar.hpp"
+#include "dataset.hpp"
+#include "rules.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+namespace fdd = fuzzyrulesml::dataset;
+namespace fru = fuzzyrulesml::rules;
+
+namespace {
+// Binary file in the temporary directory, removed at the end of the test
+class TemporaryFile {
+public:
+  explicit TemporaryFile(const std::string& name)
+      : path{(std::filesystem::temp_directory_path() / ("fuzzyRulesML_test_" + name)).string()} {}
+  ~TemporaryFile() { std::filesystem::remove(path); }
+  TemporaryFile(const TemporaryFile&) = delete;
+  auto operator=(const TemporaryFile&) -> TemporaryFile& = delete;
+  [[nodiscard]] auto get() const -> const std::string& { return path; }
+
+private:
+  std::string path;
+};
+
+auto make_store() -> fdd::ColumnarStore {
+  fdd::ColumnarStore store{{"sepal length", "petal length", "petal width"}};
+  const auto setosa = store.intern_class("Iris-setosa");
+  const auto virginica = store.intern_class("Iris-virginica");
+  store.add_row(std::vector<double>{5.1, 1.4, 0.2}, setosa);
+  store.add_row(std::vector<double>{6.3, 6.0, 2.5}, virginica);
+  store.add_row(std::vector<double>{4.9, 1.5, 0.1}, setosa);
+  return store;
+}
+} // namespace
+
+TEST(MappedDataset, reads_written_store_in_place) {
+  const TemporaryFile file{"round_trip.bin"};
+  const auto store = make_store();
+  fdd::write_binary(store, file.get());
+
+  const fdd::MappedDataset mapped{file.get()};
+  EXPECT_EQ(mapped.get_rows(), 3);
+  EXPECT_THAT(mapped.get_features_names(), ::testing::ElementsAre("sepal length", "petal length", "petal width"));
+  EXPECT_THAT(mapped.get_classes(), ::testing::ElementsAre("Iris-setosa", "Iris-virginica"));
+  EXPECT_THAT(mapped.get_column("petal length"), ::testing::ElementsAre(1.4, 6.0, 1.5));
+  EXPECT_THAT(mapped.get_column(2), ::testing::ElementsAre(0.2, 2.5, 0.1));
+  EXPECT_THAT(mapped.get_targets(), ::testing::ElementsAre(0, 1, 0));
+  EXPECT_EQ(mapped.get_class(mapped.get_targets()[1]), "Iris-virginica");
+  EXPECT_EQ(mapped.find_feature("petal width"), 2);
+  EXPECT_FALSE(mapped.find_feature("sepal width"));
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mapped.get_column(0).data()) % fdd::binary_format::columns_alignment, // NOLINT
+            0);
+}
+
+TEST(MappedDataset, reads_empty_store) {
+  const TemporaryFile file{"empty.bin"};
+  fdd::write_binary(fdd::ColumnarStore{{"a"}}, file.get());
+  const fdd::MappedDataset mapped{file.get()};
+  EXPECT_EQ(mapped.get_rows(), 0);
+  EXPECT_TRUE(mapped.get_column("a").empty());
+}
+
+TEST(MappedDataset, rejects_invalid_files) {
+  const TemporaryFile file{"invalid.bin"};
+  EXPECT_ANY_THROW(fdd::MappedDataset{file.get()});
+  std::ofstream{file.get()} << R"([{"sepal length": 5.1}])";
+  EXPECT_ANY_THROW(fdd::MappedDataset{file.get()});
+
+  fdd::write_binary(make_store(), file.get());
+  const auto size = std::filesystem::file_size(file.get());
+  std::filesystem::resize_file(file.get(), size - 1);
+  EXPECT_ANY_THROW(fdd::MappedDataset{file.get()});
+  std::filesystem::resize_file(file.get(), size + 4);
+  EXPECT_ANY_THROW(fdd::MappedDataset{file.get()});
+}
+
+TEST(MappedDataset, checks_targets_against_classes) {
+  const TemporaryFile file{"bad_targets.bin"};
+  fdd::write_binary(make_store(), file.get());
+  const fdd::MappedDataset valid{file.get()};
+  EXPECT_NO_THROW(valid.check_targets());
+
+  // The target of the last row is the last uint32 of the file
+  const auto size = std::filesystem::file_size(file.get());
+  {
+    std::fstream output{file.get(), std::ios::binary | std::ios::in | std::ios::out};
+    output.seekp(static_cast<std::streamoff>(size - sizeof(std::uint32_t)));
+    const std::uint32_t corrupt_class = 7;
+    output.write(reinterpret_cast<const char*>(&corrupt_class), sizeof(corrupt_class)); // NOLINT
+  }
+  const fdd::MappedDataset corrupt{file.get()};
+  EXPECT_EQ(corrupt.get_targets()[2], 7);
+  EXPECT_ANY_THROW(corrupt.check_targets());
+}
+
+TEST(MappedDataset, items_view_reads_mapped_columns) {
+  const TemporaryFile file{"items.bin"};
+  fdd::write_binary(make_store(), file.get());
+  const fdd::MappedDataset mapped{file.get()};
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+
+  const auto items = fdd::get_items(mapped, std::pair{"petal length", petal_length});
+  ASSERT_EQ(items.size(), 3);
+  EXPECT_EQ(items.get_targets().data(), mapped.get_targets().data());
+  EXPECT_EQ(items.get_batch_inputs().get_columns().front().data(), mapped.get_column("petal length").data());
+  const auto [sample, class_id] = *std::next(items.begin(), 1);
+  EXPECT_EQ(class_id, 1);
+  EXPECT_DOUBLE_EQ(sample.find(petal_length)->second.get<double>(), 6.0);
+}
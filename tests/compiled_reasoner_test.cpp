@@ -0,0 +1,84 @@
+#include "allocation_counter.hpp"
+#include "compiled_reasoner.hpp"
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+namespace fru = fuzzyrulesml::rules;
+namespace fre = fuzzyrulesml::reasoner;
+
+namespace {
+// Scores of the compiled reasoner against the map-based do_reasoning, the sepal width variable not tested by any rule
+void expect_same_scores(const fru::RulesSet& rules_set, fre::RulesLayout layout) {
+  const fre::SimpleReasoner reasoner{rules_set};
+  fre::CompiledReasoner compiled{rules_set, layout};
+  ASSERT_EQ(compiled.get_slots_count(), 3);
+  ASSERT_EQ(compiled.get_conclusions().size(), reasoner.get_conclusions().size());
+  const auto& variables = rules_set.get_input_variables();
+  const auto length_slot = compiled.get_slot("petal_length");
+  const auto width_slot = compiled.get_slot("petal_width");
+  const auto sepal_slot = compiled.get_slot("sepal_width");
+  const std::size_t rows = 50;
+  const auto conclusions_count = reasoner.get_conclusions().size();
+  std::array<double, 3> values{};
+  std::vector<double> scores(rows * conclusions_count);
+  {
+    const fuzzyrulesml::testing::AllocationCounter allocations;
+    for (std::size_t row = 0; row < rows; ++row) {
+      values[length_slot] = static_cast<double>(row % 11);
+      values[width_slot] = static_cast<double>((row * 7) % 13) - 1.0;
+      values[sepal_slot] = static_cast<double>(row);
+      const auto row_scores = compiled.infer(values);
+      ASSERT_EQ(row_scores.size(), conclusions_count);
+      std::ranges::copy(row_scores, std::next(scores.begin(), static_cast<std::ptrdiff_t>(row * conclusions_count)));
+    }
+    EXPECT_EQ(allocations.count(), 0);
+  }
+  for (std::size_t row = 0; row < rows; ++row) {
+    const auto result = reasoner.do_reasoning(fru::RuleTestingValues(std::map<fru::FuzzyVarUnion, fru::CrispValuesUnion>{
+        {variables[length_slot], fru::CrispValuesUnion{static_cast<double>(row % 11)}},
+        {variables[width_slot], fru::CrispValuesUnion{static_cast<double>((row * 7) % 13) - 1.0}}}));
+    for (std::size_t conclusion = 0; conclusion < conclusions_count; ++conclusion) {
+      const auto found = result.find(reasoner.get_conclusions()[conclusion]);
+      EXPECT_NEAR(scores[(row * conclusions_count) + conclusion], found == result.end() ? 0.0 : found->second, 1e-12);
+    }
+  }
+}
+
+auto make_rules_set() -> fru::RulesSet {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  rules_set.add_input_variable("sepal_width", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto iris_type = std::vector<std::string>{"Setosa", "Versicolor", "Virginica"};
+  const auto output_variable = rules_set.add_output_variable("iris_type", iris_type);
+  for (std::size_t length = 0; length < 3; ++length) {
+    for (std::size_t width = 0; width < 3; ++width) {
+      rules_set.add_rule({{petal_length, length}, {petal_width, width}}, {"iris_type", iris_type[(length + (2 * width)) % 3]});
+    }
+  }
+  return rules_set;
+}
+} // namespace
+
+TEST(CompiledReasoner, infers_as_simple_reasoner) {
+  auto rules_set = make_rules_set();
+  expect_same_scores(rules_set, fre::RulesLayout::dense);
+  expect_same_scores(rules_set, fre::RulesLayout::sparse);
+  rules_set.add_rule({}, {"iris_type", "Virginica"});
+  expect_same_scores(rules_set, fre::RulesLayout::automatic);
+}
+
+TEST(CompiledReasoner, rejects_unknown_slots) {
+  fre::CompiledReasoner compiled{make_rules_set()};
+  EXPECT_ANY_THROW(static_cast<void>(compiled.get_slot("sepal_length")));
+  const std::vector<double> values{1.0, 2.0};
+  EXPECT_TRUE(compiled.infer(values).empty());
+}
@@ -0,0 +1,61 @@
+#include "dataset.hpp"
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include <nlohmann/json.hpp>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+namespace fdd = fuzzyrulesml::dataset;
+namespace fru = fuzzyrulesml::rules;
+namespace fre = fuzzyrulesml::reasoner;
+
+namespace {
+auto make_data_set() -> fdd::DataSet {
+  const auto features = nlohmann::json::parse(R"([
+    {"petal length": 1.0, "petal width": 0.2},
+    {"petal length": 9.0, "petal width": 2.0},
+    {"petal length": 2.0, "petal width": 0.3}
+  ])");
+  const auto targets = nlohmann::json::parse(R"([{"class": "Setosa"}, {"class": "Versicolor"}, {"class": "Versicolor"}])");
+  return fdd::DataSet{features, targets};
+}
+} // namespace
+
+TEST(DataSet, stores_columns_and_class_ids) {
+  const auto data_set = make_data_set();
+  EXPECT_EQ(data_set.get_rows(), 3);
+  EXPECT_THAT(data_set.get_variables_names(), ::testing::ElementsAre("petal length", "petal width"));
+  EXPECT_THAT(data_set.get_column("petal width"), ::testing::ElementsAre(0.2, 2.0, 0.3));
+  EXPECT_THAT(data_set.get_columns({"petal width", "petal length"}),
+              ::testing::ElementsAre(::testing::ElementsAre(0.2, 2.0, 0.3), ::testing::ElementsAre(1.0, 9.0, 2.0)));
+  EXPECT_THAT(data_set.get_classes(), ::testing::ElementsAre("Setosa", "Versicolor"));
+  EXPECT_THAT(data_set.get_target_ids(), ::testing::ElementsAre(0, 1, 1));
+  EXPECT_THAT(data_set.get_targets(), ::testing::ElementsAre("Setosa", "Versicolor", "Versicolor"));
+  EXPECT_ANY_THROW(static_cast<void>(data_set.get_column("sepal length")));
+  EXPECT_ANY_THROW(fdd::DataSet(nlohmann::json::parse(R"([{"a": 1}, {"b": 2}])"),
+                                nlohmann::json::parse(R"([{"class": "x"}, {"class": "y"}])")));
+  EXPECT_ANY_THROW(fdd::DataSet(nlohmann::json::parse(R"([{"a": 1}])"), nlohmann::json::parse("[]")));
+}
+
+TEST(DataSet, items_match_by_class_ids) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto output_variable = rules_set.add_output_variable("iris_type", {"Setosa", "Versicolor"});
+  rules_set.add_rule({{petal_length, 0}}, {"iris_type", "Setosa"});
+  rules_set.add_rule({{petal_length, 1}}, {"iris_type", "Versicolor"});
+  const fre::SimpleReasoner reasoner{rules_set};
+  const auto data_set = make_data_set();
+
+  const auto items = data_set.get_items(std::pair{"petal length", petal_length});
+  ASSERT_EQ(items.size(), 3);
+  EXPECT_THAT(items | std::views::values | std::ranges::to<std::vector<std::uint32_t>>(), ::testing::ElementsAre(0, 1, 1));
+  EXPECT_DOUBLE_EQ(fre::calculate_one(items, reasoner, false), 2.0);
+  // Samples are built on demand from the bound columns
+  const auto [sample, class_id] = *std::next(items.begin(), 1);
+  EXPECT_EQ(class_id, 1);
+  EXPECT_DOUBLE_EQ(sample.find(petal_length)->second.get<double>(), 9.0);
+
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, data_set.get_column("petal length"));
+  EXPECT_DOUBLE_EQ(fre::calculate_one(inputs, data_set.get_target_ids(), data_set.get_classes(), reasoner, false), 2.0);
+}
@@ -0,0 +1,137 @@
+#include "gradient.hpp"
+#include "iris_model.hpp"
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+namespace fru = fuzzyrulesml::rules;
+namespace fre = fuzzyrulesml::reasoner;
+namespace frt = fuzzyrulesml::training;
+
+namespace {
+// Two variables of 3 and 2 terms, the classes of the rows given by thresholds the initial points do not match; the
+// values are spread beyond the points, on the shoulders too
+struct Model : fuzzyrulesml::testing::IrisModel {
+  Model()
+      : IrisModel{{{.name = "petal_length", .terms = 3, .step = 37, .period = 131, .offset = -1.0},
+                   {.name = "petal_width", .terms = 2, .step = 53, .period = 127, .offset = -1.0}},
+                  600} {
+    for (std::size_t term = 0; term < 3; ++term) {
+      rules_set.add_rule({{variables[0], term}, {variables[1], 0}}, {"iris_type", classes[term]});
+      rules_set.add_rule({{variables[0], term}, {variables[1], 1}}, {"iris_type", classes[(term + 1) % 3]});
+    }
+    for (std::size_t row = 0; row < inputs.get_rows(); ++row) {
+      const auto length_term = columns[0][row] < 3.0 ? 0U : (columns[0][row] < 7.0 ? 1U : 2U);
+      targets.push_back(columns[1][row] < 6.0 ? length_term : (length_term + 1) % 3);
+    }
+  }
+};
+} // namespace
+
+TEST(CrossEntropyLoss, gradient_matches_finite_differences) {
+  const Model model;
+  // The full grid fires through the dense grid unless the posting lists are forced, the loss does the same both ways
+  for (const auto layout : {fre::RulesLayout::dense, fre::RulesLayout::sparse}) {
+    const fre::SimpleReasoner reasoner{model.rules_set, layout};
+    const frt::CrossEntropyLoss loss{reasoner, model.inputs, model.targets, model.classes};
+    ASSERT_EQ(loss.size(), 5);
+    const std::vector<double> candidate{0.37, 4.61, 9.23, 1.13, 8.71};
+    std::vector<double> gradient(candidate.size());
+    const auto value = loss.evaluate(candidate, gradient);
+    EXPECT_GT(value, 0.0);
+    const double step = 1e-6;
+    std::vector<double> ignored(candidate.size());
+    for (std::size_t i = 0; i < candidate.size(); ++i) {
+      auto moved = candidate;
+      moved[i] += step;
+      const auto upper = loss.evaluate(moved, ignored);
+      moved[i] -= 2 * step;
+      const auto lower = loss.evaluate(moved, ignored);
+      EXPECT_NEAR(gradient[i], (upper - lower) / (2 * step), 1e-5) << "point " << i;
+    }
+
+    std::vector<double> threads_gradient(candidate.size());
+    EXPECT_NEAR(loss.evaluate(candidate, threads_gradient, 3), value, 1e-12);
+    for (std::size_t i = 0; i < candidate.size(); ++i) {
+      EXPECT_NEAR(threads_gradient[i], gradient[i], 1e-12);
+    }
+  }
+}
+
+TEST(CrossEntropyLoss, unconstrained_gradient_matches_finite_differences) {
+  const Model model;
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  const frt::CrossEntropyLoss loss{reasoner, model.inputs, model.targets, model.classes};
+  const std::vector<double> parameters{0.37, 1.5, -0.7, 1.13, 2.3};
+  std::vector<double> gradient(parameters.size());
+  const auto value = loss.evaluate_unconstrained(parameters, gradient, 0.5);
+  std::vector<double> candidate_gradient(parameters.size());
+  EXPECT_DOUBLE_EQ(loss.evaluate(loss.from_unconstrained(parameters, 0.5), candidate_gradient), value);
+  const double step = 1e-6;
+  std::vector<double> ignored(parameters.size());
+  for (std::size_t i = 0; i < parameters.size(); ++i) {
+    auto moved = parameters;
+    moved[i] += step;
+    const auto upper = loss.evaluate_unconstrained(moved, ignored, 0.5);
+    moved[i] -= 2 * step;
+    const auto lower = loss.evaluate_unconstrained(moved, ignored, 0.5);
+    EXPECT_NEAR(gradient[i], (upper - lower) / (2 * step), 1e-5) << "parameter " << i;
+  }
+}
+
+TEST(CrossEntropyLoss, unconstrained_parameters_keep_points_ordered) {
+  const Model model;
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  const frt::CrossEntropyLoss loss{reasoner, model.inputs, model.targets, model.classes};
+  const std::vector<double> candidate{1.0, 2.0, 5.0, 3.0, 3.75};
+  const auto parameters = loss.to_unconstrained(candidate, 0.5);
+  EXPECT_THAT(loss.from_unconstrained(parameters, 0.5), ::testing::Pointwise(::testing::DoubleNear(1e-12), candidate));
+  const auto ordered = loss.from_unconstrained(std::vector<double>{1.0, -40.0, 3.0, 3.0, -2.0}, 0.5);
+  EXPECT_NEAR(ordered[1], 1.5, 1e-12);
+  EXPECT_GT(ordered[2], ordered[1] + 0.5);
+  EXPECT_GT(ordered[4], ordered[3] + 0.5);
+  std::vector<double> short_candidate(3);
+  EXPECT_THROW(static_cast<void>(loss.to_unconstrained(short_candidate, 0.5)), std::runtime_error);
+}
+
+TEST(CrossEntropyLoss, gradient_steps_improve_the_goal_function) {
+  const Model model;
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  const frt::CrossEntropyLoss loss{reasoner, model.inputs, model.targets, model.classes};
+  const fru::ParametersBinding binding{model.inputs};
+  const auto start = binding.get_parameters();
+  const auto start_goal = fre::calculate_one(model.inputs, binding, start, model.targets, model.classes, reasoner, false);
+
+  // Plain steps along the gradient; the methods of minimize_gradient are tested in optimizer_test.cpp
+  auto parameters = loss.to_unconstrained(start, 0.5);
+  std::vector<double> gradient(parameters.size());
+  const auto start_loss = loss.evaluate_unconstrained(parameters, gradient, 0.5);
+  double last_loss = start_loss;
+  for (std::size_t step = 0; step < 100; ++step) {
+    std::ranges::transform(parameters, gradient, parameters.begin(),
+                           [](double parameter, double partial) { return parameter - (2.0 * partial); });
+    last_loss = loss.evaluate_unconstrained(parameters, gradient, 0.5);
+  }
+  EXPECT_LT(last_loss, start_loss);
+  const auto best = loss.from_unconstrained(parameters, 0.5);
+  EXPECT_TRUE(std::ranges::is_sorted(std::span{best}.first(3)));
+  const auto goal = fre::calculate_one(model.inputs, binding, best, model.targets, model.classes, reasoner, false);
+  EXPECT_GT(goal, start_goal);
+}
+
+TEST(CrossEntropyLoss, checks_sizes) {
+  const Model model;
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  EXPECT_THROW(frt::CrossEntropyLoss(reasoner, model.inputs, std::span{model.targets}.first(10), model.classes), std::runtime_error);
+  const frt::CrossEntropyLoss loss{reasoner, model.inputs, model.targets, model.classes};
+  std::vector<double> candidate(4);
+  std::vector<double> gradient(4);
+  EXPECT_THROW(static_cast<void>(loss.evaluate(candidate, gradient)), std::runtime_error);
+}
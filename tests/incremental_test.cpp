@@ -0,0 +1,116 @@
+#include "incremental.hpp"
+#include "iris_model.hpp"
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include <limits>
+#include <random>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+namespace fru = fuzzyrulesml::rules;
+namespace fre = fuzzyrulesml::reasoner;
+
+namespace {
+struct IrisLike : fuzzyrulesml::testing::IrisModel {
+  IrisLike()
+      : IrisModel{{{.name = "petal_length", .terms = 3, .step = 1, .period = 101}, {.name = "petal_width", .terms = 2, .step = 7, .period = 103}},
+                  500} {
+    for (std::size_t length = 0; length < 3; ++length) {
+      for (std::size_t width = 0; width < 2; ++width) {
+        rules_set.add_rule({{variables[0], length}, {variables[1], width}}, {"iris_type", classes[(length + width) % 3]});
+      }
+    }
+    for (std::size_t row = 0; row < 500; ++row) {
+      targets.push_back(static_cast<std::uint32_t>(row % 3));
+    }
+  }
+};
+} // namespace
+
+TEST(IncrementalEvaluator, matches_full_rescoring) {
+  const IrisLike iris;
+  const fre::SimpleReasoner reasoner{iris.rules_set};
+  const fru::ParametersBinding binding{iris.inputs};
+  fre::IncrementalEvaluator evaluator{reasoner, iris.inputs, iris.targets, iris.classes};
+  std::vector<double> candidate{binding.get_parameters().begin(), binding.get_parameters().end()};
+  std::vector<double> expected(iris.inputs.get_rows() * reasoner.get_conclusions().size());
+
+  const auto check = [&]() {
+    reasoner.do_reasoning(iris.inputs, binding, candidate, expected);
+    EXPECT_THAT(evaluator.get_scores(), ::testing::Pointwise(::testing::DoubleNear(1e-12), expected));
+    EXPECT_DOUBLE_EQ(evaluator.get_goal_function(),
+                     fre::calculate_one(iris.inputs, binding, candidate, iris.targets, iris.classes, reasoner, false));
+  };
+  check();
+
+  // Coordinate-wise moves of single points, as a coordinate descent does
+  std::mt19937_64 generator{3};
+  std::uniform_real_distribution<double> move{-0.5, 0.5};
+  for (std::size_t step = 0; step < 50; ++step) {
+    const auto parameter = step % candidate.size();
+    candidate[parameter] += move(generator);
+    std::ranges::sort(std::span{candidate}.subspan(0, 3));
+    std::ranges::sort(std::span{candidate}.subspan(3, 2));
+    const auto column = parameter < 3 ? 0 : 1;
+    static_cast<void>(evaluator.set_points(column, binding.get_points(candidate, column)));
+    EXPECT_THAT(evaluator.get_points(column), ::testing::ElementsAreArray(binding.get_points(candidate, column)));
+    check();
+  }
+
+  // Moving the first point changes the degrees of the first segment rows only
+  candidate = {0.0, 5.0, 10.0, 0.0, 10.0};
+  static_cast<void>(evaluator.set_parameters(binding, candidate));
+  candidate[0] = 0.5;
+  const auto rescored = evaluator.set_parameters(binding, candidate);
+  EXPECT_GT(rescored, 0);
+  EXPECT_LT(rescored, iris.inputs.get_rows() * 3 / 4);
+  check();
+
+  // Moving the last point leaves the rows below its neighbour
+  candidate = {0.0, 5.0, 10.0, 0.0, 10.0};
+  static_cast<void>(evaluator.set_parameters(binding, candidate));
+  candidate[2] = 9.0;
+  EXPECT_LT(evaluator.set_parameters(binding, candidate), iris.inputs.get_rows() * 3 / 4);
+  check();
+
+  // Points not sorted fuzzify the whole column, the same as the batch reasoning does
+  candidate = {6.0, 2.0, 9.0, 0.0, 10.0};
+  static_cast<void>(evaluator.set_parameters(binding, candidate));
+  check();
+  candidate = {1.0, 2.0, 9.0, 0.0, 10.0};
+  static_cast<void>(evaluator.set_parameters(binding, candidate));
+  check();
+
+  candidate = {1.0, 4.0, 8.0, 3.0, 7.0};
+  static_cast<void>(evaluator.set_parameters(binding, candidate));
+  check();
+  EXPECT_EQ(evaluator.set_parameters(binding, candidate), 0);
+  EXPECT_ANY_THROW(static_cast<void>(evaluator.set_points(0, std::vector<double>{1.0, 2.0})));
+  EXPECT_ANY_THROW(static_cast<void>(evaluator.set_points(2, std::vector<double>{1.0, 2.0})));
+  EXPECT_ANY_THROW(static_cast<void>(evaluator.set_parameters(binding, std::span{candidate}.first(4))));
+}
+
+TEST(IncrementalEvaluator, rows_firing_no_rule_match_nothing) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  static_cast<void>(rules_set.add_output_variable("iris_type", {"Setosa", "Versicolor"}));
+  // The middle term has no rule, and the missing values fire no term
+  rules_set.add_rule({{petal_length, 0}}, {"iris_type", "Setosa"});
+  rules_set.add_rule({{petal_length, 2}}, {"iris_type", "Versicolor"});
+  const fre::SimpleReasoner reasoner{rules_set};
+  const std::vector<double> lengths{1.0, 5.0, std::numeric_limits<double>::quiet_NaN(), 9.0};
+  const std::vector<std::uint32_t> targets{0, 0, 0, 1};
+  const std::vector<std::string> classes{"Setosa", "Versicolor"};
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, lengths);
+  const fru::ParametersBinding binding{inputs};
+  fre::IncrementalEvaluator evaluator{reasoner, inputs, targets, classes};
+  EXPECT_DOUBLE_EQ(evaluator.get_goal_function(), 2.0);
+  EXPECT_DOUBLE_EQ(evaluator.get_goal_function(), fre::calculate_one(inputs, targets, classes, reasoner, false));
+
+  // The middle row fires the first term once the middle point moves past it
+  const std::vector<double> candidate{0.0, 6.0, 10.0};
+  static_cast<void>(evaluator.set_parameters(binding, candidate));
+  EXPECT_DOUBLE_EQ(evaluator.get_goal_function(), 3.0);
+  EXPECT_DOUBLE_EQ(evaluator.get_goal_function(), fre::calculate_one(inputs, binding, candidate, targets, classes, reasoner, false));
+}
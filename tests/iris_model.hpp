@@ -0,0 +1,45 @@
+#pragma once
+
+#include "rules.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fuzzyrulesml::testing {
+// Input variable of IrisModel, with its terms uniformly spread over [0, 10], and its column: the value of a row is
+// ((row * step) % period) / 10 + offset, so the values cover the period in a scattered order without a random generator
+struct IrisColumn {
+  std::string name;
+  std::size_t terms;
+  std::size_t step;
+  std::size_t period;
+  double offset{0.0};
+};
+
+// IrisModel is the rules set of the iris classes over the input variables of the columns, with the rows of the columns
+// bound to a batch; the tests add the rules and the targets of the rows
+struct IrisModel {
+  IrisModel(const std::vector<IrisColumn>& spec, std::size_t rows) {
+    for (const auto& column : spec) {
+      const fuzzyrulesml::rules::initial_distribution::Uniform distribution{0.0, 10.0, column.terms};
+      variables.push_back(rules_set.add_input_variable(column.name, distribution));
+      auto& values = columns.emplace_back();
+      for (std::size_t row = 0; row < rows; ++row) {
+        values.push_back((static_cast<double>((row * column.step) % column.period) / 10.0) + column.offset);
+      }
+    }
+    static_cast<void>(rules_set.add_output_variable("iris_type", classes));
+    for (std::size_t column = 0; column < columns.size(); ++column) {
+      inputs.add_column(variables[column], columns[column]);
+    }
+  }
+
+  std::vector<std::string> classes{"Setosa", "Versicolor", "Virginica"};
+  fuzzyrulesml::rules::RulesSet rules_set;
+  std::vector<fuzzyrulesml::rules::FuzzyVariable<double>> variables;
+  std::vector<std::vector<double>> columns;
+  std::vector<std::uint32_t> targets;
+  fuzzyrulesml::rules::BatchInputs inputs;
+};
+} // namespace fuzzyrulesml::testing
@@ -0,0 +1,111 @@
+#include "columnar.hpp"
+#include "loader.hpp"
+#include <cmath>
+#include <memory>
+#include <sstream>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+namespace fdd = fuzzyrulesml::dataset;
+
+namespace {
+auto make_stream(const std::string& text) -> std::unique_ptr<std::istream> { return std::make_unique<std::istringstream>(text); }
+
+const std::string features_json = R"([
+  {"sepal length": 5.1, "petal length": 1.4},
+  {"petal length": 4.7, "sepal length": 7},
+  {"sepal length": 6.3, "petal length": null}
+])";
+const std::string targets_json = R"([{"class": "Iris-setosa"}, {"class": "Iris-versicolor"}, {"id": 3, "class": "Iris-setosa"}])";
+} // namespace
+
+TEST(ColumnarStore, interns_features_and_classes) {
+  fdd::ColumnarStore store{{"sepal length", "petal length"}};
+  const auto setosa = store.intern_class("Iris-setosa");
+  const auto virginica = store.intern_class("Iris-virginica");
+  EXPECT_EQ(store.intern_class("Iris-setosa"), setosa);
+  store.add_row(std::vector<double>{5.1, 1.4}, setosa);
+  store.add_row(std::vector<double>{6.3, 5.0}, virginica);
+  EXPECT_EQ(store.get_rows(), 2);
+  EXPECT_EQ(store.find_feature("petal length"), 1);
+  EXPECT_FALSE(store.find_feature("petal width"));
+  EXPECT_THAT(store.get_column("petal length"), ::testing::ElementsAre(1.4, 5.0));
+  EXPECT_THAT(store.get_targets(), ::testing::ElementsAre(setosa, virginica));
+  EXPECT_EQ(store.get_class(virginica), "Iris-virginica");
+  EXPECT_ANY_THROW(store.add_row(std::vector<double>{1.0}, setosa));
+  EXPECT_ANY_THROW(store.add_row(std::vector<double>{1.0, 2.0}, 7));
+  EXPECT_ANY_THROW(static_cast<void>(store.get_column("petal width")));
+  EXPECT_ANY_THROW(fdd::ColumnarStore({"a", "a"}));
+
+  store.clear_rows();
+  EXPECT_EQ(store.get_rows(), 0);
+  EXPECT_EQ(store.intern_class("Iris-virginica"), virginica);
+}
+
+TEST(JsonRecordsReader, reads_records_into_columns) {
+  fdd::JsonRecordsReader reader{make_stream(features_json), make_stream(targets_json)};
+  fdd::ColumnarStore store;
+  EXPECT_EQ(reader.read(store, 100), 3);
+  EXPECT_EQ(reader.read(store, 100), 0);
+  EXPECT_THAT(store.get_features_names(), ::testing::ElementsAre("sepal length", "petal length"));
+  EXPECT_THAT(store.get_column("sepal length"), ::testing::ElementsAre(5.1, 7.0, 6.3));
+  EXPECT_DOUBLE_EQ(store.get_column("petal length")[1], 4.7);
+  EXPECT_TRUE(std::isnan(store.get_column("petal length")[2]));
+  EXPECT_THAT(store.get_classes(), ::testing::ElementsAre("Iris-setosa", "Iris-versicolor"));
+  EXPECT_THAT(store.get_targets(), ::testing::ElementsAre(0, 1, 0));
+}
+
+TEST(JsonRecordsReader, reads_chunks_with_stable_class_ids) {
+  fdd::JsonRecordsReader reader{make_stream(features_json), make_stream(targets_json)};
+  std::vector<std::size_t> chunks_rows;
+  std::vector<std::uint32_t> targets;
+  fdd::for_each_chunk(reader, 2, [&](const fdd::ColumnarStore& chunk) {
+    chunks_rows.push_back(chunk.get_rows());
+    targets.insert(targets.end(), chunk.get_targets().begin(), chunk.get_targets().end());
+  });
+  EXPECT_THAT(chunks_rows, ::testing::ElementsAre(2, 1));
+  EXPECT_THAT(targets, ::testing::ElementsAre(0, 1, 0));
+}
+
+TEST(JsonRecordsReader, rejects_malformed_records) {
+  const auto read_all = [](const std::string& features, const std::string& targets) {
+    fdd::JsonRecordsReader reader{make_stream(features), make_stream(targets)};
+    fdd::ColumnarStore store;
+    return reader.read(store, 100);
+  };
+  EXPECT_ANY_THROW(read_all(R"([{"a": 1}, {"a": 2}])", R"([{"class": "x"}])"));
+  EXPECT_ANY_THROW(read_all(R"([{"a": 1}])", R"([{"class": "x"}, {"class": "y"}])"));
+  EXPECT_ANY_THROW(read_all(R"([{"a": 1, "b": 2}, {"a": 2}])", R"([{"class": "x"}, {"class": "y"}])"));
+  EXPECT_ANY_THROW(read_all(R"([{"a": 1}, {"c": 2}])", R"([{"class": "x"}, {"class": "y"}])"));
+  EXPECT_ANY_THROW(read_all(R"([{"a": "text"}])", R"([{"class": "x"}])"));
+  EXPECT_ANY_THROW(read_all(R"([{"a": {"b": 1}}])", R"([{"class": "x"}])"));
+  EXPECT_ANY_THROW(read_all(R"([{"a": 1}])", R"([{"label": "x"}])"));
+  EXPECT_ANY_THROW(read_all(R"([{"a": 1)", R"([{"class": "x"}])"));
+  EXPECT_ANY_THROW(read_all(R"({"a": 1})", R"([{"class": "x"}])"));
+  EXPECT_EQ(read_all("[]", "[]"), 0);
+}
+
+TEST(CsvRecordsReader, reads_header_and_quoted_fields) {
+  const std::string csv = "sepal length,class,petal length\r\n5.1,Iris-setosa,1.4\n\n 7.0 ,\"Iris, versicolor\",\n6.3,\"Iris-\"\"setosa\"\"\",5\n";
+  fdd::CsvRecordsReader reader{make_stream(csv)};
+  fdd::ColumnarStore store;
+  EXPECT_EQ(reader.read(store, 2), 2);
+  EXPECT_EQ(reader.read(store, 2), 1);
+  EXPECT_EQ(reader.read(store, 2), 0);
+  EXPECT_THAT(store.get_features_names(), ::testing::ElementsAre("sepal length", "petal length"));
+  EXPECT_THAT(store.get_column("sepal length"), ::testing::ElementsAre(5.1, 7.0, 6.3));
+  EXPECT_TRUE(std::isnan(store.get_column("petal length")[1]));
+  EXPECT_THAT(store.get_classes(), ::testing::ElementsAre("Iris-setosa", "Iris, versicolor", "Iris-\"setosa\""));
+
+  fdd::CsvRecordsReader bad_number{make_stream("a,class\nx,y\n")};
+  fdd::ColumnarStore bad_store;
+  EXPECT_ANY_THROW(static_cast<void>(bad_number.read(bad_store, 10)));
+  fdd::CsvRecordsReader other_features{make_stream("a,class\n1,y\n")};
+  EXPECT_ANY_THROW(static_cast<void>(other_features.read(store, 10)));
+  fdd::CsvRecordsReader no_target{make_stream("a,b\n1,2\n")};
+  fdd::ColumnarStore other;
+  EXPECT_ANY_THROW(static_cast<void>(no_target.read(other, 10)));
+  fdd::CsvRecordsReader short_line{make_stream("a,class\n1\n")};
+  fdd::ColumnarStore short_store;
+  EXPECT_ANY_THROW(static_cast<void>(short_line.read(short_store, 10)));
+}
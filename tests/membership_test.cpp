@@ -1,5 +1,10 @@
+#include "allocation_counter.hpp"
+#include "fuzzify_kernels.hpp"
 #include "membership_functions.hpp"
+#include "rules.hpp"
 #include "variable.hpp"
+#include <cmath>
+#include <limits>
 #include "gtest/gtest.h"
 
 using namespace fuzzyrulesml::mfunct;
@@ -108,4 +113,172 @@ TEST(CreateLinearDistribution, valid_distribution) {
     EXPECT_EQ(memberships_20.size(), 1);
     EXPECT_DOUBLE_EQ(memberships_20[2], 1.0);
 
-}
\ No newline at end of file
+}
+
+TEST(FlatMembership, keeps_indices_sorted) {
+  fuzzyrulesml::Membership membership;
+  membership[3] = 0.25;
+  membership[1] = 0.75;
+  EXPECT_EQ(membership.size(), 2);
+  EXPECT_EQ(membership.begin()->first, 1);
+  EXPECT_DOUBLE_EQ(membership.get_membership(3), 0.25);
+  EXPECT_DOUBLE_EQ(membership.get_membership(2), 0.0);
+  membership[3] = 0.5;
+  EXPECT_EQ(membership.size(), 2);
+  EXPECT_DOUBLE_EQ(membership.get_memberships().back().second, 0.5);
+  EXPECT_ANY_THROW(membership[0] = 1.0);
+}
+
+TEST(FlatMembership, fuzzification_does_not_allocate) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 5));
+  const auto linear_distribution = fru::make_linear_distribution(fru::initial_distribution::Uniform(0.0, 10.0, 5));
+  const fru::FuzzyVarUnion petal_length_union{petal_length};
+  double degrees_sum = 0.0;
+
+  const fuzzyrulesml::testing::AllocationCounter counter;
+  for (const auto value : {-1.0, 0.0, 1.25, 2.5, 3.75, 6.0, 8.75, 10.0, 11.0}) {
+    for (const auto& [index, degree] : linear_distribution(value)) {
+      degrees_sum += degree;
+    }
+    for (const auto& [index, degree] : petal_length(value).get_membership()) {
+      degrees_sum += degree;
+    }
+    for (const auto& [index, degree] : petal_length_union.get_membership(fru::CrispValuesUnion{value})) {
+      degrees_sum += degree;
+    }
+  }
+  EXPECT_EQ(counter.count(), 0);
+  EXPECT_DOUBLE_EQ(degrees_sum, 27.0);
+}
+
+TEST(CreateLinearDistribution, many_terms_match_member_functions) {
+  const std::vector<double> points{0.0, 0.5, 2.0, 2.25, 3.0, 4.5, 5.0, 6.5, 7.0, 8.75, 9.0, 10.0};
+  const auto left = LinearMemberFunctDesc{points[0], points[1]};
+  const auto right = LinearMemberFunctAsc{points[points.size() - 2], points.back()};
+  std::vector<LinearMemberFunct<double>> mids;
+  for (std::size_t i = 0; i + 2 < points.size(); ++i) {
+    mids.emplace_back(points[i], points[i + 1], points[i + 2]);
+  }
+  const auto distribution = LinearDistribution{left, mids, right};
+  EXPECT_EQ(distribution.get_points(), points);
+
+  for (double value = -0.5; value <= 10.5; value += 0.125) {
+    const auto memberships = distribution(value);
+    EXPECT_LE(memberships.size(), 2);
+    EXPECT_DOUBLE_EQ(memberships.get_membership(0), value < points[0] ? 1.0 : left(value).value_or(0.0));
+    for (std::size_t i = 0; i < mids.size(); ++i) {
+      EXPECT_DOUBLE_EQ(memberships.get_membership(i + 1), mids[i](value).value_or(0.0));
+    }
+    EXPECT_DOUBLE_EQ(memberships.get_membership(points.size() - 1), value >= points.back() ? 1.0 : right(value).value_or(0.0));
+  }
+}
+
+TEST(CreateLinearDistribution, set_points_retunes_segments) {
+  auto distribution = fru::make_linear_distribution(fru::initial_distribution::Uniform(0.0, 10.0, 5));
+  EXPECT_EQ(distribution.get_points(), (std::vector<double>{0.0, 2.5, 5.0, 7.5, 10.0}));
+  distribution.set_points({0.0, 1.0, 2.0, 8.0, 10.0});
+  EXPECT_EQ(distribution.get_points(), (std::vector<double>{0.0, 1.0, 2.0, 8.0, 10.0}));
+  EXPECT_DOUBLE_EQ(distribution(1.5)[1], 0.5);
+  EXPECT_DOUBLE_EQ(distribution(1.5)[2], 0.5);
+  EXPECT_DOUBLE_EQ(distribution(3.5)[2], 0.75);
+  EXPECT_DOUBLE_EQ(distribution(3.5)[3], 0.25);
+  EXPECT_EQ(distribution(8.0).size(), 1);
+  EXPECT_ANY_THROW(distribution.set_points({0.0, 10.0}));
+}
+
+TEST(FuzzifyColumn, kernels_match_linear_distribution) {
+  for (const auto& points : {std::vector<double>{0.0, 10.0}, std::vector<double>{0.0, 2.5, 5.0, 7.5, 10.0},
+                             std::vector<double>{-1.0, 0.5, 2.0, 2.25, 3.0, 4.5, 8.75, 9.0, 10.0},
+                             std::vector<double>{0.0, 0.5, 1.0, 1.25, 2.0, 2.5, 3.0, 4.0, 4.5, 5.0, 6.0, 6.5, 7.0, 8.0, 9.5, 10.0},
+                             // Not sorted points set by an optimizer, also more than the counted segments of the scalar kernel
+                             std::vector<double>{0.0, 5.0, 3.0, 10.0},
+                             std::vector<double>{0.0, 6.0, 1.0, 1.25, 8.0, 2.5, 3.0, 4.0, 4.5, 2.0, 6.0, 6.5, 7.0, 8.0, 9.5, 10.0}}) {
+    const auto distribution = LinearDistribution<double>{points};
+    std::vector<double> values;
+    for (double value = -2.0; value <= 12.0; value += 0.0625) {
+      values.push_back(value);
+    }
+    values.push_back(points.front());
+    values.push_back(points.back());
+    for (const auto kernel : {FuzzifyKernel::scalar, FuzzifyKernel::sse2, FuzzifyKernel::avx2}) {
+      if (not is_supported(kernel)) {
+        continue;
+      }
+      std::vector<std::uint32_t> segments(values.size());
+      std::vector<double> degrees(values.size());
+      fuzzify_column(kernel, points, values, segments, degrees);
+      for (std::size_t i = 0; i < values.size(); ++i) {
+        const auto memberships = distribution(values[i]);
+        EXPECT_NEAR(memberships.get_membership(segments[i]), degrees[i], 1e-12) << to_string(kernel) << " " << values[i];
+        EXPECT_NEAR(memberships.get_membership(segments[i] + 1), 1.0 - degrees[i], 1e-12) << to_string(kernel) << " " << values[i];
+      }
+    }
+  }
+}
+
+TEST(FuzzifyColumn, bisection_kernels_match_scalar) {
+  // More points than the counted segments of any kernel, so the vector kernels bisect; the infinite values are beyond
+  // both ends of the points
+  const auto infinity = std::numeric_limits<double>::infinity();
+  std::vector<double> points;
+  for (std::size_t point = 0; point < 100; ++point) {
+    points.push_back(static_cast<double>(point) * 0.5);
+  }
+  std::vector<double> values{infinity, -infinity, infinity, 0.0, 49.5, 1e300, infinity, 25.25, -infinity};
+  for (double value = -1.0; value <= 51.0; value += 0.375) {
+    values.push_back(value);
+  }
+  std::vector<std::uint32_t> expected_segments(values.size());
+  std::vector<double> expected_degrees(values.size());
+  fuzzify_column(FuzzifyKernel::scalar, points, values, expected_segments, expected_degrees);
+  for (const auto kernel : {FuzzifyKernel::sse2, FuzzifyKernel::avx2}) {
+    if (not is_supported(kernel)) {
+      continue;
+    }
+    std::vector<std::uint32_t> segments(values.size());
+    std::vector<double> degrees(values.size());
+    fuzzify_column(kernel, points, values, segments, degrees);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      EXPECT_EQ(segments[i], expected_segments[i]) << to_string(kernel) << " " << values[i];
+      EXPECT_DOUBLE_EQ(degrees[i], expected_degrees[i]) << to_string(kernel) << " " << values[i];
+    }
+  }
+}
+
+TEST(FuzzifyColumn, nan_fires_nothing) {
+  const auto nan = std::numeric_limits<double>::quiet_NaN();
+  for (const auto& points : {std::vector<double>{0.0, 10.0}, std::vector<double>{0.0, 2.5, 5.0, 7.5, 10.0},
+                             std::vector<double>{-1.0, 0.5, 2.0, 2.25, 3.0, 4.5, 8.75, 9.0, 10.0}}) {
+    const auto distribution = LinearDistribution<double>{points};
+    EXPECT_EQ(distribution(nan).size(), 0);
+    const std::vector<double> values{1.0, nan, 3.0, 4.0, nan, 6.0, 7.0, 8.0, nan};
+    for (const auto kernel : {FuzzifyKernel::scalar, FuzzifyKernel::sse2, FuzzifyKernel::avx2}) {
+      if (not is_supported(kernel)) {
+        continue;
+      }
+      std::vector<std::uint32_t> segments(values.size());
+      std::vector<double> degrees(values.size());
+      fuzzify_column(kernel, points, values, segments, degrees);
+      for (std::size_t i = 0; i < values.size(); ++i) {
+        if (std::isnan(values[i])) {
+          EXPECT_EQ(segments[i], no_segment) << to_string(kernel) << " " << i;
+          EXPECT_EQ(degrees[i], 0.0) << to_string(kernel) << " " << i;
+        } else {
+          EXPECT_NEAR(distribution(values[i]).get_membership(segments[i]), degrees[i], 1e-12) << to_string(kernel) << " " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(FuzzifyColumn, int_variable_fires_nothing) {
+  fru::RulesSet rules_set;
+  const auto petal_count = rules_set.add_input_variable("petal_count", fru::initial_distribution::Uniform(0, 10, 3));
+  const std::vector<double> values{1.0, 5.0};
+  std::vector<std::uint32_t> segments(values.size());
+  std::vector<double> degrees(values.size());
+  petal_count.fuzzify(values, segments, degrees);
+  EXPECT_EQ(segments, (std::vector<std::uint32_t>{no_segment, no_segment}));
+  EXPECT_ANY_THROW(fuzzify_column(std::vector<double>{0.0}, values, segments, degrees));
+}
@@ -0,0 +1,80 @@
+#include "minibatch.hpp"
+#include "rules.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+namespace fru = fuzzyrulesml::rules;
+namespace frt = fuzzyrulesml::training;
+
+namespace {
+// 1000 rows of three classes in the proportions 6:3:1, each value encoding its row
+struct Dataset {
+  Dataset() {
+    const auto length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+    const auto width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+    for (std::size_t row = 0; row < 1000; ++row) {
+      lengths.push_back(static_cast<double>(row));
+      widths.push_back(-static_cast<double>(row));
+      targets.push_back(row % 10 < 6 ? 0 : (row % 10 < 9 ? 1 : 2));
+    }
+    inputs.add_column(length, lengths);
+    inputs.add_column(width, widths);
+  }
+  fru::RulesSet rules_set;
+  std::vector<double> lengths;
+  std::vector<double> widths;
+  std::vector<std::uint32_t> targets;
+  fru::BatchInputs inputs;
+};
+} // namespace
+
+TEST(StratifiedBatches, keeps_class_proportions) {
+  const Dataset dataset;
+  frt::StratifiedBatches batches{dataset.inputs, dataset.targets, 95, 3};
+  for (std::size_t generation = 0; generation < 5; ++generation) {
+    batches.resample(generation);
+    const auto rows = batches.get_rows();
+    ASSERT_EQ(rows.size(), 95);
+    ASSERT_EQ(batches.get_inputs().get_rows(), 95);
+    EXPECT_TRUE(std::ranges::adjacent_find(rows, std::ranges::greater_equal{}) == rows.end());
+    const auto targets = batches.get_targets();
+    // 57, 28.5 and 9.5 rows, the remainders going to the first classes
+    EXPECT_EQ(std::ranges::count(targets, 0U), 57);
+    EXPECT_EQ(std::ranges::count(targets, 1U), 29);
+    EXPECT_EQ(std::ranges::count(targets, 2U), 9);
+    const auto& columns = batches.get_inputs().get_columns();
+    for (std::size_t index = 0; index < rows.size(); ++index) {
+      EXPECT_EQ(columns[0][index], static_cast<double>(rows[index]));
+      EXPECT_EQ(columns[1][index], -static_cast<double>(rows[index]));
+      EXPECT_EQ(targets[index], dataset.targets[rows[index]]);
+    }
+  }
+}
+
+TEST(StratifiedBatches, draws_batches_by_generation) {
+  const Dataset dataset;
+  frt::StratifiedBatches batches{dataset.inputs, dataset.targets, 50, 3};
+  const std::vector<std::size_t> first{batches.get_rows().begin(), batches.get_rows().end()};
+  batches.resample(1);
+  const std::vector<std::size_t> second{batches.get_rows().begin(), batches.get_rows().end()};
+  EXPECT_NE(first, second);
+  batches.resample(0);
+  EXPECT_THAT(batches.get_rows(), ::testing::ElementsAreArray(first));
+
+  const frt::StratifiedBatches other_seed{dataset.inputs, dataset.targets, 50, 4};
+  EXPECT_THAT(other_seed.get_rows(), ::testing::Not(::testing::ElementsAreArray(first)));
+}
+
+TEST(StratifiedBatches, takes_at_most_all_rows) {
+  const Dataset dataset;
+  const frt::StratifiedBatches batches{dataset.inputs, dataset.targets, 5000, 3};
+  ASSERT_EQ(batches.get_rows().size(), 1000);
+  EXPECT_EQ(batches.get_rows().back(), 999);
+  EXPECT_THROW(frt::StratifiedBatches(dataset.inputs, dataset.targets, 0, 3), std::runtime_error);
+  const std::vector<std::uint32_t> few_targets(10);
+  EXPECT_THROW(frt::StratifiedBatches(dataset.inputs, few_targets, 10, 3), std::runtime_error);
+}
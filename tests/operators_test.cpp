@@ -0,0 +1,102 @@
+#include "operators.hpp"
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include "static_reasoner.hpp"
+#include <array>
+#include <tuple>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+namespace fru = fuzzyrulesml::rules;
+namespace fre = fuzzyrulesml::reasoner;
+
+TEST(Operators, combine_single_values_and_batches) {
+  EXPECT_DOUBLE_EQ(fre::ProductTNorm::apply(0.5, 0.4), 0.2);
+  EXPECT_DOUBLE_EQ(fre::MinTNorm::apply(0.5, 0.4), 0.4);
+  EXPECT_DOUBLE_EQ(fre::LukasiewiczTNorm::apply(0.5, 0.4), 0.0);
+  EXPECT_DOUBLE_EQ(fre::LukasiewiczTNorm::apply(0.9, 0.4), 0.3);
+  EXPECT_DOUBLE_EQ(fre::SumAggregation::combine(0.5, 0.4), 0.9);
+  EXPECT_DOUBLE_EQ(fre::MaxAggregation::combine(0.5, 0.4), 0.5);
+  EXPECT_DOUBLE_EQ(fre::ProbabilisticOrAggregation::combine(0.5, 0.4), 0.7);
+
+  std::vector<double> strengths{1.0, 0.5, 0.25};
+  fre::MinTNorm::apply(strengths, 0.4);
+  EXPECT_THAT(strengths, ::testing::ElementsAre(0.4, 0.4, 0.25));
+  std::vector<double> scores(2, 0.0);
+  const std::vector<std::size_t> conclusions{1, 0, 1};
+  fre::ProbabilisticOrAggregation::combine(scores, conclusions, strengths);
+  EXPECT_THAT(scores, ::testing::ElementsAre(::testing::DoubleEq(0.4), ::testing::DoubleEq(0.55)));
+}
+
+namespace {
+constexpr std::array grid_terms{std::size_t{3}, std::size_t{2}};
+constexpr std::array<fre::StaticRule<2>, 6> grid_rules{
+    {{{0, 0}, 0}, {{0, 1}, 1}, {{1, 0}, 2}, {{1, 1}, 0}, {{2, 0}, 1}, {{2, 1}, 1}}};
+
+template <typename OPERATORS> class ReasonerOperators : public ::testing::Test {};
+using OperatorsTypes = ::testing::Types<std::tuple<fre::ProductTNorm, fre::SumAggregation>, std::tuple<fre::MinTNorm, fre::MaxAggregation>,
+                                        std::tuple<fre::LukasiewiczTNorm, fre::ProbabilisticOrAggregation>,
+                                        std::tuple<fre::MinTNorm, fre::ProbabilisticOrAggregation>>;
+TYPED_TEST_SUITE(ReasonerOperators, OperatorsTypes);
+} // namespace
+
+// The sparse and the dense batch reasoning, the single sample reasoning and the static reasoner give the same scores
+TYPED_TEST(ReasonerOperators, layouts_give_the_same_scores) {
+  using TNorm = std::tuple_element_t<0, TypeParam>;
+  using Aggregation = std::tuple_element_t<1, TypeParam>;
+  using Reasoner = fre::BasicReasoner<TNorm, Aggregation>;
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto output = rules_set.add_output_variable("iris_type", {"Setosa", "Versicolor", "Virginica"});
+  fre::StaticReasoner<grid_terms, grid_rules, 3, TNorm, Aggregation>::add_rules(rules_set, {petal_length, petal_width}, output);
+  const Reasoner dense{rules_set};
+  const Reasoner sparse{rules_set, fre::RulesLayout::sparse};
+  ASSERT_TRUE(dense.is_dense());
+
+  const std::vector<double> lengths{-1.0, 0.0, 2.5, 4.0, 5.0, 7.0, 9.5, 10.0, 11.0};
+  const std::vector<double> widths{3.0, 0.0, 7.5, 4.0, 5.0, 1.0, 8.0, 10.0, -1.0};
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, lengths);
+  inputs.add_column(petal_width, widths);
+  const fre::StaticReasoner<grid_terms, grid_rules, 3, TNorm, Aggregation> static_reasoner{fru::ParametersBinding{inputs}.get_parameters()};
+  const auto conclusions_count = dense.get_conclusions().size();
+  std::vector<double> dense_scores(inputs.get_rows() * conclusions_count);
+  std::vector<double> sparse_scores(dense_scores.size());
+  std::vector<double> static_scores(dense_scores.size());
+  dense.do_reasoning(inputs, dense_scores);
+  sparse.do_reasoning(inputs, sparse_scores);
+  static_reasoner.do_reasoning(inputs, static_scores);
+  EXPECT_THAT(dense_scores, ::testing::Pointwise(::testing::DoubleNear(1e-12), sparse_scores));
+  EXPECT_THAT(static_scores, ::testing::Pointwise(::testing::DoubleNear(1e-12), sparse_scores));
+  for (std::size_t row = 0; row < inputs.get_rows(); ++row) {
+    const auto result = sparse.do_reasoning(fru::RuleTestingValues({{fru::FuzzyVarUnion{petal_length}, fru::CrispValuesUnion{lengths[row]}},
+                                                                    {fru::FuzzyVarUnion{petal_width}, fru::CrispValuesUnion{widths[row]}}}));
+    for (std::size_t conclusion = 0; conclusion < conclusions_count; ++conclusion) {
+      const auto found = result.find(sparse.get_conclusions()[conclusion]);
+      EXPECT_NEAR(sparse_scores[(row * conclusions_count) + conclusion], found == result.end() ? 0.0 : found->second, 1e-12);
+    }
+  }
+}
+
+TEST(ReasonerOperators, min_max_scores_the_strongest_rule) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto output_variable = rules_set.add_output_variable("iris_type", {"Setosa", "Versicolor"});
+  rules_set.add_rule({{petal_length, 0}, {petal_width, 0}}, {"iris_type", "Setosa"});
+  rules_set.add_rule({{petal_length, 0}, {petal_width, 1}}, {"iris_type", "Setosa"});
+  rules_set.add_rule({{petal_length, 1}, {petal_width, 0}}, {"iris_type", "Versicolor"});
+  rules_set.add_rule({{petal_length, 1}, {petal_width, 1}}, {"iris_type", "Versicolor"});
+  const fre::BasicReasoner<fre::MinTNorm, fre::MaxAggregation> reasoner{rules_set};
+  const std::vector<double> lengths{2.0};
+  const std::vector<double> widths{4.0};
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, lengths);
+  inputs.add_column(petal_width, widths);
+  std::vector<double> scores(2);
+  reasoner.do_reasoning(inputs, scores);
+  // Degrees: length 0.8 and 0.2, width 0.6 and 0.4
+  EXPECT_THAT(scores, ::testing::ElementsAre(::testing::DoubleEq(0.6), ::testing::DoubleEq(0.2)));
+}
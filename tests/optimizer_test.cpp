@@ -0,0 +1,52 @@
+#include "gradient.hpp"
+#include "iris_model.hpp"
+#include "optimizer.hpp"
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+namespace fru = fuzzyrulesml::rules;
+namespace fre = fuzzyrulesml::reasoner;
+namespace frt = fuzzyrulesml::training;
+
+namespace {
+// A variable of 3 terms, one rule per class, the classes of the rows given by thresholds the initial points do not match
+struct Model : fuzzyrulesml::testing::IrisModel {
+  Model() : IrisModel{{{.name = "petal_length", .terms = 3, .step = 37, .period = 131, .offset = -1.0}}, 300} {
+    for (std::size_t term = 0; term < 3; ++term) {
+      rules_set.add_rule({{variables[0], term}}, {"iris_type", classes[term]});
+    }
+    for (const auto length : columns[0]) {
+      targets.push_back(length < 2.0 ? 0U : (length < 8.0 ? 1U : 2U));
+    }
+  }
+};
+} // namespace
+
+TEST(MinimizeGradient, both_methods_decrease_the_loss) {
+  const Model model;
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  const frt::CrossEntropyLoss loss{reasoner, model.inputs, model.targets, model.classes};
+  const fru::ParametersBinding binding{model.inputs};
+  const auto min_span = 0.5;
+  const auto start = loss.to_unconstrained(binding.get_parameters(), min_span);
+  std::vector<double> gradient(start.size());
+  const auto start_loss = loss.evaluate_unconstrained(start, gradient, min_span);
+  const frt::DifferentiableObjective objective = [&loss, min_span](std::span<const double> parameters, std::span<double> partials) {
+    return loss.evaluate_unconstrained(parameters, partials, min_span);
+  };
+
+  for (const auto method : {frt::GradientMethod::adam, frt::GradientMethod::lbfgs}) {
+    frt::GradientSettings settings{.method = method};
+    settings.iterations = 100;
+    const auto [result, converged] = frt::minimize_gradient(start, objective, settings);
+    ASSERT_EQ(result.best_parameters.size(), start.size());
+    EXPECT_GT(result.generation, 0U);
+    // The loss is evaluated again at the parameters reached, not taken from the optimizer
+    EXPECT_LT(loss.evaluate_unconstrained(result.best_parameters, gradient, min_span), start_loss) << "method " << static_cast<int>(method);
+  }
+}
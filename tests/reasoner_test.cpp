@@ -1,5 +1,7 @@
+#include "allocation_counter.hpp"
 #include "reasoner.hpp"
 #include "rules.hpp"
+#include <limits>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -35,4 +37,382 @@ TEST(SimpleReasoning, add_double_rule) {
 
   EXPECT_EQ(result4.size(), 1);
   EXPECT_GT(result4.at({"iris_type", "Versicolor"}), 0.0);
-}
\ No newline at end of file
+}
+TEST(BatchReasoning, matches_single_sample_reasoning) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto iris_type = std::vector<std::string>{"Setosa", "Versicolor", "Virginica"};
+  const auto output_variable = rules_set.add_output_variable("iris_type", iris_type);
+  for (std::size_t length = 0; length < 3; ++length) {
+    for (std::size_t width = 0; width < 3; ++width) {
+      rules_set.add_rule({{petal_length, length}, {petal_width, width}}, {"iris_type", iris_type[(length + (2 * width)) % 3]});
+    }
+  }
+  const fre::SimpleReasoner reasoner{rules_set};
+  const std::vector<double> lengths{0.0, 1.0, 2.5, 5.0, 6.0, 9.5, 10.0, 12.0};
+  const std::vector<double> widths{0.0, 3.0, 7.5, 4.0, 5.0, 0.5, 8.0, -1.0};
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, lengths);
+  inputs.add_column(petal_width, widths);
+  EXPECT_ANY_THROW(inputs.add_column(petal_width, widths));
+
+  const auto& conclusions = reasoner.get_conclusions();
+  ASSERT_EQ(conclusions.size(), 3);
+  std::vector<double> scores(inputs.get_rows() * conclusions.size());
+  reasoner.do_reasoning(inputs, scores);
+  for (std::size_t row = 0; row < lengths.size(); ++row) {
+    const auto result = reasoner.do_reasoning(fru::RuleTestingValues({{fru::FuzzyVarUnion{petal_length}, fru::CrispValuesUnion{lengths[row]}},
+                                                                      {fru::FuzzyVarUnion{petal_width}, fru::CrispValuesUnion{widths[row]}}}));
+    for (std::size_t conclusion = 0; conclusion < conclusions.size(); ++conclusion) {
+      const auto found = result.find(conclusions[conclusion]);
+      EXPECT_NEAR(scores[(row * conclusions.size()) + conclusion], found == result.end() ? 0.0 : found->second, 1e-12);
+    }
+  }
+  std::vector<double> too_small(1);
+  EXPECT_ANY_THROW(reasoner.do_reasoning(inputs, too_small));
+}
+
+TEST(BatchReasoning, calculate_one_counts_matches) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto output_variable = rules_set.add_output_variable("iris_type", {"Setosa", "Versicolor"});
+  rules_set.add_rule({{petal_length, 0}}, {"iris_type", "Setosa"});
+  rules_set.add_rule({{petal_length, 1}}, {"iris_type", "Versicolor"});
+  const fre::SimpleReasoner reasoner{rules_set};
+  const std::vector<double> lengths{1.0, 9.0, 2.0, 8.0};
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, lengths);
+  EXPECT_DOUBLE_EQ(fre::calculate_one(inputs, {"Setosa", "Versicolor", "Versicolor", "Versicolor"}, reasoner, false), 3.0);
+  // Class ids of the targets; the classes the conclusions do not contain never match
+  const std::vector<std::string> classes{"Virginica", "Versicolor", "Setosa"};
+  EXPECT_DOUBLE_EQ(fre::calculate_one(inputs, std::vector<std::uint32_t>{2, 1, 1, 0}, classes, reasoner, false), 2.0);
+  EXPECT_ANY_THROW(static_cast<void>(fre::calculate_one(inputs, {"Setosa"}, reasoner, false)));
+}
+
+TEST(BatchReasoning, calculate_one_without_conclusions_matches_nothing) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const fre::SimpleReasoner reasoner{rules_set};
+  ASSERT_TRUE(reasoner.get_conclusions().empty());
+  const std::vector<double> lengths{1.0, 9.0, 2.0};
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, lengths);
+  const std::vector<std::string> classes{"Setosa", "Versicolor"};
+  EXPECT_DOUBLE_EQ(fre::calculate_one(inputs, std::vector<std::uint32_t>{0, 1, 0}, classes, reasoner, false), 0.0);
+  EXPECT_DOUBLE_EQ(fre::calculate_one(inputs, std::vector<std::uint32_t>{0, 1, 0}, classes, reasoner, false, 2), 0.0);
+}
+
+TEST(BatchReasoning, calculate_one_row_firing_nothing_matches_nothing) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto output_variable = rules_set.add_output_variable("iris_type", {"Setosa", "Versicolor"});
+  rules_set.add_rule({{petal_length, 0}}, {"iris_type", "Setosa"});
+  rules_set.add_rule({{petal_length, 1}}, {"iris_type", "Versicolor"});
+  const fre::SimpleReasoner reasoner{rules_set};
+  // The missing value fires no rule, so its row is not credited to the first conclusion
+  const std::vector<double> lengths{1.0, std::numeric_limits<double>::quiet_NaN(), 9.0};
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, lengths);
+  EXPECT_DOUBLE_EQ(fre::calculate_one(inputs, {"Setosa", "Setosa", "Versicolor"}, reasoner, false), 2.0);
+  EXPECT_DOUBLE_EQ(fre::calculate_one(inputs, {"Setosa", "Setosa", "Versicolor"}, reasoner, false, 2), 2.0);
+  EXPECT_EQ(fre::get_inferred_conclusion(std::vector<double>{0.0, 0.0}), fre::no_inference);
+  EXPECT_EQ(fre::get_inferred_conclusion(std::vector<double>{0.0, 0.5}), 1);
+}
+
+TEST(BatchReasoning, threads_give_the_same_goal_function) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto iris_type = std::vector<std::string>{"Setosa", "Versicolor", "Virginica"};
+  const auto output_variable = rules_set.add_output_variable("iris_type", iris_type);
+  for (std::size_t length = 0; length < 3; ++length) {
+    for (std::size_t width = 0; width < 3; ++width) {
+      rules_set.add_rule({{petal_length, length}, {petal_width, width}}, {"iris_type", iris_type[(length + width) % 3]});
+    }
+  }
+  const fre::SimpleReasoner reasoner{rules_set};
+  std::vector<double> lengths;
+  std::vector<double> widths;
+  std::vector<std::string> targets;
+  for (std::size_t row = 0; row < 1000; ++row) {
+    lengths.push_back(static_cast<double>(row % 101) / 10.0);
+    widths.push_back(static_cast<double>((row * 7) % 103) / 10.0);
+    targets.push_back(iris_type[row % 3]);
+  }
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, lengths);
+  inputs.add_column(petal_width, widths);
+  const auto single_threaded = fre::calculate_one(inputs, targets, reasoner, false);
+  for (const std::size_t threads : {2, 3, 8, 0}) {
+    EXPECT_DOUBLE_EQ(fre::calculate_one(inputs, targets, reasoner, false, threads), single_threaded);
+  }
+  EXPECT_ANY_THROW(static_cast<void>(inputs.slice(999, 2)));
+}
+
+TEST(BatchReasoning, dense_grid_matches_posting_lists) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 4));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto sepal_length = rules_set.add_input_variable("sepal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto iris_type = std::vector<std::string>{"Setosa", "Versicolor", "Virginica"};
+  const auto output_variable = rules_set.add_output_variable("iris_type", iris_type);
+  // Near-complete grid: every fifth cell is empty
+  std::size_t cell = 0;
+  for (std::size_t length = 0; length < 4; ++length) {
+    for (std::size_t width = 0; width < 3; ++width) {
+      for (std::size_t sepal = 0; sepal < 2; ++sepal) {
+        if (++cell % 5 != 0) {
+          rules_set.add_rule({{petal_length, length}, {petal_width, width}, {sepal_length, sepal}},
+                             {"iris_type", iris_type[(length + width + sepal) % 3]});
+        }
+      }
+    }
+  }
+  const fre::SimpleReasoner dense{rules_set};
+  const fre::SimpleReasoner sparse{rules_set, fre::RulesLayout::sparse};
+  EXPECT_TRUE(dense.is_dense());
+  EXPECT_FALSE(sparse.is_dense());
+
+  std::vector<double> lengths;
+  std::vector<double> widths;
+  std::vector<double> sepals;
+  for (std::size_t row = 0; row < 600; ++row) {
+    lengths.push_back((static_cast<double>(row % 121) / 10.0) - 1.0);
+    widths.push_back(static_cast<double>((row * 7) % 103) / 10.0);
+    sepals.push_back(static_cast<double>((row * 13) % 107) / 10.0);
+  }
+  // Columns in another order than the grid axes
+  fru::BatchInputs inputs;
+  inputs.add_column(sepal_length, sepals);
+  inputs.add_column(petal_length, lengths);
+  inputs.add_column(petal_width, widths);
+  std::vector<double> dense_scores(inputs.get_rows() * iris_type.size());
+  std::vector<double> sparse_scores(dense_scores.size());
+  dense.do_reasoning(inputs, dense_scores);
+  sparse.do_reasoning(inputs, sparse_scores);
+  EXPECT_THAT(dense_scores, ::testing::Pointwise(::testing::DoubleNear(1e-12), sparse_scores));
+
+  // No rule fires without a grid variable in the batch
+  fru::BatchInputs partial;
+  partial.add_column(petal_length, lengths);
+  partial.add_column(petal_width, widths);
+  dense.do_reasoning(partial, dense_scores);
+  EXPECT_THAT(dense_scores, ::testing::Each(0.0));
+}
+
+TEST(BatchReasoning, foreign_variable_fires_no_rule) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto iris_type = std::vector<std::string>{"Setosa", "Versicolor", "Virginica"};
+  const auto output_variable = rules_set.add_output_variable("iris_type", iris_type);
+  for (std::size_t length = 0; length < 3; ++length) {
+    rules_set.add_rule({{petal_length, length}}, {"iris_type", iris_type[length]});
+  }
+  // The variable of another rules set has the same id
+  fru::RulesSet other_set;
+  const auto sepal_length = other_set.add_input_variable("sepal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  ASSERT_EQ(fru::FuzzyVarUnion{sepal_length}.get_id(), fru::FuzzyVarUnion{petal_length}.get_id());
+  EXPECT_EQ(rules_set.get_postings(sepal_length), nullptr);
+
+  const std::vector<double> lengths{0.0, 2.5, 5.0, 7.5, 10.0, 1.0, 6.0, 9.0};
+  fru::BatchInputs inputs;
+  inputs.add_column(sepal_length, lengths);
+  for (const auto layout : {fre::RulesLayout::dense, fre::RulesLayout::sparse}) {
+    const fre::SimpleReasoner reasoner{rules_set, layout};
+    std::vector<double> scores(inputs.get_rows() * reasoner.get_conclusions().size(), 1.0);
+    reasoner.do_reasoning(inputs, scores);
+    EXPECT_THAT(scores, ::testing::Each(0.0));
+    EXPECT_TRUE(reasoner.do_reasoning(fru::RuleTestingValues({{fru::FuzzyVarUnion{sepal_length}, fru::CrispValuesUnion{5.0}}})).empty());
+  }
+}
+
+TEST(BatchReasoning, dense_layout_is_selected_by_fill) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto output_variable = rules_set.add_output_variable("iris_type", {"Setosa", "Versicolor"});
+  rules_set.add_rule({{petal_length, 0}, {petal_width, 0}}, {"iris_type", "Setosa"});
+  rules_set.add_rule({{petal_length, 2}, {petal_width, 2}}, {"iris_type", "Versicolor"});
+  EXPECT_FALSE(fre::SimpleReasoner{rules_set}.is_dense());
+  const fre::SimpleReasoner dense{rules_set, fre::RulesLayout::dense};
+  EXPECT_TRUE(dense.is_dense());
+  const std::vector<double> values{0.0, 2.0, 5.0, 8.0, 10.0};
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, values);
+  inputs.add_column(petal_width, values);
+  // The middle value fires the middle terms only, of no rule, so it infers nothing
+  EXPECT_DOUBLE_EQ(fre::calculate_one(inputs, {"Setosa", "Setosa", "Setosa", "Versicolor", "Versicolor"}, dense, false), 4.0);
+
+  rules_set.add_rule({{petal_length, 1}}, {"iris_type", "Setosa"});
+  EXPECT_FALSE(fre::SimpleReasoner{rules_set}.is_dense());
+  EXPECT_ANY_THROW(fre::SimpleReasoner(rules_set, fre::RulesLayout::dense));
+}
+
+TEST(ParametersBinding, scores_candidates_as_retuned_variables) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto iris_type = std::vector<std::string>{"Setosa", "Versicolor", "Virginica"};
+  const auto output_variable = rules_set.add_output_variable("iris_type", iris_type);
+  for (std::size_t length = 0; length < 3; ++length) {
+    for (std::size_t width = 0; width < 2; ++width) {
+      rules_set.add_rule({{petal_length, length}, {petal_width, width}}, {"iris_type", iris_type[(length + width) % 3]});
+    }
+  }
+  const fre::SimpleReasoner reasoner{rules_set};
+  std::vector<double> lengths;
+  std::vector<double> widths;
+  std::vector<std::string> targets;
+  for (std::size_t row = 0; row < 300; ++row) {
+    lengths.push_back(static_cast<double>(row % 101) / 10.0);
+    widths.push_back(static_cast<double>((row * 7) % 103) / 10.0);
+    targets.push_back(iris_type[row % 3]);
+  }
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, lengths);
+  inputs.add_column(petal_width, widths);
+  fru::ParametersBinding binding{inputs};
+  ASSERT_EQ(binding.size(), 5);
+  EXPECT_EQ(std::vector<double>(binding.get_parameters().begin(), binding.get_parameters().end()),
+            (std::vector<double>{0.0, 5.0, 10.0, 0.0, 10.0}));
+
+  const std::vector<double> candidate{1.0, 4.0, 7.0, 2.0, 6.0};
+  auto length_retuned = petal_length;
+  auto width_retuned = petal_width;
+  length_retuned.set_points({1.0, 4.0, 7.0});
+  width_retuned.set_points({2.0, 6.0});
+  fru::BatchInputs retuned;
+  retuned.add_column(length_retuned, lengths);
+  retuned.add_column(width_retuned, widths);
+
+  const auto& conclusions = reasoner.get_conclusions();
+  std::vector<double> expected(inputs.get_rows() * conclusions.size());
+  std::vector<double> scores(expected.size());
+  reasoner.do_reasoning(retuned, expected);
+  reasoner.do_reasoning(inputs, binding, candidate, scores);
+  EXPECT_EQ(scores, expected);
+
+  // The optimizer writes the candidate in place
+  std::ranges::copy(candidate, binding.get_parameters().begin());
+  std::ranges::fill(scores, 0.0);
+  reasoner.do_reasoning(inputs, binding, binding.get_parameters(), scores);
+  EXPECT_EQ(scores, expected);
+  EXPECT_DOUBLE_EQ(fre::calculate_one(inputs, binding, candidate, targets, reasoner, false, 3),
+                   fre::calculate_one(retuned, targets, reasoner, false));
+
+  EXPECT_ANY_THROW(reasoner.do_reasoning(inputs, binding, std::span{candidate}.first(4), scores));
+  EXPECT_ANY_THROW(reasoner.do_reasoning(retuned.slice(0, 10), fru::ParametersBinding{fru::BatchInputs{}}, {}, scores));
+}
+
+TEST(ParametersBinding, unsorted_candidates_score_as_single_samples) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 4));
+  const auto iris_type = std::vector<std::string>{"Setosa", "Versicolor", "Virginica"};
+  const auto output_variable = rules_set.add_output_variable("iris_type", iris_type);
+  for (std::size_t length = 0; length < 4; ++length) {
+    rules_set.add_rule({{petal_length, length}}, {"iris_type", iris_type[length % 3]});
+  }
+  const fre::SimpleReasoner reasoner{rules_set};
+  std::vector<double> lengths;
+  std::vector<std::string> targets;
+  for (std::size_t row = 0; row < 64; ++row) {
+    lengths.push_back((static_cast<double>(row) / 5.0) - 1.0);
+    targets.push_back(iris_type[row % 3]);
+  }
+  fru::BatchInputs inputs;
+  inputs.add_column(petal_length, lengths);
+  const fru::ParametersBinding binding{inputs};
+
+  // The value 4.0 is in the segments 0 and 1 of the candidate points, the single sample reasoning takes the segment 0
+  const std::vector<double> candidate{0.0, 5.0, 3.0, 10.0};
+  auto length_retuned = petal_length;
+  length_retuned.set_points(candidate);
+  fru::BatchInputs retuned;
+  retuned.add_column(length_retuned, lengths);
+  const auto& conclusions = reasoner.get_conclusions();
+  std::vector<double> scores(inputs.get_rows() * conclusions.size());
+  reasoner.do_reasoning(inputs, binding, candidate, scores);
+  for (std::size_t row = 0; row < lengths.size(); ++row) {
+    const auto result =
+        reasoner.do_reasoning(fru::RuleTestingValues({{fru::FuzzyVarUnion{length_retuned}, fru::CrispValuesUnion{lengths[row]}}}));
+    for (std::size_t conclusion = 0; conclusion < conclusions.size(); ++conclusion) {
+      const auto found = result.find(conclusions[conclusion]);
+      EXPECT_NEAR(scores[(row * conclusions.size()) + conclusion], found == result.end() ? 0.0 : found->second, 1e-12) << lengths[row];
+    }
+  }
+  EXPECT_DOUBLE_EQ(fre::calculate_one(inputs, binding, candidate, targets, reasoner, false, 3),
+                   fre::calculate_one(retuned, targets, reasoner, false));
+}
+
+TEST(ParametersBinding, rescoring_allocations_do_not_depend_on_rows) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto output_variable = rules_set.add_output_variable("iris_type", {"Setosa", "Versicolor"});
+  rules_set.add_rule({{petal_length, 0}}, {"iris_type", "Setosa"});
+  rules_set.add_rule({{petal_length, 1}}, {"iris_type", "Versicolor"});
+  const fre::SimpleReasoner reasoner{rules_set};
+  const auto count_allocations = [&](std::size_t rows) {
+    const std::vector<double> lengths(rows, 1.5);
+    const std::vector<std::uint32_t> targets(rows, 0);
+    const std::vector<std::string> classes{"Setosa"};
+    fru::BatchInputs inputs;
+    inputs.add_column(petal_length, lengths);
+    const fru::ParametersBinding binding{inputs};
+    const std::vector<double> candidate{1.0, 3.0};
+    const fuzzyrulesml::testing::AllocationCounter allocations;
+    const auto goal_func = fre::calculate_one(inputs, binding, candidate, targets, classes, reasoner, false);
+    const auto count = allocations.count();
+    EXPECT_DOUBLE_EQ(goal_func, static_cast<double>(rows));
+    return count;
+  };
+  const auto small_batch = count_allocations(10);
+  EXPECT_EQ(count_allocations(10000), small_batch);
+  EXPECT_LE(small_batch, 10);
+}
+
+TEST(SimpleReasoning, sample_scores_do_not_allocate) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto iris_type = std::vector<std::string>{"Setosa", "Versicolor", "Virginica"};
+  const auto output_variable = rules_set.add_output_variable("iris_type", iris_type);
+  for (std::size_t length = 0; length < 3; ++length) {
+    for (std::size_t width = 0; width < 3; ++width) {
+      rules_set.add_rule({{petal_length, length}, {petal_width, width}}, {"iris_type", iris_type[(length + (2 * width)) % 3]});
+    }
+  }
+  rules_set.add_rule({}, {"iris_type", "Virginica"});
+  const fre::SimpleReasoner reasoner{rules_set};
+  std::vector<fru::RuleTestingValues> samples;
+  for (std::size_t row = 0; row < 50; ++row) {
+    samples.emplace_back(std::map<fru::FuzzyVarUnion, fru::CrispValuesUnion>{
+        {fru::FuzzyVarUnion{petal_length}, fru::CrispValuesUnion{static_cast<double>(row % 11)}},
+        {fru::FuzzyVarUnion{petal_width}, fru::CrispValuesUnion{static_cast<double>((row * 7) % 13) - 1.0}}});
+  }
+  std::vector<double> scores(reasoner.get_conclusions().size());
+  auto scratch = reasoner.make_sample_scratch();
+  std::vector<std::size_t> best(samples.size());
+  {
+    const fuzzyrulesml::testing::AllocationCounter allocations;
+    for (std::size_t sample = 0; sample < samples.size(); ++sample) {
+      reasoner.do_reasoning(samples[sample], scores, scratch);
+      best[sample] = fre::get_best_conclusion(scores);
+    }
+    EXPECT_EQ(allocations.count(), 0);
+  }
+
+  for (std::size_t sample = 0; sample < samples.size(); ++sample) {
+    reasoner.do_reasoning(samples[sample], scores, scratch);
+    const auto result = reasoner.do_reasoning(samples[sample]);
+    for (std::size_t conclusion = 0; conclusion < scores.size(); ++conclusion) {
+      const auto found = result.find(reasoner.get_conclusions()[conclusion]);
+      EXPECT_NEAR(scores[conclusion], found == result.end() ? 0.0 : found->second, 1e-12);
+    }
+    const auto best_found =
+        std::ranges::max_element(result, [](const auto& l_item, const auto& r_item) { return l_item.second < r_item.second; });
+    EXPECT_EQ(reasoner.get_conclusions()[best[sample]].item, best_found->first.item);
+  }
+  std::vector<double> too_small(1);
+  EXPECT_ANY_THROW(reasoner.do_reasoning(samples[0], too_small, scratch));
+}
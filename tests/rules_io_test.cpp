@@ -0,0 +1,116 @@
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include "rules_io.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+namespace fru = fuzzyrulesml::rules;
+namespace fre = fuzzyrulesml::reasoner;
+
+namespace {
+// Rules file in the temporary directory, removed at the end of the test
+class TemporaryFile {
+public:
+  explicit TemporaryFile(const std::string& name)
+      : path{(std::filesystem::temp_directory_path() / ("fuzzyRulesML_test_" + name)).string()} {}
+  ~TemporaryFile() { std::filesystem::remove(path); }
+  TemporaryFile(const TemporaryFile&) = delete;
+  auto operator=(const TemporaryFile&) -> TemporaryFile& = delete;
+  [[nodiscard]] auto get() const -> const std::string& { return path; }
+
+private:
+  std::string path;
+};
+
+// Not uniform points, an int variable, two outputs and an unconditional rule
+const std::string rules_text = R"(# iris rules
+input petal_length double 1 2.5 6.9
+input petal_width double 0.1 2.5
+input leaves int 0 3 5 10
+output iris_type Setosa Versicolor Virginica
+output quality bad good
+rule petal_length=0 petal_width=0 -> iris_type=Setosa
+rule petal_length=1 petal_width=1 -> iris_type=Versicolor
+rule petal_length=2 -> iris_type=Virginica
+rule leaves=3 -> quality=good
+rule -> quality=bad
+)";
+
+auto to_text(const fru::RulesSet& rules_set) -> std::string {
+  std::ostringstream output;
+  fru::write_rules_text(rules_set, output);
+  return output.str();
+}
+
+auto from_text(const std::string& text) -> fru::RulesSet {
+  std::istringstream input{text};
+  return fru::read_rules_text(input);
+}
+} // namespace
+
+TEST(RulesText, reads_and_writes_rules_sets) {
+  const auto rules_set = from_text(rules_text);
+  ASSERT_EQ(rules_set.get_input_variables().size(), 3);
+  EXPECT_THAT(rules_set.get_input_variables()[0].get_points(), ::testing::ElementsAre(1.0, 2.5, 6.9));
+  EXPECT_TRUE(rules_set.get_input_variables()[2].is_integer());
+  ASSERT_EQ(rules_set.get_all_rules().size(), 5);
+  EXPECT_EQ(rules_set.get_all_rules()[2].get_conclusion().item, "Virginica");
+  EXPECT_THAT(rules_set.get_unconditional_rules(), ::testing::ElementsAre(4));
+
+  const auto written = to_text(rules_set);
+  EXPECT_EQ(to_text(from_text(written)), written);
+}
+
+TEST(RulesText, rejects_invalid_declarations) {
+  EXPECT_ANY_THROW(static_cast<void>(from_text("input petal_length float 1 2\n")));
+  EXPECT_ANY_THROW(static_cast<void>(from_text("input petal_length double 1 x\n")));
+  EXPECT_ANY_THROW(static_cast<void>(from_text("output iris_type Setosa\nrule petal_length=0 -> iris_type=Setosa\n")));
+  EXPECT_ANY_THROW(static_cast<void>(from_text("input petal_length double 1 2\noutput iris_type Setosa\nrule petal_length=0\n")));
+  EXPECT_ANY_THROW(static_cast<void>(from_text("input petal_length double 1 2\noutput iris_type Setosa\nrule petal_length=0 -> iris_type=Virginica\n")));
+  EXPECT_ANY_THROW(static_cast<void>(from_text("variable petal_length\n")));
+  for (const auto* term : {"1.7", "-1", "nan", "+1", "1e0", ""}) {
+    EXPECT_ANY_THROW(static_cast<void>(from_text(std::string{"input petal_length double 1 2 3\noutput iris_type Setosa\nrule petal_length="} +
+                                                 term + " -> iris_type=Setosa\n")))
+        << term;
+  }
+  fru::RulesSet rules_set;
+  static_cast<void>(rules_set.add_input_variable("petal length", fru::initial_distribution::Uniform(0.0, 1.0, 2)));
+  EXPECT_ANY_THROW(static_cast<void>(to_text(rules_set)));
+}
+
+TEST(RulesBinary, loads_the_same_rules_set) {
+  const TemporaryFile file{"rules.bin"};
+  const auto rules_set = from_text(rules_text);
+  fru::write_rules_binary(rules_set, file.get());
+  const auto loaded = fru::read_rules_binary(file.get());
+  EXPECT_EQ(to_text(loaded), to_text(rules_set));
+  EXPECT_THAT(loaded.get_unconditional_rules(), ::testing::ElementsAre(4));
+
+  // The posting lists are built for the loaded rules too
+  const auto& variables = loaded.get_input_variables();
+  const fru::RuleTestingValues values{std::map<fru::FuzzyVarUnion, fru::CrispValuesUnion>{
+      {variables[0], fru::CrispValuesUnion{2.0}}, {variables[1], fru::CrispValuesUnion{1.0}}, {variables[2], fru::CrispValuesUnion{4}}}};
+  EXPECT_EQ(loaded.get_rules_ids(values), rules_set.get_rules_ids(values));
+  const fre::SimpleReasoner reasoner{loaded};
+  const fre::SimpleReasoner expected_reasoner{rules_set};
+  EXPECT_EQ(reasoner.do_reasoning(values).size(), expected_reasoner.do_reasoning(values).size());
+}
+
+TEST(RulesBinary, rejects_invalid_files) {
+  const TemporaryFile file{"rules_invalid.bin"};
+  fru::write_rules_binary(from_text(rules_text), file.get());
+  const auto size = std::filesystem::file_size(file.get());
+  std::filesystem::resize_file(file.get(), size - 1);
+  EXPECT_ANY_THROW(static_cast<void>(fru::read_rules_binary(file.get())));
+  {
+    std::ofstream output{file.get(), std::ofstream::binary | std::ofstream::trunc};
+    output << "FRMLCOL1";
+  }
+  EXPECT_ANY_THROW(static_cast<void>(fru::read_rules_binary(file.get())));
+  EXPECT_ANY_THROW(static_cast<void>(fru::read_rules_binary(file.get() + ".missing")));
+}
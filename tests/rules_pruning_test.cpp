@@ -0,0 +1,186 @@
+#include "iris_model.hpp"
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include "rules_pruning.hpp"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+namespace fru = fuzzyrulesml::rules;
+namespace fre = fuzzyrulesml::reasoner;
+
+namespace {
+// Two variables of 2 terms and one of 3 terms; the classes are given by the width only, the heights are all below the
+// middle point, so the last term of the height never fires
+struct Model : fuzzyrulesml::testing::IrisModel {
+  Model()
+      : IrisModel{{{.name = "petal_length", .terms = 2, .step = 37, .period = 101},
+                   {.name = "petal_width", .terms = 2, .step = 53, .period = 103},
+                   {.name = "height", .terms = 3, .step = 7, .period = 41}},
+                  300} {
+    const auto& length = variables[0];
+    const auto& width = variables[1];
+    const auto& height = variables[2];
+    rules_set.add_rule({{length, 0}, {width, 0}}, {"iris_type", "Setosa"});     // 0, merged with 1
+    rules_set.add_rule({{length, 1}, {width, 0}}, {"iris_type", "Setosa"});     // 1
+    rules_set.add_rule({{length, 0}, {width, 1}}, {"iris_type", "Versicolor"}); // 2
+    rules_set.add_rule({{length, 0}, {width, 1}}, {"iris_type", "Virginica"});  // 3, dominated by 2
+    rules_set.add_rule({{length, 1}, {width, 1}}, {"iris_type", "Virginica"});  // 4
+    rules_set.add_rule({{height, 2}}, {"iris_type", "Setosa"});                 // 5, dead
+    for (const auto width_value : columns[1]) {
+      targets.push_back(width_value < 5.0 ? 0U : 1U);
+    }
+  }
+};
+
+auto get_scores(const fru::RulesSet& rules_set, const fru::BatchInputs& inputs) -> std::vector<double> {
+  const fre::SimpleReasoner reasoner{rules_set};
+  std::vector<double> scores(inputs.get_rows() * reasoner.get_conclusions().size());
+  reasoner.do_reasoning(inputs, scores);
+  return scores;
+}
+} // namespace
+
+TEST(RulesPruning, counts_firing_statistics) {
+  const Model model;
+  const fre::SimpleReasoner reasoner{model.rules_set};
+  const auto statistics = fru::get_rules_statistics(reasoner, model.inputs, model.targets, model.classes);
+  ASSERT_EQ(statistics.size(), 6);
+  EXPECT_EQ(statistics[5].fired_rows, 0);
+  EXPECT_EQ(statistics[5].strength, 0.0);
+  EXPECT_GT(statistics[0].fired_rows, 0);
+  EXPECT_GT(statistics[2].target_strength, 0.0);
+  EXPECT_EQ(statistics[3].target_strength, 0.0);
+  EXPECT_EQ(statistics[2].fired_rows, statistics[3].fired_rows);
+  EXPECT_DOUBLE_EQ(statistics[2].strength, statistics[3].strength);
+
+  // The strengths of all the rows sum up to the scores of the batch reasoning
+  const auto scores = get_scores(model.rules_set, model.inputs);
+  double scores_sum = 0.0;
+  for (const auto score : scores) {
+    scores_sum += score;
+  }
+  double strengths_sum = 0.0;
+  for (const auto& rule_statistics : statistics) {
+    strengths_sum += rule_statistics.strength;
+  }
+  EXPECT_NEAR(strengths_sum, scores_sum, 1e-9);
+
+  // The parts of the threads are summed separately, so the strengths differ by the rounding only
+  const auto threads_statistics = fru::get_rules_statistics(reasoner, model.inputs, model.targets, model.classes, 3);
+  for (std::size_t rule_id = 0; rule_id < statistics.size(); ++rule_id) {
+    EXPECT_EQ(threads_statistics[rule_id].fired_rows, statistics[rule_id].fired_rows);
+    EXPECT_NEAR(threads_statistics[rule_id].strength, statistics[rule_id].strength, 1e-9);
+    EXPECT_NEAR(threads_statistics[rule_id].target_strength, statistics[rule_id].target_strength, 1e-9);
+  }
+
+  // The minimum t-norm fires the same rules with other strengths
+  const fre::BasicReasoner<fre::MinTNorm> minimum{model.rules_set};
+  const auto minimum_statistics = fru::get_rules_statistics(minimum, model.inputs, model.targets, model.classes);
+  for (std::size_t rule_id = 0; rule_id < statistics.size(); ++rule_id) {
+    EXPECT_EQ(minimum_statistics[rule_id].fired_rows, statistics[rule_id].fired_rows);
+    EXPECT_GE(minimum_statistics[rule_id].strength, statistics[rule_id].strength);
+  }
+}
+
+TEST(RulesPruning, removes_dominated_merged_and_dead_rules) {
+  const Model model;
+  const auto compacted = fru::compact_rules(fre::SimpleReasoner{model.rules_set}, model.inputs, model.targets, model.classes);
+  EXPECT_EQ(compacted.dominated, 1);
+  EXPECT_EQ(compacted.merged, 1);
+  EXPECT_EQ(compacted.dead, 1);
+  const auto& rules = compacted.rules_set.get_all_rules();
+  ASSERT_EQ(rules.size(), 3);
+  EXPECT_EQ(rules.back().get_preconditions().size(), 1);
+  EXPECT_EQ(rules.back().get_preconditions().begin()->first.get_name(), "petal_width");
+  EXPECT_EQ(rules.back().get_conclusion().item, "Setosa");
+  EXPECT_EQ(compacted.rules_set.get_input_variables_labels(), model.rules_set.get_input_variables_labels());
+
+  // The merged rule scores the same as the merged ones for the product t-norm and the sum aggregation only
+  const auto minimum = fru::compact_rules(fre::BasicReasoner<fre::MinTNorm>{model.rules_set}, model.inputs, model.targets, model.classes);
+  EXPECT_EQ(minimum.dominated, 1);
+  EXPECT_EQ(minimum.merged, 0);
+  EXPECT_EQ(minimum.rules_set.get_all_rules().size(), 4);
+}
+
+TEST(RulesPruning, merged_rules_score_the_same) {
+  // The full grid of the same conclusion by the length merges into the rules of the width, then into a single
+  // unconditional rule
+  Model model;
+  fru::RulesSet grid;
+  const auto length = grid.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto width = grid.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  static_cast<void>(grid.add_output_variable("iris_type", model.classes));
+  for (std::size_t term = 0; term < 3; ++term) {
+    grid.add_rule({{length, 0}, {width, term}}, {"iris_type", "Setosa"});
+    grid.add_rule({{length, 1}, {width, term}}, {"iris_type", "Setosa"});
+  }
+  grid.add_rule({{length, 1}, {width, 2}}, {"iris_type", "Virginica"});
+  fru::BatchInputs inputs;
+  inputs.add_column(length, model.columns[0]);
+  inputs.add_column(width, model.columns[1]);
+
+  const auto compacted = fru::compact_rules(fre::SimpleReasoner{grid}, inputs, model.targets, model.classes);
+  EXPECT_EQ(compacted.dominated, 1);
+  EXPECT_EQ(compacted.merged, 5);
+  EXPECT_EQ(compacted.dead, 0);
+  ASSERT_EQ(compacted.rules_set.get_all_rules().size(), 1);
+  EXPECT_EQ(compacted.rules_set.get_unconditional_rules().size(), 1);
+
+  fru::RulesSet without_dominated;
+  const auto length_kept = without_dominated.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto width_kept = without_dominated.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  static_cast<void>(without_dominated.add_output_variable("iris_type", model.classes));
+  for (std::size_t term = 0; term < 3; ++term) {
+    without_dominated.add_rule({{length_kept, 0}, {width_kept, term}}, {"iris_type", "Setosa"});
+    without_dominated.add_rule({{length_kept, 1}, {width_kept, term}}, {"iris_type", "Setosa"});
+  }
+  const auto expected = get_scores(without_dominated, inputs);
+  const auto scores = get_scores(compacted.rules_set, inputs);
+  ASSERT_EQ(scores.size(), expected.size());
+  for (std::size_t i = 0; i < scores.size(); ++i) {
+    EXPECT_NEAR(scores[i], expected[i], 1e-12);
+  }
+}
+
+TEST(RulesPruning, keeps_variables_of_missing_values) {
+  // A missing length fires no term of the length, so the rules of the length are not merged; the grid merges by the
+  // width into the rules of the length only
+  Model model;
+  model.columns[0][1] = std::numeric_limits<double>::quiet_NaN();
+  fru::RulesSet grid;
+  const auto length = grid.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto width = grid.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  static_cast<void>(grid.add_output_variable("iris_type", model.classes));
+  for (std::size_t term = 0; term < 3; ++term) {
+    grid.add_rule({{length, 0}, {width, term}}, {"iris_type", "Setosa"});
+    grid.add_rule({{length, 1}, {width, term}}, {"iris_type", "Setosa"});
+  }
+  fru::BatchInputs inputs;
+  inputs.add_column(length, model.columns[0]);
+  inputs.add_column(width, model.columns[1]);
+
+  const auto compacted = fru::compact_rules(fre::SimpleReasoner{grid}, inputs, model.targets, model.classes);
+  EXPECT_EQ(compacted.merged, 4);
+  ASSERT_EQ(compacted.rules_set.get_all_rules().size(), 2);
+  EXPECT_TRUE(compacted.rules_set.get_unconditional_rules().empty());
+  const auto expected = get_scores(grid, inputs);
+  const auto scores = get_scores(compacted.rules_set, inputs);
+  ASSERT_EQ(scores.size(), expected.size());
+  for (std::size_t i = 0; i < scores.size(); ++i) {
+    EXPECT_NEAR(scores[i], expected[i], 1e-12);
+  }
+
+  // Nor are the rules of a variable out of the batch: the length is kept with the width column only
+  fru::BatchInputs widths;
+  widths.add_column(width, model.columns[1]);
+  const auto merged = fru::merge_rules(grid, widths);
+  ASSERT_EQ(merged.get_all_rules().size(), 2);
+  for (const auto& rule : merged.get_all_rules()) {
+    ASSERT_EQ(rule.get_preconditions().size(), 1);
+    EXPECT_EQ(rule.get_preconditions().begin()->first.get_name(), "petal_length");
+  }
+}
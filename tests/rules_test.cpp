@@ -1,15 +1,12 @@
 #include "rules.hpp"
+#include <cstdint>
 #include <map>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 namespace fru = fuzzyrulesml::rules;
 
-namespace fuzzyrulesml::rules {
-  auto get_matching_rules(auto rules, const std::multimap<FuzzyVarUnion, std::size_t>& variables_map) -> std::vector<Rule>;
-}
-
-
 TEST(RuleSetsVariables, add_input) {
   fru::RulesSet rules_set;
   rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 4));
@@ -68,6 +65,24 @@ TEST(RuleSetsVariables, variable_size) {
   EXPECT_EQ(petal_length.size(), 4);
 }
 
+TEST(RuleSetsVariables, dense_ids) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 4));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0, 10, 4));
+  EXPECT_EQ(petal_length.get_id(), 0);
+  EXPECT_EQ(petal_width.get_id(), 1);
+  EXPECT_EQ(fru::FuzzyVarUnion{petal_width}.get_id(), 1);
+  EXPECT_TRUE(fru::FuzzyVarUnion{petal_length} < fru::FuzzyVarUnion{petal_width});
+  EXPECT_EQ(rules_set.get_input_variables_labels(), (std::vector<std::string>{"petal_length", "petal_width"}));
+
+  fru::RulesSet other_set;
+  const auto sepal_length = other_set.add_input_variable("sepal_length", fru::initial_distribution::Uniform(0.0, 10.0, 4));
+  const auto output_variable = rules_set.add_output_variable("iris_type", {"Setosa"});
+  EXPECT_EQ(sepal_length.get_id(), petal_length.get_id());
+  EXPECT_ANY_THROW(rules_set.add_rule({{sepal_length, 0}}, {"iris_type", "Setosa"}));
+  EXPECT_NO_THROW(rules_set.add_rule({{petal_length, 0}}, {"iris_type", "Setosa"}));
+}
+
 TEST(RuleSetsVariablesValues, get_membership_functions_boundaries) {
   fru::RulesSet rules_set;
   const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 4));
@@ -207,4 +222,183 @@ TEST(RuleSetsAddOutput, add_double_valued_rule) {
                     {fru::FuzzyVarUnion{petal_width}, fru::CrispValuesUnion{9.0}}}))
                 .size(),
             0);
-}
\ No newline at end of file
+}
+TEST(RuleSetsIndex, matches_linear_scan) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto iris_type = std::vector<std::string>{"Setosa", "Versicolor", "Virginica"};
+  const auto output_variable = rules_set.add_output_variable("iris_type", iris_type);
+  for (std::size_t length = 0; length < 3; ++length) {
+    for (std::size_t width = 0; width < 3; ++width) {
+      rules_set.add_rule({{petal_length, length}, {petal_width, width}}, {"iris_type", iris_type[(length + width) % 3]});
+    }
+  }
+  rules_set.add_rule({{petal_width, 2}}, {"iris_type", "Virginica"});
+  EXPECT_EQ(rules_set.get_all_rules().size(), 10);
+
+  for (const auto length_value : {0.0, 2.5, 5.0, 7.5, 10.0}) {
+    for (const auto width_value : {0.0, 1.0, 5.0, 9.0, 10.0}) {
+      const fru::RuleTestingValues values{std::map<fru::FuzzyVarUnion, fru::CrispValuesUnion>{
+          {fru::FuzzyVarUnion{petal_length}, fru::CrispValuesUnion{length_value}},
+          {fru::FuzzyVarUnion{petal_width}, fru::CrispValuesUnion{width_value}}}};
+      std::multimap<fru::FuzzyVarUnion, std::size_t> fired;
+      for (const auto& [variable, crisp_value] : values) {
+        for (const auto& member : variable.get_membership(crisp_value)) {
+          fired.insert({variable, member.first});
+        }
+      }
+      const auto indexed = rules_set.get_rules(values);
+      const auto scanned = fru::get_matching_rules(rules_set.get_all_rules(), fired);
+      ASSERT_EQ(indexed.size(), scanned.size());
+      for (std::size_t i = 0; i < indexed.size(); ++i) {
+        EXPECT_EQ(indexed[i].get_conclusion().item, scanned[i].get_conclusion().item);
+        EXPECT_EQ(indexed[i].get_preconditions().size(), scanned[i].get_preconditions().size());
+      }
+    }
+  }
+}
+
+TEST(RuleSetsIndex, reuses_match_scratch_across_rules_sets) {
+  // The fired terms of the wide grid cover a small part of its rules, so their counters are reset one by one; those of
+  // the other rules sets are cleared at once
+  const std::uint32_t wide_terms = 40;
+  fru::RulesSet wide;
+  fru::RulesSet pairs;
+  fru::RulesSet singles;
+  for (auto* rules_set : {&wide, &pairs, &singles}) {
+    const auto terms = rules_set == &wide ? wide_terms : 3;
+    static_cast<void>(rules_set->add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, terms)));
+    static_cast<void>(rules_set->add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, terms)));
+    static_cast<void>(rules_set->add_output_variable("iris_type", {"Setosa", "Versicolor", "Virginica"}));
+  }
+  for (std::uint32_t length = 0; length < wide_terms; ++length) {
+    for (std::uint32_t width = 0; width < wide_terms; ++width) {
+      wide.add_rule_by_ids(std::vector<std::uint32_t>{0, length, 1, width}, {"iris_type", "Setosa"});
+    }
+  }
+  for (std::uint32_t length = 0; length < 3; ++length) {
+    for (std::uint32_t width = 0; width < 3; ++width) {
+      pairs.add_rule_by_ids(std::vector<std::uint32_t>{0, length, 1, width}, {"iris_type", "Setosa"});
+    }
+    singles.add_rule_by_ids(std::vector<std::uint32_t>{1, length}, {"iris_type", "Versicolor"});
+  }
+  singles.add_rule_by_ids({}, {"iris_type", "Virginica"});
+
+  // The counters left by a call, of any rules set, do not count for the next one
+  fru::RulesSet::MatchScratch scratch;
+  for (const auto length_value : {0.0, 2.6, 5.0, 7.4, 10.0}) {
+    for (const auto width_value : {0.0, 1.1, 5.0, 9.3, 10.0}) {
+      for (const auto* rules_set : {&wide, &pairs, &wide, &singles, &pairs}) {
+        const fru::RuleTestingValues values{std::map<fru::FuzzyVarUnion, fru::CrispValuesUnion>{
+            {rules_set->get_input_variables()[0], fru::CrispValuesUnion{length_value}},
+            {rules_set->get_input_variables()[1], fru::CrispValuesUnion{width_value}}}};
+        fru::RulesSet::MatchScratch fresh;
+        const auto expected = rules_set->get_rules_ids(values, fresh);
+        EXPECT_FALSE(expected.empty());
+        EXPECT_EQ(rules_set->get_rules_ids(values, scratch), expected) << length_value << " " << width_value;
+        EXPECT_EQ(rules_set->get_rules_ids(values), expected) << length_value << " " << width_value;
+      }
+    }
+  }
+}
+
+TEST(RuleSetsIndex, adds_rules_by_ids) {
+  fru::RulesSet by_variables;
+  fru::RulesSet by_ids;
+  for (auto* rules_set : {&by_variables, &by_ids}) {
+    static_cast<void>(rules_set->add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3)));
+    static_cast<void>(rules_set->add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3)));
+    static_cast<void>(rules_set->add_output_variable("iris_type", {"Setosa", "Versicolor", "Virginica"}));
+  }
+  const auto& variables = by_variables.get_input_variables();
+  by_variables.add_rule({{variables[0], 1}, {variables[1], 2}}, {"iris_type", "Versicolor"});
+  by_variables.add_rule({{variables[1], 0}}, {"iris_type", "Setosa"});
+  by_variables.add_rule({}, {"iris_type", "Virginica"});
+  by_ids.add_rule_by_ids(std::vector<std::uint32_t>{0, 1, 1, 2}, {"iris_type", "Versicolor"});
+  by_ids.add_rule_by_ids(std::vector<std::uint32_t>{1, 0}, {"iris_type", "Setosa"});
+  by_ids.add_rule_by_ids({}, {"iris_type", "Virginica"});
+
+  ASSERT_EQ(by_ids.get_all_rules().size(), 3);
+  for (std::size_t rule_id = 0; rule_id < 3; ++rule_id) {
+    EXPECT_EQ(by_ids.get_all_rules()[rule_id].get_preconditions(), by_variables.get_all_rules()[rule_id].get_preconditions());
+    EXPECT_EQ(by_ids.get_all_rules()[rule_id].get_conclusion().item, by_variables.get_all_rules()[rule_id].get_conclusion().item);
+    EXPECT_EQ(by_ids.get_preconditions_count(rule_id), by_variables.get_preconditions_count(rule_id));
+  }
+  for (std::size_t variable = 0; variable < 2; ++variable) {
+    EXPECT_EQ(*by_ids.get_postings(by_ids.get_input_variables()[variable]), *by_variables.get_postings(variables[variable]));
+  }
+  EXPECT_EQ(by_ids.get_unconditional_rules(), by_variables.get_unconditional_rules());
+
+  EXPECT_ANY_THROW(by_ids.add_rule_by_ids(std::vector<std::uint32_t>{1, 0, 0, 0}, {"iris_type", "Setosa"}));
+  EXPECT_ANY_THROW(by_ids.add_rule_by_ids(std::vector<std::uint32_t>{2, 0}, {"iris_type", "Setosa"}));
+  EXPECT_ANY_THROW(by_ids.add_rule_by_ids(std::vector<std::uint32_t>{0}, {"iris_type", "Setosa"}));
+  EXPECT_ANY_THROW(by_ids.add_rule_by_ids(std::vector<std::uint32_t>{0, 0}, {"iris_type", "Iris"}));
+  EXPECT_EQ(by_ids.get_all_rules().size(), 3);
+}
+
+TEST(RuleSetsIndex, adds_flat_rules_by_ids) {
+  fru::RulesSet by_variables;
+  fru::RulesSet by_ids;
+  for (auto* rules_set : {&by_variables, &by_ids}) {
+    static_cast<void>(rules_set->add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3)));
+    static_cast<void>(rules_set->add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 3)));
+    static_cast<void>(rules_set->add_output_variable("iris_type", {"Setosa", "Versicolor", "Virginica"}));
+  }
+  const auto& variables = by_variables.get_input_variables();
+  by_variables.add_rule({{variables[0], 1}, {variables[1], 2}}, {"iris_type", "Versicolor"});
+  by_variables.add_rule({{variables[1], 0}}, {"iris_type", "Setosa"});
+  by_variables.add_rule({}, {"iris_type", "Virginica"});
+
+  const std::vector<std::uint32_t> preconditions{0, 1, 1, 2, 1, 0};
+  by_ids.add_rules_by_ids(preconditions, std::vector<std::uint32_t>{2, 1, 0}, std::vector<std::uint32_t>{1, 0, 2});
+  const auto copied = by_ids;
+  by_ids.add_rule({{by_ids.get_input_variables()[0], 2}}, {"iris_type", "Setosa"});
+
+  ASSERT_EQ(copied.get_rules_count(), 3);
+  ASSERT_EQ(copied.get_all_rules().size(), 3);
+  for (std::size_t rule_id = 0; rule_id < 3; ++rule_id) {
+    EXPECT_EQ(copied.get_all_rules()[rule_id].get_preconditions(), by_variables.get_all_rules()[rule_id].get_preconditions());
+    EXPECT_EQ(copied.get_rule_conclusion(rule_id).item, by_variables.get_all_rules()[rule_id].get_conclusion().item);
+    EXPECT_EQ(copied.get_preconditions_count(rule_id), by_variables.get_preconditions_count(rule_id));
+  }
+  for (std::size_t variable = 0; variable < 2; ++variable) {
+    EXPECT_EQ(*copied.get_postings(copied.get_input_variables()[variable]), *by_variables.get_postings(variables[variable]));
+  }
+  EXPECT_EQ(copied.get_unconditional_rules(), by_variables.get_unconditional_rules());
+  ASSERT_EQ(by_ids.get_all_rules().size(), 4);
+  EXPECT_EQ(by_ids.get_all_rules()[3].get_preconditions().at(by_ids.get_input_variables()[0]), 2);
+  EXPECT_EQ(by_ids.get_all_rules()[3].get_conclusion().item, "Setosa");
+
+  const std::vector<std::uint32_t> one_rule{1};
+  const std::vector<std::uint32_t> setosa{0};
+  EXPECT_ANY_THROW(by_ids.add_rules_by_ids(std::vector<std::uint32_t>{0, 3}, one_rule, setosa));
+  EXPECT_ANY_THROW(by_ids.add_rules_by_ids(std::vector<std::uint32_t>{0, 0}, one_rule, std::vector<std::uint32_t>{3}));
+  EXPECT_ANY_THROW(by_ids.add_rules_by_ids(std::vector<std::uint32_t>{0, 0, 1, 0}, one_rule, setosa));
+  EXPECT_ANY_THROW(by_ids.add_rules_by_ids(std::vector<std::uint32_t>{0, 0}, one_rule, std::vector<std::uint32_t>{0, 0}));
+  EXPECT_EQ(by_ids.get_rules_count(), 4);
+}
+
+TEST(RuleSetsDenseGrid, lays_out_full_and_partial_grids) {
+  fru::RulesSet rules_set;
+  const auto petal_length = rules_set.add_input_variable("petal_length", fru::initial_distribution::Uniform(0.0, 10.0, 3));
+  const auto petal_width = rules_set.add_input_variable("petal_width", fru::initial_distribution::Uniform(0.0, 10.0, 2));
+  const auto output_variable = rules_set.add_output_variable("iris_type", {"Setosa", "Versicolor"});
+  EXPECT_FALSE(rules_set.get_dense_grid());
+  rules_set.add_rule({{petal_length, 2}, {petal_width, 1}}, {"iris_type", "Setosa"});
+  rules_set.add_rule({{petal_length, 0}, {petal_width, 1}}, {"iris_type", "Versicolor"});
+  const auto grid = rules_set.get_dense_grid();
+  ASSERT_TRUE(grid);
+  EXPECT_THAT(grid->get_variables(), ::testing::ElementsAre(petal_length.get_id(), petal_width.get_id()));
+  EXPECT_THAT(grid->get_strides(), ::testing::ElementsAre(2, 1));
+  const auto no_rule = fru::DenseRulesGrid::no_rule;
+  EXPECT_THAT(grid->get_cells(), ::testing::ElementsAre(no_rule, 1, no_rule, no_rule, no_rule, 0));
+  EXPECT_EQ(grid->get_filled(), 2);
+
+  // A cell of two rules and a rule testing a part of the variables have no dense layout
+  auto duplicated = rules_set;
+  duplicated.add_rule({{petal_length, 0}, {petal_width, 1}}, {"iris_type", "Setosa"});
+  EXPECT_FALSE(duplicated.get_dense_grid());
+  rules_set.add_rule({{petal_width, 0}}, {"iris_type", "Setosa"});
+  EXPECT_FALSE(rules_set.get_dense_grid());
+}
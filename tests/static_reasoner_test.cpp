@@ -0,0 +1,178 @@
+#include "reasoner.hpp"
+#include "rules.hpp"
+#include "static_reasoner.hpp"
+#include <array>
+#include <limits>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+namespace fru = fuzzyrulesml::rules;
+namespace fre = fuzzyrulesml::reasoner;
+
+namespace {
+// The iris rule base of main.cpp: small and large terms of sepal length and width, petal length and width
+constexpr std::array iris_terms{std::size_t{2}, std::size_t{2}, std::size_t{2}, std::size_t{2}};
+constexpr std::uint32_t small = 0;
+constexpr std::uint32_t large = 1;
+constexpr std::uint32_t setosa = 0;
+constexpr std::uint32_t versicolor = 1;
+constexpr std::uint32_t virginica = 2;
+constexpr std::array<fre::StaticRule<4>, 16> iris_rules{{{{small, small, small, small}, setosa},
+                                                         {{small, small, small, large}, versicolor},
+                                                         {{small, small, large, small}, versicolor},
+                                                         {{small, small, large, large}, virginica},
+                                                         {{small, large, small, small}, setosa},
+                                                         {{small, large, small, large}, versicolor},
+                                                         {{small, large, large, small}, setosa},
+                                                         {{small, large, large, large}, versicolor},
+                                                         {{large, small, small, small}, versicolor},
+                                                         {{large, small, small, large}, virginica},
+                                                         {{large, small, large, small}, versicolor},
+                                                         {{large, small, large, large}, virginica},
+                                                         {{large, large, small, small}, versicolor},
+                                                         {{large, large, small, large}, versicolor},
+                                                         {{large, large, large, small}, versicolor},
+                                                         {{large, large, large, large}, virginica}}};
+using IrisReasoner = fre::StaticReasoner<iris_terms, iris_rules, 3>;
+
+// Three terms of the first variable, rules not testing all the variables and an unconditional one
+constexpr std::array partial_terms{std::size_t{3}, std::size_t{2}};
+constexpr std::array<fre::StaticRule<2>, 5> partial_rules{{{{0, fre::any_term}, 0},
+                                                           {{1, 1}, 1},
+                                                           {{2, 0}, 1},
+                                                           {{fre::any_term, 1}, 0},
+                                                           {{fre::any_term, fre::any_term}, 1}}};
+using PartialReasoner = fre::StaticReasoner<partial_terms, partial_rules, 2>;
+
+// Four terms of a single variable, so that not sorted points have values in two segments
+constexpr std::array single_terms{std::size_t{4}};
+constexpr std::array<fre::StaticRule<1>, 4> single_rules{{{{0}, 0}, {{1}, 1}, {{2}, 0}, {{3}, 1}}};
+using SingleReasoner = fre::StaticReasoner<single_terms, single_rules, 2>;
+
+// Scores the rows with the static reasoner and with SimpleReasoner of the rules set built by add_rules
+template <typename STATIC_REASONER>
+void expect_same_scores(const std::array<std::size_t, STATIC_REASONER::variables_count>& terms, const std::vector<std::vector<double>>& columns) {
+  fru::RulesSet rules_set;
+  std::array<std::optional<fru::FuzzyVarUnion>, STATIC_REASONER::variables_count> added;
+  for (std::size_t variable = 0; variable < added.size(); ++variable) {
+    added[variable] =
+        rules_set.add_input_variable("variable_" + std::to_string(variable), fru::initial_distribution::Uniform(-1.0, 1.0, terms[variable]));
+  }
+  const auto variables = [&added]<std::size_t... VARIABLE>(std::index_sequence<VARIABLE...> /*variables*/) {
+    return std::array<fru::FuzzyVarUnion, sizeof...(VARIABLE)>{*added[VARIABLE]...};
+  }(std::make_index_sequence<STATIC_REASONER::variables_count>{});
+  std::vector<std::string> categories;
+  for (std::size_t conclusion = 0; conclusion < STATIC_REASONER::conclusions_count; ++conclusion) {
+    categories.push_back("class_" + std::to_string(conclusion));
+  }
+  const auto output = rules_set.add_output_variable("output", categories);
+  STATIC_REASONER::add_rules(rules_set, variables, output);
+  const fre::SimpleReasoner reasoner{rules_set};
+
+  fru::BatchInputs inputs;
+  for (std::size_t variable = 0; variable < variables.size(); ++variable) {
+    inputs.add_column(variables[variable], columns[variable]);
+  }
+  const fru::ParametersBinding binding{inputs};
+  const STATIC_REASONER static_reasoner{binding.get_parameters()};
+  ASSERT_EQ(reasoner.get_conclusions().size(), STATIC_REASONER::conclusions_count);
+  std::vector<double> expected(inputs.get_rows() * STATIC_REASONER::conclusions_count);
+  std::vector<double> scores(expected.size());
+  reasoner.do_reasoning(inputs, expected);
+  static_reasoner.do_reasoning(inputs, scores);
+  EXPECT_THAT(scores, ::testing::Pointwise(::testing::DoubleNear(1e-12), expected));
+
+  for (std::size_t row = 0; row < inputs.get_rows(); ++row) {
+    typename STATIC_REASONER::Row values{};
+    for (std::size_t variable = 0; variable < values.size(); ++variable) {
+      values[variable] = columns[variable][row];
+    }
+    EXPECT_THAT(static_reasoner.do_reasoning(values),
+                ::testing::Pointwise(::testing::DoubleNear(1e-12),
+                                     std::span{expected}.subspan(row * STATIC_REASONER::conclusions_count, STATIC_REASONER::conclusions_count)));
+  }
+}
+
+auto make_columns(std::size_t variables, std::size_t rows) -> std::vector<std::vector<double>> {
+  std::mt19937_64 generator{7};
+  std::uniform_real_distribution<double> value{-1.2, 1.2};
+  std::vector<std::vector<double>> columns(variables);
+  for (auto& column : columns) {
+    // Points and out of the range values first
+    column = {-1.0, 0.0, 1.0, -2.0, 2.0};
+    while (column.size() < rows) {
+      column.push_back(value(generator));
+    }
+  }
+  return columns;
+}
+} // namespace
+
+TEST(StaticReasoner, matches_simple_reasoner) {
+  expect_same_scores<IrisReasoner>(iris_terms, make_columns(4, 300));
+  expect_same_scores<PartialReasoner>(partial_terms, make_columns(2, 300));
+}
+
+TEST(StaticReasoner, matches_simple_reasoner_for_unsorted_points) {
+  fru::RulesSet rules_set;
+  const auto variable = rules_set.add_input_variable("variable_0", fru::initial_distribution::Uniform(0.0, 10.0, 4));
+  const auto output = rules_set.add_output_variable("output", std::vector<std::string>{"class_0", "class_1"});
+  SingleReasoner::add_rules(rules_set, {variable}, output);
+  const fre::SimpleReasoner reasoner{rules_set};
+  // The value 4.0 is in the segments 0 and 1 of the points
+  const std::vector<double> points{0.0, 5.0, 3.0, 10.0};
+  auto retuned = variable;
+  retuned.set_points(points);
+  const SingleReasoner static_reasoner{points};
+  const auto& conclusions = reasoner.get_conclusions();
+  for (double value = -1.0; value <= 11.0; value += 0.25) {
+    const auto result = reasoner.do_reasoning(fru::RuleTestingValues({{fru::FuzzyVarUnion{retuned}, fru::CrispValuesUnion{value}}}));
+    const auto scores = static_reasoner.do_reasoning({value});
+    for (std::size_t conclusion = 0; conclusion < conclusions.size(); ++conclusion) {
+      const auto found = result.find(conclusions[conclusion]);
+      EXPECT_NEAR(scores[conclusion], found == result.end() ? 0.0 : found->second, 1e-12) << value;
+    }
+  }
+}
+
+TEST(StaticReasoner, reasons_at_compile_time) {
+  static constexpr std::array<double, 5> points{0.0, 1.0, 2.0, 0.0, 1.0};
+  constexpr auto scores = PartialReasoner{points}.do_reasoning({0.25, 0.5});
+  // Degrees 0.75, 0.25, 0.0 and 0.5, 0.5: rules 1 and 4 give the first conclusion, rules 2, 3 and 5 the second one
+  static_assert(scores[0] == 1.25);
+  static_assert(scores[1] == 1.125);
+  EXPECT_EQ(IrisReasoner::parameters_count, 8);
+}
+
+TEST(StaticReasoner, missing_value_fires_no_rule_of_its_variable) {
+  constexpr auto missing = std::numeric_limits<double>::quiet_NaN();
+  expect_same_scores<IrisReasoner>(iris_terms, {{0.5, missing}, {missing, 0.5}, {0.5, 0.5}, {-0.5, missing}});
+  expect_same_scores<PartialReasoner>(partial_terms, {{missing, 0.25, missing}, {0.5, missing, missing}});
+
+  static constexpr std::array<double, 5> points{0.0, 1.0, 2.0, 0.0, 1.0};
+  constexpr auto scores = PartialReasoner{points}.do_reasoning({missing, 0.5});
+  // Only the rules not testing the first variable fire: rule 4 gives the first conclusion, rule 5 the second one
+  static_assert(scores[0] == 0.5);
+  static_assert(scores[1] == 1.0);
+  // Each iris rule tests all the variables
+  const IrisReasoner iris{std::vector<double>{-1.0, 1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 1.0}};
+  EXPECT_THAT(iris.do_reasoning({missing, 0.0, 0.0, 0.0}), ::testing::Each(0.0));
+}
+
+TEST(StaticReasoner, rejects_invalid_sizes) {
+  const std::vector<double> points{0.0, 1.0, 2.0};
+  EXPECT_ANY_THROW(PartialReasoner{points});
+  const PartialReasoner reasoner{std::vector<double>{0.0, 1.0, 2.0, 0.0, 1.0}};
+  const std::vector<double> column{0.5, 1.5};
+  std::vector<double> scores(4);
+  EXPECT_ANY_THROW(reasoner.do_reasoning(std::vector<std::span<const double>>{column}, scores));
+  EXPECT_ANY_THROW(reasoner.do_reasoning(std::vector<std::span<const double>>{column, column}, std::span{scores}.first(3)));
+  reasoner.do_reasoning(std::vector<std::span<const double>>{column, column}, scores);
+  EXPECT_THAT(reasoner.get_parameters(), ::testing::ElementsAre(0.0, 1.0, 2.0, 0.0, 1.0));
+}
@@ -0,0 +1,168 @@
+#include "parallel.hpp"
+#include "training.hpp"
+#include <atomic>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+namespace frp = fuzzyrulesml::parallel;
+namespace frt = fuzzyrulesml::training;
+
+auto sphere(std::span<const double> parameters) -> double {
+  double sum = 0.0;
+  for (std::size_t i = 0; i < parameters.size(); ++i) {
+    const auto shifted = parameters[i] - static_cast<double>(i);
+    sum += shifted * shifted;
+  }
+  return sum;
+}
+
+auto get_settings(std::size_t threads) -> frt::DifferentialEvolutionSettings {
+  frt::DifferentialEvolutionSettings settings;
+  settings.population_size = 24;
+  settings.generations = 200;
+  settings.threads = threads;
+  settings.seed = 7;
+  return settings;
+}
+} // namespace
+
+TEST(ThreadPool, runs_every_index_once) {
+  frp::ThreadPool thread_pool{4};
+  std::vector<std::atomic<int>> calls(1000);
+  for (int job = 0; job < 3; ++job) {
+    thread_pool.for_each_index(calls.size(), [&calls](std::size_t index) { ++calls[index]; });
+  }
+  for (const auto& call : calls) {
+    EXPECT_EQ(call.load(), 3);
+  }
+}
+
+TEST(ThreadPool, rethrows_task_errors) {
+  frp::ThreadPool thread_pool{3};
+  EXPECT_THROW(thread_pool.for_each_index(100,
+                                          [](std::size_t index) {
+                                            if (index == 42) {
+                                              throw std::runtime_error("failed");
+                                            }
+                                          }),
+               std::runtime_error);
+  std::atomic<std::size_t> calls{0};
+  thread_pool.for_each_index(10, [&calls](std::size_t) { ++calls; });
+  EXPECT_EQ(calls.load(), 10);
+}
+
+TEST(DifferentialEvolution, minimizes_shifted_sphere) {
+  frt::DifferentialEvolution optimizer{{-10.0, -10.0, -10.0}, {10.0, 10.0, 10.0}, get_settings(2)};
+  const auto result = optimizer.run({5.0, 5.0, 5.0}, sphere);
+  ASSERT_EQ(result.best_parameters.size(), 3);
+  EXPECT_LT(result.best_value, 1e-6);
+  EXPECT_NEAR(result.best_parameters[0], 0.0, 1e-3);
+  EXPECT_NEAR(result.best_parameters[1], 1.0, 1e-3);
+  EXPECT_NEAR(result.best_parameters[2], 2.0, 1e-3);
+}
+
+TEST(DifferentialEvolution, threads_give_the_same_result) {
+  frt::DifferentialEvolution single{{-10.0, -10.0}, {10.0, 10.0}, get_settings(1)};
+  frt::DifferentialEvolution multiple{{-10.0, -10.0}, {10.0, 10.0}, get_settings(4)};
+  const auto single_result = single.run({3.0, 3.0}, sphere);
+  const auto multiple_result = multiple.run({3.0, 3.0}, sphere);
+  EXPECT_EQ(single_result.best_parameters, multiple_result.best_parameters);
+  EXPECT_EQ(single_result.best_value, multiple_result.best_value);
+}
+
+TEST(DifferentialEvolution, stops_at_target_value) {
+  auto settings = get_settings(2);
+  settings.target_value = 0.5;
+  frt::DifferentialEvolution optimizer{{-10.0, -10.0}, {10.0, 10.0}, settings};
+  std::size_t improvements = 0;
+  const auto result = optimizer.run({8.0, 8.0}, sphere, [&improvements](const frt::TrainingState&) { ++improvements; });
+  EXPECT_TRUE(optimizer.is_target_reached());
+  EXPECT_LE(result.best_value, 0.5);
+  EXPECT_LT(result.generation, settings.generations);
+  EXPECT_GT(improvements, 0);
+}
+
+TEST(DifferentialEvolution, resumes_from_checkpoint) {
+  const auto file = (std::filesystem::temp_directory_path() / "fuzzyRulesML_test_checkpoint.txt").string();
+  auto settings = get_settings(2);
+  settings.generations = 30;
+  frt::DifferentialEvolution uninterrupted{{-10.0, -10.0}, {10.0, 10.0}, settings};
+  const auto expected = uninterrupted.run({3.0, 3.0}, sphere);
+
+  auto interrupted_settings = settings;
+  interrupted_settings.generations = 12;
+  interrupted_settings.checkpoint_file = file;
+  interrupted_settings.checkpoint_generations = 5;
+  frt::DifferentialEvolution interrupted{{-10.0, -10.0}, {10.0, 10.0}, interrupted_settings};
+  const auto partial = interrupted.run({3.0, 3.0}, sphere);
+  EXPECT_EQ(frt::read_checkpoint_parameters(file), partial.best_parameters);
+
+  frt::DifferentialEvolution restored{{-10.0, -10.0}, {10.0, 10.0}, settings};
+  EXPECT_THROW(restored.resume(sphere), std::runtime_error);
+  restored.restore(file);
+  EXPECT_EQ(restored.get_state().generation, 12);
+  const auto result = restored.resume(sphere);
+  EXPECT_EQ(result.generation, expected.generation);
+  EXPECT_EQ(result.best_parameters, expected.best_parameters);
+  EXPECT_EQ(result.best_value, expected.best_value);
+
+  frt::DifferentialEvolution other_dimensions{{-10.0, -10.0, -10.0}, {10.0, 10.0, 10.0}, settings};
+  EXPECT_THROW(other_dimensions.restore(file), std::runtime_error);
+  std::filesystem::remove(file);
+  EXPECT_THROW(other_dimensions.restore(file), std::runtime_error);
+}
+
+TEST(DifferentialEvolution, rescores_population_after_resampling) {
+  // The objective shifts by generation, as the values of different mini-batches do
+  double shift = 0.0;
+  const auto shifted_sphere = [&shift](std::span<const double> parameters) { return sphere(parameters) + shift; };
+  auto settings = get_settings(2);
+  settings.generations = 150;
+  frt::DifferentialEvolution optimizer{{-10.0, -10.0}, {10.0, 10.0}, settings};
+  std::vector<std::size_t> generations;
+  optimizer.set_resampling([&](std::size_t generation) {
+    generations.push_back(generation);
+    shift = static_cast<double>(generation % 7);
+  });
+  const auto result = optimizer.run({3.0, 3.0}, shifted_sphere);
+  ASSERT_EQ(generations.size(), settings.generations);
+  EXPECT_EQ(generations.front(), 1);
+  EXPECT_EQ(generations.back(), settings.generations);
+  EXPECT_NEAR(result.best_value, static_cast<double>(settings.generations % 7), 1e-6);
+  // The population is scored again in the pass of the trials of each generation
+  EXPECT_EQ(result.evaluations, settings.population_size * ((2 * settings.generations) + 1));
+
+  const auto verified = optimizer.reevaluate(sphere);
+  EXPECT_LT(verified.best_value, 1e-6);
+  EXPECT_NEAR(verified.best_parameters[1], 1.0, 1e-3);
+}
+
+TEST(DifferentialEvolution, confirms_resampled_target_value) {
+  // A lucky batch scores far below the values of the full objective
+  const auto lucky_sphere = [](std::span<const double> parameters) { return sphere(parameters) - 10.0; };
+  auto settings = get_settings(2);
+  settings.generations = 40;
+  settings.target_value = 0.5;
+  frt::DifferentialEvolution unconfirmed{{-10.0, -10.0}, {10.0, 10.0}, settings};
+  unconfirmed.set_resampling([](std::size_t) {});
+  const auto unconfirmed_result = unconfirmed.run({8.0, 8.0}, lucky_sphere);
+  EXPECT_EQ(unconfirmed_result.generation, settings.generations);
+  EXPECT_FALSE(unconfirmed.is_target_reached());
+
+  const auto far_sphere = [](std::span<const double> parameters) { return sphere(parameters) + 10.0; };
+  frt::DifferentialEvolution rejected{{-10.0, -10.0}, {10.0, 10.0}, settings};
+  rejected.set_resampling([](std::size_t) {}, far_sphere);
+  EXPECT_EQ(rejected.run({8.0, 8.0}, lucky_sphere).generation, settings.generations);
+  EXPECT_FALSE(rejected.is_target_reached());
+
+  frt::DifferentialEvolution confirmed{{-10.0, -10.0}, {10.0, 10.0}, settings};
+  confirmed.set_resampling([](std::size_t) {}, sphere);
+  const auto confirmed_result = confirmed.run({8.0, 8.0}, lucky_sphere);
+  EXPECT_TRUE(confirmed.is_target_reached());
+  EXPECT_LT(confirmed_result.generation, settings.generations);
+  EXPECT_LE(sphere(confirmed_result.best_parameters), 0.5);
+}